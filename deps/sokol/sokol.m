@@ -2,10 +2,20 @@
 #define SOKOL_IMPL
 #define SOKOL_IMGUI_IMPL
 #define SOKOL_METAL
+// route all heap allocations through the tracking allocator in src/mem.c,
+// re-tagged before each implementation is expanded
+#include "mem.h"
+#define SOKOL_FREE(p) mem_free(p)
+#define SOKOL_CALLOC(n,s) mem_calloc(MEM_TAG_SOKOL_APP, n, s)
+#define SOKOL_MALLOC(s) mem_alloc(MEM_TAG_SOKOL_APP, s)
 #include "sokol_app.h"
+#undef SOKOL_MALLOC
+#define SOKOL_MALLOC(s) mem_alloc(MEM_TAG_SOKOL_GFX, s)
 #include "sokol_gfx.h"
 #include "sokol_time.h"
 #include "sokol_glue.h"
 #define CIMGUI_DEFINE_ENUMS_AND_STRUCTS
 #include "cimgui.h"
+#undef SOKOL_MALLOC
+#define SOKOL_MALLOC(s) mem_alloc(MEM_TAG_SOKOL_IMGUI, s)
 #include "sokol_imgui.h"
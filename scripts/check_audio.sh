@@ -0,0 +1,25 @@
+#!/bin/sh
+# Renders the headless audio script and compares it against the golden file,
+# exits nonzero when they differ by more than the tolerance.
+#
+#   scripts/check_audio.sh path/to/tower4 [tolerance]
+#
+# The tower4 binary needs ENABLE_BENCH. The tolerance defaults to 1e-4, room
+# for compilers contracting or reordering float math; pass 0 to ask for bit
+# exact output from the build that rendered the golden file. After a change
+# meant to alter the sound, render a new golden file with --update.
+set -e
+
+tower4=${1:?usage: $0 path/to/tower4 [tolerance | --update]}
+dir=$(cd "$(dirname "$0")" && pwd)
+golden="$dir/audio_golden.wav"
+options="--seconds 2.5 --rate 16000 --channels 2 --period 512"
+
+if [ "$2" = "--update" ]; then
+	"$tower4" --render-audio "$golden" $options
+	exit
+fi
+
+out=$(mktemp)
+trap 'rm -f "$out"' EXIT
+"$tower4" --render-audio "$out" $options --compare "$golden" --tolerance "${2:-1e-4}"
@@ -0,0 +1,23 @@
+#ifndef TOWER4_AABB_H
+#define TOWER4_AABB_H
+
+#include <stdbool.h>
+
+typedef struct aabb_t {
+	float min_x;
+	float min_y;
+	float min_z;
+
+	float max_x;
+	float max_y;
+	float max_z;
+} aabb_t;
+
+static inline bool aabb_collides(const aabb_t a, const aabb_t b) {
+	const bool x_collides = (a.min_x <= b.max_x && a.max_x >= b.min_x);
+	const bool y_collides = (a.min_y <= b.max_y && a.max_y >= b.min_y);
+	const bool z_collides = (a.min_z <= b.max_z && a.max_z >= b.min_z);
+	return x_collides && y_collides && z_collides;
+}
+
+#endif
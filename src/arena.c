@@ -0,0 +1,69 @@
+#include "arena.h"
+
+#include <assert.h>
+
+#ifdef ENABLE_IMGUI
+#include <stdio.h>
+#define CIMGUI_DEFINE_ENUMS_AND_STRUCTS
+#include "cimgui.h"
+#endif
+
+void arena_init(arena_t *a, const char *name, void *memory, size_t size) {
+	*a = (arena_t){
+		.name = name,
+		.base = memory,
+		.size = size,
+	};
+}
+
+void *arena_alloc(arena_t *a, size_t size, size_t align) {
+	assert(align > 0 && (align & (align - 1)) == 0);
+
+	const uintptr_t base = (uintptr_t)a->base;
+	const uintptr_t start = (base + a->offset + (align - 1)) & ~(uintptr_t)(align - 1);
+	const size_t offset = (size_t)(start - base);
+	if (offset > a->size || size > a->size - offset) {
+		a->failed++;
+		return NULL;
+	}
+
+	a->offset = offset + size;
+	if (a->offset > a->high_water) {
+		a->high_water = a->offset;
+	}
+	return (void*)start;
+}
+
+void *arena_alloc_array(arena_t *a, size_t size, size_t count, size_t align) {
+	if (size != 0 && count > SIZE_MAX / size) {
+		a->failed++;
+		return NULL;
+	}
+	return arena_alloc(a, size * count, align);
+}
+
+void arena_reset(arena_t *a) {
+	a->offset = 0;
+}
+
+size_t arena_mark(const arena_t *a) {
+	return a->offset;
+}
+
+void arena_pop_to(arena_t *a, size_t mark) {
+	assert(mark <= a->offset);
+	a->offset = mark;
+}
+
+#ifdef ENABLE_IMGUI
+void arena_ui(const arena_t *a) {
+	char overlay[96];
+	snprintf(overlay, sizeof(overlay), "%zu / %zu KB (peak %zu KB)",
+			a->offset / 1024, a->size / 1024, a->high_water / 1024);
+	igText("%s", a->name);
+	igProgressBar(a->size ? (float)a->high_water / (float)a->size : 0.0f, (ImVec2){-1, 0}, overlay);
+	if (a->failed) {
+		igTextColored((ImVec4){1, 0.3f, 0.3f, 1}, "%u allocations did not fit", a->failed);
+	}
+}
+#endif
@@ -0,0 +1,43 @@
+#ifndef TOWER4_ARENA_H
+#define TOWER4_ARENA_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// Linear (bump) allocator over caller provided memory.
+//
+// Allocations are freed all at once with arena_reset() or back to a mark with
+// arena_pop_to(). The arena never touches the heap, running out of memory
+// returns NULL and is counted so it shows up in the debug UI.
+
+typedef struct arena_t {
+	const char *name;
+	uint8_t *base;
+	size_t size;
+	size_t offset;
+
+	size_t high_water; /// largest offset ever reached
+	uint32_t failed; /// allocations that didn't fit
+} arena_t;
+
+void arena_init(arena_t *a, const char *name, void *memory, size_t size);
+/// align must be a power of two. Memory is not cleared.
+void *arena_alloc(arena_t *a, size_t size, size_t align);
+/// count elements of size bytes, fails like a full arena when the total
+/// doesn't fit in a size_t
+void *arena_alloc_array(arena_t *a, size_t size, size_t count, size_t align);
+void arena_reset(arena_t *a);
+
+/// Marks allow scratch style usage: take a mark, allocate, pop back to it.
+size_t arena_mark(const arena_t *a);
+void arena_pop_to(arena_t *a, size_t mark);
+
+#define ARENA_PUSH_ARRAY(a, type, count) ((type*)arena_alloc_array((a), sizeof(type), (size_t)(count), _Alignof(type)))
+
+#ifdef ENABLE_IMGUI
+/// Draws usage and high-water mark of the arena, meant for a debug window.
+void arena_ui(const arena_t *a);
+#endif
+
+#endif
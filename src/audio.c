@@ -0,0 +1,202 @@
+#include "audio.h"
+
+#include <limits.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifdef ENABLE_IMGUI
+#define CIMGUI_DEFINE_ENUMS_AND_STRUCTS
+#include "cimgui.h"
+#endif
+
+#include "sokol_time.h"
+
+/// Share of the gap to a full queue closed per callback, absorbs the drift
+/// between the device clock and ours
+#define AUDIO_DRIFT_LEAK 0.001
+
+static void audio_atomic_max(atomic_uint_least32_t *x, uint32_t value) {
+	uint32_t current = atomic_load_explicit(x, memory_order_relaxed);
+	while (current < value && !atomic_compare_exchange_weak_explicit(x, &current, value, memory_order_relaxed, memory_order_relaxed)) {
+	}
+}
+
+static void audio_atomic_min(atomic_int *x, int value) {
+	int current = atomic_load_explicit(x, memory_order_relaxed);
+	while (current > value && !atomic_compare_exchange_weak_explicit(x, &current, value, memory_order_relaxed, memory_order_relaxed)) {
+	}
+}
+
+static void audio_stream_cb(float *buffer, int num_frames, int num_channels, void *user_data) {
+	audio_t *a = user_data;
+	const uint64_t start = stm_now();
+	const double rate = (double)saudio_sample_rate();
+
+	// The device asks for a buffer when it has room for one, so a callback on
+	// time finds the other buffers still queued
+	const double full = (double)((AUDIO_QUEUED_BUFFERS - 1) * num_frames);
+	double fill = full;
+	if (a->last_callback) {
+		fill = a->fill - stm_sec(stm_diff(start, a->last_callback)) * rate;
+		fill += (full - fill) * AUDIO_DRIFT_LEAK;
+		if (fill < 0.0) {
+			if (stm_sec(stm_diff(start, a->started)) > AUDIO_SETTLE_SECONDS) {
+				atomic_fetch_add_explicit(&a->underruns, 1, memory_order_relaxed);
+			}
+			// The device restarts with a primed queue
+			fill = full;
+		}
+		fill = fill < full ? fill : full;
+	}
+	a->last_callback = start;
+	audio_atomic_min(&a->min_fill, (int)fill);
+
+	if (a->desc.stream_userdata_cb) {
+		a->desc.stream_userdata_cb(buffer, num_frames, num_channels, a->desc.user_data);
+	} else {
+		a->desc.stream_cb(buffer, num_frames, num_channels);
+	}
+
+	const uint64_t ticks = stm_since(start);
+	a->fill = fill + (double)num_frames;
+	const double load = stm_sec(ticks) * rate / (double)num_frames;
+	if (load > 1.0) {
+		atomic_fetch_add_explicit(&a->overruns, 1, memory_order_relaxed);
+	}
+	audio_atomic_max(&a->worst_permille, (uint32_t)(load * 1000.0));
+	atomic_fetch_add_explicit(&a->busy, ticks, memory_order_relaxed);
+	atomic_fetch_add_explicit(&a->frames, (uint64_t)num_frames, memory_order_relaxed);
+	atomic_fetch_add_explicit(&a->callbacks, 1, memory_order_relaxed);
+}
+
+static void audio_start(audio_t *a, int buffer_frames) {
+	a->started = stm_now();
+	a->last_callback = 0;
+	a->fill = 0.0;
+	a->start_underruns = atomic_load_explicit(&a->underruns, memory_order_relaxed);
+	saudio_desc desc = a->desc;
+	desc.buffer_frames = buffer_frames;
+	desc.stream_cb = NULL;
+	desc.stream_userdata_cb = audio_stream_cb;
+	desc.user_data = a;
+	saudio_setup(&desc);
+	a->buffer_frames = saudio_isvalid() ? saudio_buffer_frames() : 0;
+}
+
+static void audio_restart(audio_t *a, int buffer_frames) {
+	saudio_shutdown();
+	a->restarts++;
+	audio_start(a, buffer_frames);
+}
+
+void audio_init(audio_t *a, const saudio_desc *desc) {
+	memset(a, 0, sizeof(*a));
+	a->desc = *desc;
+	atomic_init(&a->callbacks, 0);
+	atomic_init(&a->underruns, 0);
+	atomic_init(&a->overruns, 0);
+	atomic_init(&a->busy, 0);
+	atomic_init(&a->frames, 0);
+	atomic_init(&a->worst_permille, 0);
+	atomic_init(&a->min_fill, INT_MAX);
+	a->window_start = stm_now();
+
+	const char *env = getenv("TOWER4_AUDIO_FRAMES");
+	if (env && strcmp(env, "adaptive") == 0) {
+		a->adaptive = true;
+	} else if (env && atoi(env) > 0) {
+		a->desc.buffer_frames = atoi(env);
+	}
+	a->shrink_seconds = AUDIO_SHRINK_SECONDS;
+	audio_start(a, a->adaptive ? AUDIO_MIN_FRAMES : a->desc.buffer_frames);
+}
+
+void audio_shutdown(audio_t *a) {
+	(void)a;
+	saudio_shutdown();
+}
+
+void audio_set_adaptive(audio_t *a, bool adaptive) {
+	a->adaptive = adaptive;
+	a->shrink_seconds = AUDIO_SHRINK_SECONDS;
+	a->shrunk = false;
+	audio_restart(a, adaptive ? AUDIO_MIN_FRAMES : a->desc.buffer_frames);
+}
+
+void audio_update(audio_t *a) {
+	const uint64_t now = stm_now();
+	const double window = stm_sec(stm_diff(now, a->window_start));
+	if (window >= AUDIO_WINDOW_SECONDS) {
+		const uint64_t busy = atomic_load_explicit(&a->busy, memory_order_relaxed);
+		const uint64_t frames = atomic_load_explicit(&a->frames, memory_order_relaxed);
+		const int rate = saudio_isvalid() ? saudio_sample_rate() : 0;
+		const double audio = rate > 0 ? (double)(frames - a->window_frames) / rate : 0.0;
+		a->average_load = audio > 0.0 ? (float)(stm_sec(busy - a->window_busy) / audio) : 0.0f;
+		a->worst_load = (float)atomic_exchange_explicit(&a->worst_permille, 0, memory_order_relaxed) / 1000.0f;
+		const int min_fill = atomic_exchange_explicit(&a->min_fill, INT_MAX, memory_order_relaxed);
+		a->min_headroom = min_fill == INT_MAX || rate == 0 ? 0.0f : 1000.0f * (float)min_fill / (float)rate;
+		a->window_busy = busy;
+		a->window_frames = frames;
+		a->window_start = now;
+	}
+
+	if (!a->adaptive || a->buffer_frames <= 0) {
+		return;
+	}
+	// Grow until a buffer size stops glitching, a restart costs a short gap
+	const bool clean = atomic_load_explicit(&a->underruns, memory_order_relaxed) == a->start_underruns;
+	if (!clean && a->buffer_frames < AUDIO_MAX_FRAMES) {
+		if (a->shrunk) {
+			// The smaller size still doesn't hold, wait longer next time
+			a->shrink_seconds = a->shrink_seconds * 2.0 < AUDIO_SHRINK_MAX_SECONDS ? a->shrink_seconds * 2.0 : AUDIO_SHRINK_MAX_SECONDS;
+		}
+		a->shrunk = false;
+		audio_restart(a, a->buffer_frames * 2);
+		return;
+	}
+	// Step back down once the buffer has been clean with room to spare
+	if (clean && a->buffer_frames > AUDIO_MIN_FRAMES && a->worst_load < AUDIO_SHRINK_LOAD
+		&& stm_sec(stm_diff(now, a->started)) >= a->shrink_seconds) {
+		const int previous = a->buffer_frames;
+		a->shrunk = true;
+		audio_restart(a, previous / 2);
+		if (a->buffer_frames >= previous) {
+			// The device rounds back up, don't restart for nothing every time
+			a->shrink_seconds = AUDIO_SHRINK_MAX_SECONDS;
+		}
+	}
+}
+
+#ifdef ENABLE_IMGUI
+void audio_ui(audio_t *a, bool *open) {
+	igBegin("Audio", open, ImGuiWindowFlags_None);
+	if (!saudio_isvalid()) {
+		igText("No audio device");
+		igEnd();
+		return;
+	}
+	const int rate = saudio_sample_rate();
+	igText("%d Hz, %d channels, %d frame buffer (%.1f ms)", rate, saudio_channels(), a->buffer_frames,
+		1000.0f * (float)a->buffer_frames / (float)rate);
+	bool adaptive = a->adaptive;
+	if (igCheckbox("Adaptive buffer size", &adaptive)) {
+		audio_set_adaptive(a, adaptive);
+	}
+	if (a->adaptive) {
+		igSameLine(0, -1);
+		igText("%s, next shrink after %.0f s clean", a->buffer_frames >= AUDIO_MAX_FRAMES ? "(at the limit)" : "(adapting)",
+			a->shrink_seconds);
+	}
+	igText("Callbacks: %u, restarts: %u", (unsigned)atomic_load_explicit(&a->callbacks, memory_order_relaxed), (unsigned)a->restarts);
+	igText("Underruns: %u, overruns: %u", (unsigned)atomic_load_explicit(&a->underruns, memory_order_relaxed),
+		(unsigned)atomic_load_explicit(&a->overruns, memory_order_relaxed));
+	char overlay[64];
+	snprintf(overlay, sizeof(overlay), "callback avg %.1f%%, worst %.1f%% of deadline", 100.0f * a->average_load, 100.0f * a->worst_load);
+	igProgressBar(a->worst_load < 1.0f ? a->worst_load : 1.0f, (ImVec2){-1, 0}, overlay);
+	snprintf(overlay, sizeof(overlay), "queue headroom min %.1f ms", a->min_headroom);
+	const float queued = 1000.0f * (float)((AUDIO_QUEUED_BUFFERS - 1) * a->buffer_frames) / (float)rate;
+	igProgressBar(queued > 0.0f ? a->min_headroom / queued : 0.0f, (ImVec2){-1, 0}, overlay);
+	igEnd();
+}
+#endif
@@ -0,0 +1,86 @@
+#ifndef TOWER4_AUDIO_H
+#define TOWER4_AUDIO_H
+
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "sokol_audio.h"
+
+// Audio device: owns the sokol_audio stream and watches it for glitches.
+//
+// The stream callback is wrapped to time every call. sokol_audio doesn't
+// report the device's own underruns, so they are estimated: a model of the
+// device queue, AUDIO_QUEUED_BUFFERS buffers deep, fills with every callback
+// and drains with wall clock time. A callback so late that the queue would
+// have run dry counts as an underrun. Callbacks that take longer than the
+// audio they render count as overruns.
+//
+// In adaptive mode the stream starts with AUDIO_MIN_FRAMES and restarts with
+// twice the buffer whenever it underruns. After AUDIO_SHRINK_SECONDS without
+// an underrun and with callbacks well within their deadline it tries half
+// the buffer again, so a passing load spike doesn't cost latency for good.
+// Every time a shrink underruns, the wait before the next one doubles, which
+// keeps a machine on the edge from flapping between two sizes.
+// TOWER4_AUDIO_FRAMES picks the mode at startup: a frame count, or "adaptive".
+
+#define AUDIO_MIN_FRAMES 256
+#define AUDIO_MAX_FRAMES 8192
+/// Buffers the device holds: the one playing and the one being filled
+#define AUDIO_QUEUED_BUFFERS 2
+/// Underruns are ignored this long after a (re)start while the device primes
+#define AUDIO_SETTLE_SECONDS 0.5
+/// Span of the worst case values shown
+#define AUDIO_WINDOW_SECONDS 1.0
+/// Clean time before trying a smaller buffer, doubling up to the maximum
+/// whenever the smaller one underruns
+#define AUDIO_SHRINK_SECONDS 10.0
+#define AUDIO_SHRINK_MAX_SECONDS 320.0
+/// Worst callback load of the last window that still allows shrinking
+#define AUDIO_SHRINK_LOAD 0.5f
+
+typedef struct audio_t {
+	// Main thread
+	saudio_desc desc; /// as requested, the stream runs with the wrapped callback
+	bool adaptive;
+	int buffer_frames; /// granted by the device
+	uint32_t restarts;
+	uint32_t start_underruns; /// counter when the current stream started
+	double shrink_seconds; /// clean time before the next shrink
+	bool shrunk; /// the current stream is a shrink on trial
+	uint64_t window_start;
+	uint64_t window_busy; /// counters at window_start
+	uint64_t window_frames;
+	float average_load; /// callback time over deadline, last window
+	float worst_load;
+	float min_headroom; /// ms of audio queued before a callback, last window
+
+	// Audio thread -> main thread
+	_Alignas(64) atomic_uint_least32_t callbacks;
+	atomic_uint_least32_t underruns;
+	atomic_uint_least32_t overruns;
+	atomic_uint_least64_t busy; /// ticks spent in callbacks
+	atomic_uint_least64_t frames; /// rendered
+	atomic_uint_least32_t worst_permille; /// of the deadline, reset every window
+	atomic_int min_fill; /// frames, reset every window
+
+	// Audio thread, reset while the stream is stopped
+	_Alignas(64) uint64_t started;
+	uint64_t last_callback;
+	double fill; /// frames queued after the last callback
+} audio_t;
+
+/// Starts the stream, desc as for saudio_setup(). Sizes the buffer from
+/// TOWER4_AUDIO_FRAMES or desc->buffer_frames.
+void audio_init(audio_t *a, const saudio_desc *desc);
+void audio_shutdown(audio_t *a);
+/// Main thread, once per frame: collects the counters and adapts the buffer.
+void audio_update(audio_t *a);
+/// Restarts the stream in or out of adaptive mode.
+void audio_set_adaptive(audio_t *a, bool adaptive);
+
+#ifdef ENABLE_IMGUI
+void audio_ui(audio_t *a, bool *open);
+#endif
+
+#endif
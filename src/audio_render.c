@@ -0,0 +1,236 @@
+#include "audio_render.h"
+
+#include <math.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "sokol_time.h"
+#include "mem.h"
+#include "profiler.h"
+#include "synth.h"
+#include "wav.h"
+
+#define AUDIO_RENDER_MAX_PERIOD 4096
+#define AUDIO_RENDER_MAX_CHANNELS 8
+
+typedef struct audio_render_options_t {
+	const char *output;
+	const char *compare;
+	double seconds;
+	int sample_rate;
+	int synth_rate;
+	int channels;
+	int period;
+	double tolerance;
+} audio_render_options_t;
+
+// Sound effects the script triggers, every `interval` seconds from `start`
+static const struct {
+	double start;
+	double interval;
+	mixer_sound_t sound;
+} audio_render_script[] = {
+	{ 0.25, 0.5, { .wave = OSC_SINE, .freq = 90.0f, .freq_end = 45.0f, .sweep = 0.08f, .noise = 0.6f,
+		.attack = 0.002f, .decay = 0.09f, .gain = 0.4f, .pan = -0.2f } },
+	{ 0.5, 0.5, { .wave = OSC_SINE, .freq = 90.0f, .freq_end = 45.0f, .sweep = 0.08f, .noise = 0.6f,
+		.attack = 0.002f, .decay = 0.09f, .gain = 0.4f, .pan = 0.2f } },
+	{ 1.0, 1.7, { .wave = OSC_SQUARE, .freq = 1800.0f, .attack = 0.0005f, .decay = 0.03f, .gain = 0.15f, .priority = 2 } },
+	{ 2.0, 3.0, { .wave = OSC_TRIANGLE, .freq = 120.0f, .freq_end = 60.0f, .sweep = 0.15f, .noise = 0.2f,
+		.attack = 0.003f, .decay = 0.05f, .sustain = 0.5f, .hold = 0.05f, .release = 0.15f, .gain = 0.5f, .priority = 1 } },
+};
+
+#define AUDIO_RENDER_SCRIPT_LENGTH (int)(sizeof(audio_render_script) / sizeof(audio_render_script[0]))
+
+static bool audio_render_parse(int argc, char **argv, audio_render_options_t *o) {
+	*o = (audio_render_options_t){
+		.seconds = 10.0,
+		.sample_rate = 48000,
+		.channels = 2,
+		.period = 512,
+	};
+	for (int i = 0; i < argc; i++) {
+		const char *value = i + 1 < argc ? argv[i + 1] : NULL;
+		if (argv[i][0] != '-') {
+			o->output = argv[i];
+			continue;
+		}
+		if (!value) {
+			fprintf(stderr, "missing value for %s\n", argv[i]);
+			return false;
+		}
+		if (strcmp(argv[i], "--seconds") == 0) {
+			o->seconds = atof(value);
+		} else if (strcmp(argv[i], "--rate") == 0) {
+			o->sample_rate = atoi(value);
+		} else if (strcmp(argv[i], "--synth-rate") == 0) {
+			o->synth_rate = atoi(value);
+		} else if (strcmp(argv[i], "--channels") == 0) {
+			o->channels = atoi(value);
+		} else if (strcmp(argv[i], "--period") == 0) {
+			o->period = atoi(value);
+		} else if (strcmp(argv[i], "--compare") == 0) {
+			o->compare = value;
+		} else if (strcmp(argv[i], "--tolerance") == 0) {
+			o->tolerance = atof(value);
+		} else {
+			fprintf(stderr, "unknown option %s\n", argv[i]);
+			return false;
+		}
+		i++;
+	}
+	if (!o->output || o->seconds <= 0.0 || o->sample_rate <= 0
+		|| o->channels < 1 || o->channels > AUDIO_RENDER_MAX_CHANNELS
+		|| o->period < 1 || o->period > AUDIO_RENDER_MAX_PERIOD) {
+		fprintf(stderr, "usage: tower4 --render-audio out.wav [--seconds S] [--rate R] [--synth-rate R] [--channels 1-%d] [--period 1-%d] [--compare golden.wav] [--tolerance T]\n",
+			AUDIO_RENDER_MAX_CHANNELS, AUDIO_RENDER_MAX_PERIOD);
+		return false;
+	}
+	return true;
+}
+
+// Triggers every script entry due before `frame`
+static void audio_render_events(synth_t *synth, double *next, uint64_t frame, int sample_rate) {
+	const double now = (double)frame / sample_rate;
+	for (int e = 0; e < AUDIO_RENDER_SCRIPT_LENGTH; e++) {
+		while (next[e] <= now) {
+			mixer_play(&synth->mixer, &audio_render_script[e].sound);
+			next[e] += audio_render_script[e].interval;
+		}
+	}
+}
+
+typedef struct audio_render_diff_t {
+	double max_error;
+	double sum_squared;
+	uint64_t first_frame; /// first frame over the tolerance
+	bool over;
+} audio_render_diff_t;
+
+int audio_render_main(int argc, char **argv) {
+	audio_render_options_t o;
+	if (!audio_render_parse(argc, argv, &o)) {
+		return 1;
+	}
+	stm_setup();
+	prof_init(false);
+
+	const wav_info_t info = {
+		.sample_rate = o.sample_rate,
+		.channels = o.channels,
+		.frames = (uint32_t)(o.seconds * o.sample_rate),
+	};
+	FILE *out = fopen(o.output, "wb");
+	if (!out || !wav_write_header(out, &info)) {
+		fprintf(stderr, "can't write %s\n", o.output);
+		return 1;
+	}
+	FILE *golden = NULL;
+	if (o.compare) {
+		wav_info_t golden_info;
+		golden = fopen(o.compare, "rb");
+		if (!golden || !wav_read_header(golden, &golden_info)) {
+			fprintf(stderr, "can't read %s as a float WAV\n", o.compare);
+			return 1;
+		}
+		if (golden_info.sample_rate != info.sample_rate || golden_info.channels != info.channels || golden_info.frames != info.frames) {
+			fprintf(stderr, "%s is %d Hz, %d channels, %u frames; expected %d Hz, %d channels, %u frames\n", o.compare,
+				golden_info.sample_rate, golden_info.channels, golden_info.frames, info.sample_rate, info.channels, info.frames);
+			return 1;
+		}
+	}
+
+	static synth_t synth;
+	synth_init(&synth, o.sample_rate, o.synth_rate);
+	synth.params.playing = true;
+	synth_publish(&synth);
+	// Sample accurate automation, so it lands on the same frames every run
+	const param_point_t sweep[] = {
+		{0.5, synth.params.mfreq * 4.0f},
+		{1.5, synth.params.mfreq},
+	};
+	param_automate(&synth.bank, SYNTH_PARAM_MFREQ, (uint64_t)param_bank_rate(&synth.bank), sweep, 2, PARAM_EXPONENTIAL);
+
+	const size_t period_samples = (size_t)o.period * (size_t)o.channels;
+	float *buffer = mem_alloc(MEM_TAG_GAME, sizeof(float) * period_samples);
+	float *expected = mem_alloc(MEM_TAG_GAME, sizeof(float) * period_samples);
+	float scope[SYNTH_BLOCK];
+	double next_event[AUDIO_RENDER_SCRIPT_LENGTH];
+	for (int e = 0; e < AUDIO_RENDER_SCRIPT_LENGTH; e++) {
+		next_event[e] = audio_render_script[e].start;
+	}
+
+	audio_render_diff_t diff = {0};
+	uint64_t render_ticks = 0;
+	bool switched_wave = false;
+	for (uint64_t frame = 0; frame < info.frames;) {
+		const int n = info.frames - frame < (uint64_t)o.period ? (int)(info.frames - frame) : o.period;
+		// Halfway through, exercise a parameter change as well
+		if (!switched_wave && frame >= info.frames / 2) {
+			synth.params.lfo_wave = OSC_SAW;
+			synth_publish(&synth);
+			switched_wave = true;
+		}
+		audio_render_events(&synth, next_event, frame, o.sample_rate);
+
+		const uint64_t start = stm_now();
+		synth_render(&synth, buffer, n, o.channels);
+		render_ticks += stm_since(start);
+
+		// Nobody watches the scope
+		while (ring_read(&synth.scope_ring, scope, SYNTH_BLOCK) > 0) {
+		}
+
+		const size_t count = (size_t)n * (size_t)o.channels;
+		if (fwrite(buffer, sizeof(float), count, out) != count) {
+			fprintf(stderr, "can't write %s\n", o.output);
+			return 1;
+		}
+		if (golden) {
+			if (fread(expected, sizeof(float), count, golden) != count) {
+				fprintf(stderr, "%s is truncated\n", o.compare);
+				return 1;
+			}
+			for (size_t i = 0; i < count; i++) {
+				// NaN and inf fail every comparison below, and once the
+				// maximum is NaN it stays NaN
+				const double error = isfinite(buffer[i]) ? fabs((double)buffer[i] - (double)expected[i]) : NAN;
+				diff.sum_squared += error * error;
+				diff.max_error = isnan(diff.max_error) || error <= diff.max_error ? diff.max_error : error;
+				if (!(error <= o.tolerance) && !diff.over) {
+					diff.over = true;
+					diff.first_frame = frame + i / (size_t)o.channels;
+				}
+			}
+		}
+		frame += (uint64_t)n;
+	}
+	fclose(out);
+	mem_free(buffer);
+	mem_free(expected);
+
+	const double seconds = stm_sec(render_ticks);
+	const double samples = (double)info.frames * info.channels;
+	printf("rendered %.2f s of %d Hz %d channel audio to %s\n", o.seconds, o.sample_rate, o.channels, o.output);
+	printf("render time %.3f ms, %.1fx realtime, %.2f M frames/s, %.2f M samples/s\n",
+		seconds * 1e3, o.seconds / seconds, info.frames / seconds * 1e-6, samples / seconds * 1e-6);
+
+	int result = 0;
+	if (golden) {
+		fclose(golden);
+		printf("vs %s: max error %.3g, rms error %.3g", o.compare, diff.max_error, sqrt(diff.sum_squared / samples));
+		if (diff.over) {
+			printf(", over tolerance %g from frame %llu (%.3f s)\n", o.tolerance,
+				(unsigned long long)diff.first_frame, (double)diff.first_frame / o.sample_rate);
+			result = 1;
+		} else {
+			printf(", %s\n", diff.max_error == 0.0 ? "bit exact" : "within tolerance");
+		}
+	}
+
+	printf("\n");
+	prof_report(stdout);
+	prof_shutdown();
+	return result;
+}
@@ -0,0 +1,24 @@
+#ifndef TOWER4_AUDIO_RENDER_H
+#define TOWER4_AUDIO_RENDER_H
+
+// Headless audio: `tower4 --render-audio out.wav [options]`
+//
+// Runs the synth and a fixed script of sound effects without an audio device
+// and writes the result as a float WAV, timing only the rendering:
+//
+//   --seconds S      length, default 10
+//   --rate R         sample rate, default 48000
+//   --synth-rate R   internal rate of the synth, resampled to --rate
+//   --channels C     default 2
+//   --period N       frames per callback like a device would ask, default 512
+//   --compare FILE   golden WAV to check the output against
+//   --tolerance T    largest allowed sample difference, default 0 (bit exact)
+//
+// Sound effects start on callback boundaries, so the output depends on
+// --period too. Exits with 1 when the output differs from the golden file by
+// more than the tolerance or isn't finite, so DSP changes can be checked from
+// a script: scripts/check_audio.sh runs it against scripts/audio_golden.wav.
+
+int audio_render_main(int argc, char **argv);
+
+#endif
@@ -0,0 +1,135 @@
+#include "bench.h"
+
+#include <stdarg.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "sokol_time.h"
+#include "profiler.h"
+#include "thread.h"
+
+static const struct {
+	const char *name;
+	void (*run)(void);
+} benches[] = {
+	{ "dsp", bench_dsp },
+	{ "ecs", bench_ecs },
+	{ "fft", bench_fft },
+	{ "hmm", bench_hmm },
+	{ "jobs", bench_jobs },
+	{ "level", bench_level },
+	{ "mixer", bench_mixer },
+	{ "osc", bench_osc },
+	{ "param", bench_param },
+	{ "resample", bench_resample },
+	{ "reverb", bench_reverb },
+	{ "ring", bench_ring },
+	{ "sfx_cache", bench_sfx_cache },
+	{ "tracker", bench_tracker },
+	{ "xform", bench_xform },
+};
+
+#define NUM_BENCHES (int)(sizeof(benches) / sizeof(benches[0]))
+
+static int bench_failures;
+
+static bool bench_selected(const char *name, int argc, char **argv) {
+	if (argc == 0) {
+		return true;
+	}
+	for (int i = 0; i < argc; i++) {
+		if (strcmp(argv[i], name) == 0) {
+			return true;
+		}
+	}
+	return false;
+}
+
+int bench_main(int argc, char **argv) {
+	stm_setup();
+	prof_init(false);
+
+	for (int i = 0; i < argc; i++) {
+		bool known = false;
+		for (int b = 0; b < NUM_BENCHES; b++) {
+			known = known || strcmp(argv[i], benches[b].name) == 0;
+		}
+		if (!known) {
+			fprintf(stderr, "unknown benchmark '%s', available:", argv[i]);
+			for (int b = 0; b < NUM_BENCHES; b++) {
+				fprintf(stderr, " %s", benches[b].name);
+			}
+			fprintf(stderr, "\n");
+			return 1;
+		}
+	}
+
+	for (int b = 0; b < NUM_BENCHES; b++) {
+		if (bench_selected(benches[b].name, argc, argv)) {
+			printf("== %s\n", benches[b].name);
+			benches[b].run();
+		}
+	}
+
+	printf("\n");
+	prof_report(stdout);
+	prof_shutdown();
+	if (bench_failures) {
+		printf("\n%d check%s failed\n", bench_failures, bench_failures == 1 ? "" : "s");
+		return 1;
+	}
+	return 0;
+}
+
+void bench_result(const char *name, int items, int iterations, uint64_t ticks) {
+	const double us = stm_us(ticks) / (double)(iterations > 0 ? iterations : 1);
+	const double mitems = us > 0.0 ? (double)items / us : 0.0;
+	printf("%-40s %8d items %12.3f us/iter %10.2f M items/s\n", name, items, us, mitems);
+	fflush(stdout);
+}
+
+int bench_max_threads(void) {
+	const char *env = getenv("TOWER4_THREADS");
+	const int threads = env ? atoi(env) : 0;
+	return threads > 0 ? threads : thread_cpu_count();
+}
+
+void bench_budget(int blocks, int frames, double rate, uint64_t total, uint64_t worst) {
+	const double budget_us = (double)frames / rate * 1e6;
+	const double avg_us = stm_us(total) / (double)blocks;
+	printf("%-40s block avg %.2f us (%.2f%%)", "", avg_us, 100.0 * avg_us / budget_us);
+	if (worst) {
+		printf(", worst %.2f us (%.2f%%)", stm_us(worst), 100.0 * stm_us(worst) / budget_us);
+	}
+	printf(" of %.0f us", budget_us);
+}
+
+uint32_t bench_rand(uint32_t *seed) {
+	*seed = *seed * 1664525u + 1013904223u;
+	return *seed;
+}
+
+float bench_random(uint32_t *seed) {
+	return (float)(bench_rand(seed) >> 8) / (float)(1 << 23) - 1.0f;
+}
+
+void bench_fail(const char *format, ...) {
+	bench_failures++;
+	printf("FAILED: ");
+	va_list args;
+	va_start(args, format);
+	vprintf(format, args);
+	va_end(args);
+	printf("\n");
+	fflush(stdout);
+}
+
+bool bench_check(const char *name, double error, double tolerance) {
+	if (error <= tolerance) {
+		return true;
+	}
+	bench_fail("%s: off by %.1e, tolerance %.1e", name, error, tolerance);
+	return false;
+}
@@ -0,0 +1,52 @@
+#ifndef TOWER4_BENCH_H
+#define TOWER4_BENCH_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+// Command line benchmarks: `tower4 --bench [name...]`
+//
+// Runs the named benchmarks (all if none are given) without opening a window,
+// prints one line per measurement and finishes with the profiler zone table,
+// including hardware counters when TOWER4_PERF_COUNTERS is set. Benchmarks
+// also check their results; any failed check makes the run exit with 1.
+
+int bench_main(int argc, char **argv);
+
+/// Prints a result line for `iterations` runs over `items` items taking `ticks` in total.
+void bench_result(const char *name, int items, int iterations, uint64_t ticks);
+/// Thread count scaling benchmarks go up to: TOWER4_THREADS or the cpu count
+int bench_max_threads(void);
+/// Prints how a block loop did against the time a block of audio lasts:
+/// `blocks` blocks of `frames` frames at `rate` took `total` ticks, the
+/// slowest `worst` (0 leaves it out). The line stays open for extras, the
+/// caller ends it with a newline.
+void bench_budget(int blocks, int frames, double rate, uint64_t total, uint64_t worst);
+/// The benches' LCG: advances seed and returns the new value, the same
+/// numbers on every platform
+uint32_t bench_rand(uint32_t *seed);
+/// Uniform in [-1, 1), from bench_rand()
+float bench_random(uint32_t *seed);
+/// Prints a failed check, printf style, and fails the run.
+void bench_fail(const char *format, ...);
+/// Fails the run when error is over tolerance or NaN, returns whether it passed.
+bool bench_check(const char *name, double error, double tolerance);
+
+// Benchmarks, one per bench_*.c file
+void bench_dsp(void);
+void bench_ecs(void);
+void bench_fft(void);
+void bench_hmm(void);
+void bench_jobs(void);
+void bench_level(void);
+void bench_mixer(void);
+void bench_osc(void);
+void bench_param(void);
+void bench_resample(void);
+void bench_reverb(void);
+void bench_ring(void);
+void bench_sfx_cache(void);
+void bench_tracker(void);
+void bench_xform(void);
+
+#endif
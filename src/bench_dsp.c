@@ -0,0 +1,155 @@
+#include "bench.h"
+
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "sokol_time.h"
+#include "dsp.h"
+#include "osc.h"
+#include "synth.h"
+
+#define BENCH_DSP_SAMPLES (1 << 20)
+#define BENCH_DSP_BLOCK SYNTH_BLOCK
+#define BENCH_DSP_RATE 48000
+#define BENCH_DSP_MFREQ 40.0f
+#define BENCH_DSP_FREQFREQ 1.5f
+/// Scalar against SIMD chain, only the order of operations differs
+#define BENCH_DSP_TOLERANCE 1e-6
+
+static volatile float bench_dsp_sink;
+
+// Inputs of synth_render_dsp() that come from the parameter bank and the
+// mixer, the same for every block
+static struct {
+	_Alignas(DSP_ALIGN) float mfreq[BENCH_DSP_BLOCK];
+	_Alignas(DSP_ALIGN) float amplitude[BENCH_DSP_BLOCK];
+	_Alignas(DSP_ALIGN) float end_amplitude[BENCH_DSP_BLOCK];
+	_Alignas(DSP_ALIGN) float gate[BENCH_DSP_BLOCK];
+	_Alignas(DSP_ALIGN) float voice[BENCH_DSP_BLOCK];
+} bench_dsp_in;
+
+// One block of the synth's working set
+typedef struct bench_dsp_block_t {
+	_Alignas(DSP_ALIGN) float phase[BENCH_DSP_BLOCK];
+	_Alignas(DSP_ALIGN) float mono[BENCH_DSP_BLOCK];
+	_Alignas(DSP_ALIGN) float end_amplitude[BENCH_DSP_BLOCK];
+	_Alignas(DSP_ALIGN) float left[BENCH_DSP_BLOCK];
+	_Alignas(DSP_ALIGN) float right[BENCH_DSP_BLOCK];
+	_Alignas(DSP_ALIGN) float out[BENCH_DSP_BLOCK * 2];
+} bench_dsp_block_t;
+
+static bench_dsp_block_t bench_dsp_scalar;
+static bench_dsp_block_t bench_dsp_simd;
+
+static void bench_dsp_init(void) {
+	for (int i = 0; i < BENCH_DSP_BLOCK; i++) {
+		bench_dsp_in.mfreq[i] = BENCH_DSP_MFREQ;
+		bench_dsp_in.amplitude[i] = 0.8f;
+		bench_dsp_in.end_amplitude[i] = 0.5f;
+		bench_dsp_in.gate[i] = 1.0f;
+		bench_dsp_in.voice[i] = 0.3f * sinf((float)i * 0.05f);
+	}
+}
+
+// The synth's chain as synth_render_dsp() and synth_render() run it, without
+// the reverb (see the reverb bench), with every kernel written out one sample
+// at a time. The oscillators are the same code in both versions.
+static void bench_dsp_chain_scalar(void) {
+	bench_dsp_block_t *x = &bench_dsp_scalar;
+	osc_t lfo;
+	osc_init(&lfo, OSC_SINE, OSC_LINEAR);
+	osc_set_freq(&lfo, BENCH_DSP_FREQFREQ / (2.0f * (float)M_PI), BENCH_DSP_RATE);
+	const float step = BENCH_DSP_MFREQ * BENCH_DSP_FREQFREQ / BENCH_DSP_RATE;
+	const int n = BENCH_DSP_BLOCK;
+	const uint64_t start = stm_now();
+	for (int b = 0; b < BENCH_DSP_SAMPLES / BENCH_DSP_BLOCK; b++) {
+		osc_process(&lfo, x->phase, n);
+		for (int i = 0; i < n; i++) {
+			x->phase[i] *= bench_dsp_in.mfreq[i];
+		}
+		osc_lookup(OSC_SINE, x->phase, x->mono, n, step);
+		for (int i = 0; i < n; i++) {
+			float v = x->mono[i] * bench_dsp_in.amplitude[i];
+			v = v < 0.5f ? v : 0.5f;
+			v *= bench_dsp_in.end_amplitude[i] * bench_dsp_in.gate[i];
+			// A voice panned hard right, its gain ramping in
+			const float g = 0.25f + 0.5f * (float)(i + 1) / (float)n;
+			const float l = v;
+			const float r = v + bench_dsp_in.voice[i] * g;
+			x->out[2 * i] = l > -1.0f ? (l < 1.0f ? l : 1.0f) : -1.0f;
+			x->out[2 * i + 1] = r > -1.0f ? (r < 1.0f ? r : 1.0f) : -1.0f;
+		}
+		bench_dsp_sink += x->out[b & (BENCH_DSP_BLOCK - 1)];
+	}
+	bench_result("dsp/chain/scalar", BENCH_DSP_SAMPLES, 1, stm_since(start));
+}
+
+static void bench_dsp_chain_simd(void) {
+	bench_dsp_block_t *x = &bench_dsp_simd;
+	osc_t lfo;
+	osc_init(&lfo, OSC_SINE, OSC_LINEAR);
+	osc_set_freq(&lfo, BENCH_DSP_FREQFREQ / (2.0f * (float)M_PI), BENCH_DSP_RATE);
+	const float step = BENCH_DSP_MFREQ * BENCH_DSP_FREQFREQ / BENCH_DSP_RATE;
+	const int n = BENCH_DSP_BLOCK;
+	const uint64_t start = stm_now();
+	for (int b = 0; b < BENCH_DSP_SAMPLES / BENCH_DSP_BLOCK; b++) {
+		osc_process(&lfo, x->phase, n);
+		dsp_mul(x->phase, bench_dsp_in.mfreq, n);
+		osc_lookup(OSC_SINE, x->phase, x->mono, n, step);
+		dsp_mul(x->mono, bench_dsp_in.amplitude, n);
+		dsp_clamp(x->mono, -INFINITY, 0.5f, n);
+		memcpy(x->end_amplitude, bench_dsp_in.end_amplitude, sizeof(x->end_amplitude));
+		dsp_mul(x->end_amplitude, bench_dsp_in.gate, n);
+		dsp_mul(x->mono, x->end_amplitude, n);
+		memcpy(x->left, x->mono, sizeof(x->left));
+		memcpy(x->right, x->mono, sizeof(x->right));
+		dsp_mix_ramp(x->left, bench_dsp_in.voice, 0.0f, 0.0f, n);
+		dsp_mix_ramp(x->right, bench_dsp_in.voice, 0.25f, 0.75f, n);
+		dsp_clamp(x->left, -1.0f, 1.0f, n);
+		dsp_clamp(x->right, -1.0f, 1.0f, n);
+		dsp_interleave_stereo(x->out, x->left, x->right, 2, n);
+		bench_dsp_sink += x->out[b & (BENCH_DSP_BLOCK - 1)];
+	}
+	bench_result("dsp/chain/" SIMD_NAME, BENCH_DSP_SAMPLES, 1, stm_since(start));
+}
+
+// The whole callback at a typical device setting, and how much of one core
+// it leaves for everything else
+static void bench_dsp_synth(void) {
+	static synth_t synth;
+	static float buffer[BENCH_DSP_BLOCK * 2 * 2];
+	synth_init(&synth, BENCH_DSP_RATE, 0);
+	synth.params.playing = true;
+	synth_publish(&synth);
+	// A device period that is not a multiple of the block size
+	const int frames = BENCH_DSP_BLOCK * 2 - 32;
+	int rendered = 0;
+	const uint64_t start = stm_now();
+	while (rendered < BENCH_DSP_SAMPLES) {
+		synth_render(&synth, buffer, frames, 2);
+		// Stand in for the UI so the scope ring never fills up
+		while (ring_read(&synth.scope_ring, buffer, BENCH_DSP_BLOCK) > 0) {
+		}
+		rendered += frames;
+	}
+	const uint64_t ticks = stm_since(start);
+	bench_result("dsp/synth_render/stereo_48k", rendered, 1, ticks);
+	const double realtime = (double)rendered / BENCH_DSP_RATE / stm_sec(ticks);
+	printf("%-40s %8.0fx realtime, %.3f%% of a core\n", "", realtime, 100.0 / realtime);
+}
+
+void bench_dsp(void) {
+	printf("dsp kernels: %s, %d lanes\n", dsp_simd_name(), SIMD_WIDTH);
+	bench_dsp_init();
+	bench_dsp_chain_scalar();
+	bench_dsp_chain_simd();
+	// Both ran the same blocks, so the last one must match
+	float error = 0.0f;
+	for (int i = 0; i < BENCH_DSP_BLOCK * 2; i++) {
+		const float e = fabsf(bench_dsp_scalar.out[i] - bench_dsp_simd.out[i]);
+		error = e > error ? e : error;
+	}
+	bench_check("dsp/chain", error, BENCH_DSP_TOLERANCE);
+	bench_dsp_synth();
+}
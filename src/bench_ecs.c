@@ -0,0 +1,169 @@
+#include "bench.h"
+
+#include <stdio.h>
+#include <string.h>
+
+#include "sokol_time.h"
+#include "ecs.h"
+#include "mem.h"
+#include "profiler.h"
+
+#define BENCH_ECS_ITERATIONS 200
+
+// What every system would touch if all data lived in one struct per object
+typedef struct fat_object_t {
+	hmm_vec3 position;
+	float scale;
+	hmm_vec3 half_extents;
+	aabb_t bounds;
+	int base_element;
+	int num_elements;
+	float gain;
+	float radius;
+	uint32_t voice;
+	uint32_t components;
+	char name[32];
+} fat_object_t;
+
+static uint32_t bench_mask(int i) {
+	uint32_t mask = ECS_HAS(ECS_TRANSFORM);
+	if (i % 2 == 0) mask |= ECS_HAS(ECS_COLLIDER);
+	if (i % 10 < 3) mask |= ECS_HAS(ECS_MESH);
+	if (i % 5 == 0) mask |= ECS_HAS(ECS_EMITTER);
+	return mask;
+}
+
+static int count_matching(ecs_world_t *w, uint32_t mask) {
+	int n = 0;
+	for (ecs_iter_t it = ecs_query(w, mask); ecs_next(&it);) {
+		n += it.count;
+	}
+	return n;
+}
+
+static void emitter_system(ecs_world_t *w, hmm_vec3 listener) {
+	for (ecs_iter_t it = ecs_query(w, ECS_HAS(ECS_TRANSFORM) | ECS_HAS(ECS_EMITTER)); ecs_next(&it);) {
+		const ecs_transform_t *transform = it.transform;
+		ecs_emitter_t *emitter = it.emitter;
+		for (int i = 0; i < it.count; i++) {
+			const hmm_vec3 d = HMM_SubtractVec3(transform[i].position, listener);
+			const float d2 = HMM_DotVec3(d, d);
+			emitter[i].gain = d2 < emitter[i].radius * emitter[i].radius ? 1.0f / (1.0f + d2) : 0.0f;
+		}
+	}
+}
+
+static int cull_system(ecs_world_t *w, hmm_vec3 eye, float far) {
+	int visible = 0;
+	for (ecs_iter_t it = ecs_query(w, ECS_HAS(ECS_TRANSFORM) | ECS_HAS(ECS_MESH)); ecs_next(&it);) {
+		const ecs_transform_t *transform = it.transform;
+		for (int i = 0; i < it.count; i++) {
+			const hmm_vec3 d = HMM_SubtractVec3(transform[i].position, eye);
+			visible += HMM_DotVec3(d, d) < far * far;
+		}
+	}
+	return visible;
+}
+
+static void fat_collider_system(fat_object_t *objects, int n) {
+	for (int i = 0; i < n; i++) {
+		fat_object_t *o = &objects[i];
+		if (!(o->components & ECS_HAS(ECS_COLLIDER))) {
+			continue;
+		}
+		const hmm_vec3 h = HMM_MultiplyVec3f(o->half_extents, o->scale);
+		o->bounds = (aabb_t){
+			.min_x = o->position.X - h.X, .max_x = o->position.X + h.X,
+			.min_y = o->position.Y - h.Y, .max_y = o->position.Y + h.Y,
+			.min_z = o->position.Z - h.Z, .max_z = o->position.Z + h.Z,
+		};
+	}
+}
+
+static void bench_ecs_run(int n) {
+	ecs_world_t w;
+	if (!ecs_init(&w, n)) {
+		printf("ecs: out of memory for %d entities\n", n);
+		return;
+	}
+	fat_object_t *fat = mem_calloc(MEM_TAG_GAME, (size_t)n, sizeof(fat_object_t));
+
+	uint32_t seed = 1234;
+	for (int i = 0; i < n; i++) {
+		const uint32_t mask = bench_mask(i);
+		const ecs_entity_t e = ecs_create(&w, mask);
+		const hmm_vec3 position = HMM_Vec3(100.0f * bench_random(&seed), 10.0f * bench_random(&seed), 100.0f * bench_random(&seed));
+		*ECS_GET_TRANSFORM(&w, e) = (ecs_transform_t){ .position = position, .scale = 1.0f };
+		fat[i] = (fat_object_t){ .position = position, .scale = 1.0f, .components = mask };
+		if (mask & ECS_HAS(ECS_COLLIDER)) {
+			ECS_GET_COLLIDER(&w, e)->half_extents = HMM_Vec3(0.5f, 1.0f, 0.5f);
+			fat[i].half_extents = HMM_Vec3(0.5f, 1.0f, 0.5f);
+		}
+		if (mask & ECS_HAS(ECS_EMITTER)) {
+			ECS_GET_EMITTER(&w, e)->radius = 30.0f;
+		}
+	}
+
+	char name[64];
+	const hmm_vec3 eye = HMM_Vec3(0, 1.5f, 0);
+	volatile int sink = 0;
+
+	snprintf(name, sizeof(name), "ecs/colliders/%d", n);
+	uint64_t start = stm_now();
+	for (int r = 0; r < BENCH_ECS_ITERATIONS; r++) {
+		PROF_ZONE_BEGIN(ecs_colliders);
+		ecs_update_colliders(&w);
+		PROF_ZONE_END(ecs_colliders);
+	}
+	bench_result(name, count_matching(&w, ECS_HAS(ECS_TRANSFORM) | ECS_HAS(ECS_COLLIDER)), BENCH_ECS_ITERATIONS, stm_since(start));
+
+	snprintf(name, sizeof(name), "aos/colliders/%d", n);
+	start = stm_now();
+	for (int r = 0; r < BENCH_ECS_ITERATIONS; r++) {
+		PROF_ZONE_BEGIN(aos_colliders);
+		fat_collider_system(fat, n);
+		PROF_ZONE_END(aos_colliders);
+	}
+	bench_result(name, count_matching(&w, ECS_HAS(ECS_TRANSFORM) | ECS_HAS(ECS_COLLIDER)), BENCH_ECS_ITERATIONS, stm_since(start));
+
+	snprintf(name, sizeof(name), "ecs/emitters/%d", n);
+	start = stm_now();
+	for (int r = 0; r < BENCH_ECS_ITERATIONS; r++) {
+		PROF_ZONE_BEGIN(ecs_emitters);
+		emitter_system(&w, eye);
+		PROF_ZONE_END(ecs_emitters);
+	}
+	bench_result(name, count_matching(&w, ECS_HAS(ECS_TRANSFORM) | ECS_HAS(ECS_EMITTER)), BENCH_ECS_ITERATIONS, stm_since(start));
+
+	snprintf(name, sizeof(name), "ecs/cull/%d", n);
+	start = stm_now();
+	for (int r = 0; r < BENCH_ECS_ITERATIONS; r++) {
+		PROF_ZONE_BEGIN(ecs_cull);
+		sink += cull_system(&w, eye, 50.0f);
+		PROF_ZONE_END(ecs_cull);
+	}
+	bench_result(name, count_matching(&w, ECS_HAS(ECS_TRANSFORM) | ECS_HAS(ECS_MESH)), BENCH_ECS_ITERATIONS, stm_since(start));
+
+	snprintf(name, sizeof(name), "ecs/churn/%d", n);
+	start = stm_now();
+	// Destroy and respawn a tenth of the world per iteration
+	for (int r = 0; r < BENCH_ECS_ITERATIONS; r++) {
+		for (int i = 0; i < n / 10; i++) {
+			ecs_iter_t it = ecs_query(&w, bench_mask(i));
+			if (ecs_next(&it)) {
+				ecs_destroy(&w, it.entities[0]);
+				ecs_create(&w, bench_mask(i));
+			}
+		}
+	}
+	bench_result(name, n / 10, BENCH_ECS_ITERATIONS, stm_since(start));
+
+	(void)sink;
+	mem_free(fat);
+	ecs_shutdown(&w);
+}
+
+void bench_ecs(void) {
+	bench_ecs_run(10000);
+	bench_ecs_run(50000);
+}
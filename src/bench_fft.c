@@ -0,0 +1,97 @@
+#include "bench.h"
+
+#include <math.h>
+#include <stdio.h>
+
+#include "sokol_time.h"
+#include "fft.h"
+#include "job.h"
+#include "spectrum.h"
+
+#define BENCH_FFT_REPEAT 2000
+#define BENCH_FFT_RATE 48000
+/// Against the DFT in doubles, relative to the biggest bin
+#define BENCH_FFT_TOLERANCE 1e-5
+
+static volatile float bench_fft_sink;
+static fft_t bench_fft_state;
+static spectrum_t bench_fft_spectrum;
+static float bench_fft_in[FFT_MAX_SIZE];
+static float bench_fft_re[FFT_MAX_SIZE / 2 + 1];
+static float bench_fft_im[FFT_MAX_SIZE / 2 + 1];
+
+// Largest distance of any bin from the textbook DFT, relative to the
+// biggest bin
+static double bench_fft_error(int size) {
+	double worst = 0.0;
+	double peak = 0.0;
+	for (int k = 0; k <= size / 2; k++) {
+		double re = 0.0;
+		double im = 0.0;
+		for (int n = 0; n < size; n++) {
+			const double angle = -2.0 * M_PI * (double)((int64_t)k * n % size) / size;
+			re += bench_fft_in[n] * cos(angle);
+			im += bench_fft_in[n] * sin(angle);
+		}
+		const double error = hypot(re - bench_fft_re[k], im - bench_fft_im[k]);
+		worst = error > worst ? error : worst;
+		const double magnitude = hypot(re, im);
+		peak = magnitude > peak ? magnitude : peak;
+	}
+	return worst / peak;
+}
+
+static void bench_fft_size(int size) {
+	fft_t *f = &bench_fft_state;
+	fft_init(f, size);
+	uint32_t seed = 1;
+	for (int i = 0; i < size; i++) {
+		bench_fft_in[i] = 0.5f * bench_random(&seed);
+	}
+	const uint64_t start = stm_now();
+	for (int r = 0; r < BENCH_FFT_REPEAT; r++) {
+		fft_real(f, bench_fft_in, bench_fft_re, bench_fft_im);
+		bench_fft_sink += bench_fft_re[r & (size / 2)];
+	}
+	char name[64];
+	snprintf(name, sizeof(name), "fft/real/%d", size);
+	bench_result(name, size, BENCH_FFT_REPEAT, stm_since(start));
+	const double error = bench_fft_error(size);
+	printf("%-40s max error %.1e of peak bin\n", "", error);
+	bench_check(name, error, BENCH_FFT_TOLERANCE);
+}
+
+// A full scale sine through the analyzer should light up its own band only
+static void bench_fft_spectrum_band(float freq) {
+	spectrum_t *s = &bench_fft_spectrum;
+	spectrum_init(s);
+	float block[256];
+	uint64_t frame = 0;
+	for (int pass = 0; pass < 2; pass++) {
+		for (int b = 0; b < SPECTRUM_SIZE / 256; b++) {
+			for (int i = 0; i < 256; i++, frame++) {
+				block[i] = sinf(2.0f * (float)M_PI * freq * (float)frame / BENCH_FFT_RATE);
+			}
+			ring_write(&s->ring, block, 256);
+		}
+		spectrum_update(s, BENCH_FFT_RATE, 1.0f / 60.0f);
+	}
+	spectrum_shutdown(s);
+	int loudest = 0;
+	for (int b = 1; b < SPECTRUM_BANDS; b++) {
+		loudest = s->bands[b] > s->bands[loudest] ? b : loudest;
+	}
+	printf("spectrum %5.0f Hz sine: band %d (%.0f - %.0f Hz) at %.1f dB, fft %.1f us\n", freq, loudest,
+		s->edges[loudest], s->edges[loudest + 1], (1.0f - s->bands[loudest]) * SPECTRUM_FLOOR_DB, stm_us(s->fft_ticks));
+}
+
+void bench_fft(void) {
+	for (int size = 512; size <= FFT_MAX_SIZE; size *= 2) {
+		bench_fft_size(size);
+	}
+	job_init(0);
+	bench_fft_spectrum_band(100.0f);
+	bench_fft_spectrum_band(1000.0f);
+	bench_fft_spectrum_band(8000.0f);
+	job_shutdown();
+}
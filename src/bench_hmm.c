@@ -0,0 +1,229 @@
+#include "bench.h"
+
+#include <math.h>
+#include <stdio.h>
+
+#include "sokol_time.h"
+#include "HandmadeMath.h"
+
+// HandmadeMath operations with an SSE path (WASM SIMD on the web, see
+// CMakeLists.txt), each checked against plain scalar code and timed. Build
+// with ENABLE_MATH_SIMD off for the scalar numbers. MultiplyMat4ByVec4 is
+// patched to stay scalar, its SSE path was slower (see deps/HandmadeMath.h).
+
+#define BENCH_HMM_COUNT 1024
+#define BENCH_HMM_REPEAT 1000
+/// Relative to the size of the values involved
+#define BENCH_HMM_TOLERANCE 1e-5f
+
+static volatile float bench_hmm_sink;
+
+static struct {
+	hmm_mat4 a[BENCH_HMM_COUNT];
+	hmm_mat4 b[BENCH_HMM_COUNT];
+	hmm_mat4 out[BENCH_HMM_COUNT];
+	hmm_vec4 u[BENCH_HMM_COUNT];
+	hmm_vec4 v[BENCH_HMM_COUNT];
+	hmm_vec4 out_v[BENCH_HMM_COUNT];
+	hmm_quaternion out_q[BENCH_HMM_COUNT];
+	float out_f[BENCH_HMM_COUNT];
+} bench_hmm_data;
+
+static float bench_hmm_error(float got, float expected, float scale) {
+	return fabsf(got - expected) / (scale > 1.0f ? scale : 1.0f);
+}
+
+static void bench_hmm_report(const char *name, uint64_t ticks) {
+	char full[64];
+	snprintf(full, sizeof(full), "hmm/%s", name);
+	bench_result(full, BENCH_HMM_COUNT, BENCH_HMM_REPEAT, ticks);
+}
+
+static void bench_hmm_mat4(void) {
+	hmm_mat4 *a = bench_hmm_data.a, *b = bench_hmm_data.b, *out = bench_hmm_data.out;
+	hmm_vec4 *v = bench_hmm_data.v, *out_v = bench_hmm_data.out_v;
+
+	uint64_t start = stm_now();
+	for (int r = 0; r < BENCH_HMM_REPEAT; r++) {
+		for (int i = 0; i < BENCH_HMM_COUNT; i++) {
+			out[i] = HMM_MultiplyMat4(a[i], b[i]);
+		}
+		bench_hmm_sink += out[r & (BENCH_HMM_COUNT - 1)].Elements[0][0];
+	}
+	bench_hmm_report("MultiplyMat4", stm_since(start));
+	float error = 0.0f;
+	for (int i = 0; i < BENCH_HMM_COUNT; i++) {
+		for (int c = 0; c < 4; c++) {
+			for (int row = 0; row < 4; row++) {
+				float sum = 0.0f, scale = 0.0f;
+				for (int k = 0; k < 4; k++) {
+					sum += a[i].Elements[k][row] * b[i].Elements[c][k];
+					scale += fabsf(a[i].Elements[k][row] * b[i].Elements[c][k]);
+				}
+				error = fmaxf(error, bench_hmm_error(out[i].Elements[c][row], sum, scale));
+			}
+		}
+	}
+	bench_check("hmm/MultiplyMat4", error, BENCH_HMM_TOLERANCE);
+
+	start = stm_now();
+	for (int r = 0; r < BENCH_HMM_REPEAT; r++) {
+		for (int i = 0; i < BENCH_HMM_COUNT; i++) {
+			out_v[i] = HMM_MultiplyMat4ByVec4(a[i], v[i]);
+		}
+		bench_hmm_sink += out_v[r & (BENCH_HMM_COUNT - 1)].X;
+	}
+	bench_hmm_report("MultiplyMat4ByVec4", stm_since(start));
+	error = 0.0f;
+	for (int i = 0; i < BENCH_HMM_COUNT; i++) {
+		for (int row = 0; row < 4; row++) {
+			float sum = 0.0f, scale = 0.0f;
+			for (int c = 0; c < 4; c++) {
+				sum += a[i].Elements[c][row] * v[i].Elements[c];
+				scale += fabsf(a[i].Elements[c][row] * v[i].Elements[c]);
+			}
+			error = fmaxf(error, bench_hmm_error(out_v[i].Elements[row], sum, scale));
+		}
+	}
+	bench_check("hmm/MultiplyMat4ByVec4", error, BENCH_HMM_TOLERANCE);
+
+	start = stm_now();
+	for (int r = 0; r < BENCH_HMM_REPEAT; r++) {
+		for (int i = 0; i < BENCH_HMM_COUNT; i++) {
+			out[i] = HMM_Transpose(a[i]);
+		}
+		bench_hmm_sink += out[r & (BENCH_HMM_COUNT - 1)].Elements[1][0];
+	}
+	bench_hmm_report("Transpose", stm_since(start));
+	error = 0.0f;
+	for (int i = 0; i < BENCH_HMM_COUNT; i++) {
+		for (int c = 0; c < 4; c++) {
+			for (int row = 0; row < 4; row++) {
+				error = fmaxf(error, fabsf(out[i].Elements[c][row] - a[i].Elements[row][c]));
+			}
+		}
+	}
+	bench_check("hmm/Transpose", error, BENCH_HMM_TOLERANCE);
+
+	// Scalar in both builds (vec3 math), here for the camera's sake. The
+	// eye has to end up at the origin.
+	start = stm_now();
+	for (int r = 0; r < BENCH_HMM_REPEAT; r++) {
+		for (int i = 0; i < BENCH_HMM_COUNT; i++) {
+			out[i] = HMM_LookAt(v[i].XYZ, HMM_AddVec3(v[i].XYZ, HMM_Vec3(1.0f, 0.5f, 0.25f)), HMM_Vec3(0.0f, 1.0f, 0.0f));
+		}
+		bench_hmm_sink += out[r & (BENCH_HMM_COUNT - 1)].Elements[3][0];
+	}
+	bench_hmm_report("LookAt", stm_since(start));
+	error = 0.0f;
+	for (int i = 0; i < BENCH_HMM_COUNT; i++) {
+		const hmm_vec4 eye = HMM_MultiplyMat4ByVec4(out[i], HMM_Vec4v(v[i].XYZ, 1.0f));
+		error = fmaxf(error, fmaxf(fabsf(eye.X), fmaxf(fabsf(eye.Y), fabsf(eye.Z))));
+	}
+	bench_check("hmm/LookAt", error, BENCH_HMM_TOLERANCE);
+}
+
+static void bench_hmm_vec4(void) {
+	hmm_vec4 *u = bench_hmm_data.u, *v = bench_hmm_data.v, *out_v = bench_hmm_data.out_v;
+	hmm_quaternion *out_q = bench_hmm_data.out_q;
+	float *out_f = bench_hmm_data.out_f;
+
+	uint64_t start = stm_now();
+	for (int r = 0; r < BENCH_HMM_REPEAT; r++) {
+		for (int i = 0; i < BENCH_HMM_COUNT; i++) {
+			out_v[i] = HMM_AddVec4(HMM_MultiplyVec4(u[i], v[i]), v[i]);
+		}
+		bench_hmm_sink += out_v[r & (BENCH_HMM_COUNT - 1)].Y;
+	}
+	bench_hmm_report("MultiplyVec4+AddVec4", stm_since(start));
+	float error = 0.0f;
+	for (int i = 0; i < BENCH_HMM_COUNT; i++) {
+		for (int k = 0; k < 4; k++) {
+			const float expected = u[i].Elements[k] * v[i].Elements[k] + v[i].Elements[k];
+			error = fmaxf(error, bench_hmm_error(out_v[i].Elements[k], expected, fabsf(expected)));
+		}
+	}
+	bench_check("hmm/MultiplyVec4+AddVec4", error, BENCH_HMM_TOLERANCE);
+
+	start = stm_now();
+	for (int r = 0; r < BENCH_HMM_REPEAT; r++) {
+		for (int i = 0; i < BENCH_HMM_COUNT; i++) {
+			out_f[i] = HMM_DotVec4(u[i], v[i]);
+		}
+		bench_hmm_sink += out_f[r & (BENCH_HMM_COUNT - 1)];
+	}
+	bench_hmm_report("DotVec4", stm_since(start));
+	error = 0.0f;
+	for (int i = 0; i < BENCH_HMM_COUNT; i++) {
+		float sum = 0.0f, scale = 0.0f;
+		for (int k = 0; k < 4; k++) {
+			sum += u[i].Elements[k] * v[i].Elements[k];
+			scale += fabsf(u[i].Elements[k] * v[i].Elements[k]);
+		}
+		error = fmaxf(error, bench_hmm_error(out_f[i], sum, scale));
+	}
+	bench_check("hmm/DotVec4", error, BENCH_HMM_TOLERANCE);
+
+	start = stm_now();
+	for (int r = 0; r < BENCH_HMM_REPEAT; r++) {
+		for (int i = 0; i < BENCH_HMM_COUNT; i++) {
+			out_v[i] = HMM_NormalizeVec4(u[i]);
+		}
+		bench_hmm_sink += out_v[r & (BENCH_HMM_COUNT - 1)].Z;
+	}
+	bench_hmm_report("NormalizeVec4", stm_since(start));
+	error = 0.0f;
+	for (int i = 0; i < BENCH_HMM_COUNT; i++) {
+		const float length = sqrtf(u[i].X * u[i].X + u[i].Y * u[i].Y + u[i].Z * u[i].Z + u[i].W * u[i].W);
+		for (int k = 0; k < 4; k++) {
+			error = fmaxf(error, fabsf(out_v[i].Elements[k] - u[i].Elements[k] / length));
+		}
+	}
+	bench_check("hmm/NormalizeVec4", error, BENCH_HMM_TOLERANCE);
+
+	start = stm_now();
+	for (int r = 0; r < BENCH_HMM_REPEAT; r++) {
+		for (int i = 0; i < BENCH_HMM_COUNT; i++) {
+			out_q[i] = HMM_MultiplyQuaternion(HMM_QuaternionV4(u[i]), HMM_QuaternionV4(v[i]));
+		}
+		bench_hmm_sink += out_q[r & (BENCH_HMM_COUNT - 1)].W;
+	}
+	bench_hmm_report("MultiplyQuaternion", stm_since(start));
+	error = 0.0f;
+	for (int i = 0; i < BENCH_HMM_COUNT; i++) {
+		const hmm_vec4 l = u[i], q = v[i];
+		const float expected[4] = {
+			l.X * q.W + l.Y * q.Z - l.Z * q.Y + l.W * q.X,
+			-l.X * q.Z + l.Y * q.W + l.Z * q.X + l.W * q.Y,
+			l.X * q.Y - l.Y * q.X + l.Z * q.W + l.W * q.Z,
+			-l.X * q.X - l.Y * q.Y - l.Z * q.Z + l.W * q.W,
+		};
+		const float scale = (fabsf(l.X) + fabsf(l.Y) + fabsf(l.Z) + fabsf(l.W)) * (fabsf(q.X) + fabsf(q.Y) + fabsf(q.Z) + fabsf(q.W));
+		for (int k = 0; k < 4; k++) {
+			error = fmaxf(error, bench_hmm_error(out_q[i].Elements[k], expected[k], scale));
+		}
+	}
+	bench_check("hmm/MultiplyQuaternion", error, BENCH_HMM_TOLERANCE);
+}
+
+void bench_hmm(void) {
+#ifdef HANDMADE_MATH__USE_SSE
+	printf("HandmadeMath: SSE path\n");
+#else
+	printf("HandmadeMath: scalar path\n");
+#endif
+	uint32_t seed = 1;
+	for (int i = 0; i < BENCH_HMM_COUNT; i++) {
+		for (int k = 0; k < 16; k++) {
+			bench_hmm_data.a[i].Elements[k / 4][k % 4] = 4.0f * bench_random(&seed);
+			bench_hmm_data.b[i].Elements[k / 4][k % 4] = 4.0f * bench_random(&seed);
+		}
+		// Away from zero so normalizing stays well conditioned
+		bench_hmm_data.u[i] = HMM_Vec4(1.0f + bench_random(&seed), bench_random(&seed),
+			bench_random(&seed), bench_random(&seed));
+		bench_hmm_data.v[i] = HMM_Vec4(8.0f * bench_random(&seed), 8.0f * bench_random(&seed),
+			8.0f * bench_random(&seed), 1.0f);
+	}
+	bench_hmm_mat4();
+	bench_hmm_vec4();
+}
@@ -0,0 +1,112 @@
+#include "bench.h"
+
+#include <math.h>
+#include <stdatomic.h>
+#include <stdio.h>
+
+#include "sokol_time.h"
+#include "job.h"
+#include "mem.h"
+
+#define BENCH_JOBS_ITEMS (1 << 22)
+#define BENCH_JOBS_TINY 100000
+#define BENCH_JOBS_REPEAT 5
+#define BENCH_JOBS_CHAIN 10000
+
+typedef struct bench_jobs_data_t {
+	const float *in;
+	float *out;
+} bench_jobs_data_t;
+
+static void bench_jobs_kernel(void *arg, int begin, int end) {
+	bench_jobs_data_t *data = arg;
+	for (int i = begin; i < end; i++) {
+		data->out[i] = sqrtf(data->in[i]) * sinf(data->in[i]);
+	}
+}
+
+static void bench_jobs_tiny(void *arg, int begin, int end) {
+	atomic_fetch_add_explicit((atomic_int*)arg, end - begin, memory_order_relaxed);
+}
+
+// One link of the chain, checks the previous one finished first
+static void bench_jobs_link(void *arg, int begin, int end) {
+	(void)end;
+	atomic_int *next = arg;
+	int expected = begin;
+	if (!atomic_compare_exchange_strong_explicit(next, &expected, begin + 1, memory_order_relaxed, memory_order_relaxed)) {
+		atomic_store_explicit(next, -1, memory_order_relaxed);
+	}
+}
+
+static void bench_jobs_run(int threads, bench_jobs_data_t *data, double *base_us) {
+	job_init(threads);
+	char name[64];
+
+	snprintf(name, sizeof(name), "jobs/parallel_for/t%d", job_num_threads());
+	uint64_t start = stm_now();
+	for (int r = 0; r < BENCH_JOBS_REPEAT; r++) {
+		job_parallel_for(BENCH_JOBS_ITEMS, 0, bench_jobs_kernel, data);
+	}
+	const uint64_t ticks = stm_since(start);
+	bench_result(name, BENCH_JOBS_ITEMS, BENCH_JOBS_REPEAT, ticks);
+	const double us = stm_us(ticks);
+	if (*base_us == 0.0) {
+		*base_us = us;
+	}
+	printf("%-40s %8.2fx speedup\n", "", *base_us / us);
+
+	// Scheduling overhead: one job per item, almost no work. A single thread
+	// runs parallel_for inline, that's the plain loop to compare against.
+	atomic_int sum = 0;
+	if (job_num_threads() == 1) {
+		snprintf(name, sizeof(name), "jobs/tiny/inline");
+	} else {
+		snprintf(name, sizeof(name), "jobs/tiny/t%d", job_num_threads());
+	}
+	start = stm_now();
+	job_parallel_for(BENCH_JOBS_TINY, 1, bench_jobs_tiny, &sum);
+	bench_result(name, BENCH_JOBS_TINY, 1, stm_since(start));
+	if (atomic_load(&sum) != BENCH_JOBS_TINY) {
+		bench_fail("jobs/tiny: lost jobs, %d of %d ran", atomic_load(&sum), BENCH_JOBS_TINY);
+	}
+
+	// Continuation latency: each link queued by the one before it
+	job_counter_t *counters = mem_calloc(MEM_TAG_GAME, BENCH_JOBS_CHAIN, sizeof(job_counter_t));
+	atomic_int next = 0;
+	snprintf(name, sizeof(name), "jobs/chain/t%d", job_num_threads());
+	start = stm_now();
+	job_run(&(job_desc_t){ .fn = bench_jobs_link, .arg = &next, .begin = 0, .end = 1 }, 1, &counters[0]);
+	for (int i = 1; i < BENCH_JOBS_CHAIN; i++) {
+		job_run_after(&counters[i - 1], &(job_desc_t){ .fn = bench_jobs_link, .arg = &next, .begin = i, .end = i + 1 },
+			&counters[i]);
+	}
+	job_wait(&counters[BENCH_JOBS_CHAIN - 1]);
+	bench_result(name, BENCH_JOBS_CHAIN, 1, stm_since(start));
+	if (atomic_load(&next) != BENCH_JOBS_CHAIN) {
+		bench_fail("jobs/chain: links ran out of order");
+	}
+	mem_free(counters);
+
+	job_shutdown();
+}
+
+void bench_jobs(void) {
+	float *in = mem_alloc(MEM_TAG_GAME, sizeof(float) * BENCH_JOBS_ITEMS);
+	float *out = mem_alloc(MEM_TAG_GAME, sizeof(float) * BENCH_JOBS_ITEMS);
+	for (int i = 0; i < BENCH_JOBS_ITEMS; i++) {
+		in[i] = (float)i * 0.001f;
+	}
+	bench_jobs_data_t data = { in, out };
+
+	const int max_threads = bench_max_threads();
+
+	double base_us = 0.0;
+	for (int threads = 1; threads < max_threads; threads *= 2) {
+		bench_jobs_run(threads, &data, &base_us);
+	}
+	bench_jobs_run(max_threads, &data, &base_us);
+
+	mem_free(in);
+	mem_free(out);
+}
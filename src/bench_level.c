@@ -0,0 +1,106 @@
+#include "bench.h"
+
+#include <stdio.h>
+#include <string.h>
+
+#include "sokol_time.h"
+#include "job.h"
+#include "level.h"
+#include "mem.h"
+
+#define BENCH_LEVEL_REPEAT 3
+
+/// 93 vertices per tile on average, 26x26 is the largest level within LEVEL_MAX_VERTICES
+static const int bench_level_sizes[] = { 8, 16, 26 };
+
+// Square floor of size x size tiles with a pillar on every other tile
+static level_prop_t *bench_level_props(int size, int *count) {
+	level_prop_t *props = mem_alloc(MEM_TAG_GAME, sizeof(level_prop_t) * (size_t)size * (size_t)size * 2);
+	int n = 0;
+	for (int z = 0; z < size; z++) {
+		for (int x = 0; x < size; x++) {
+			const hmm_vec3 p = HMM_Vec3((float)x * 2.0f, 0.0f, (float)z * 2.0f);
+			props[n++] = (level_prop_t){ .type = LEVEL_PROP_FLOOR, .position = HMM_AddVec3(p, HMM_Vec3(0, -1.5f, 0)), .size = HMM_Vec3(2.0f, 0, 2.0f), .tiles = 4 };
+			if ((x + z) % 2 == 0) {
+				props[n++] = (level_prop_t){ .type = LEVEL_PROP_PILLAR, .position = p };
+			}
+		}
+	}
+	*count = n;
+	return props;
+}
+
+static sshape_buffer_t bench_level_buffer(size_t num_vertices, size_t num_indices) {
+	return (sshape_buffer_t){
+		.vertices.buffer = { mem_alloc(MEM_TAG_GAME, num_vertices * sizeof(sshape_vertex_t)), num_vertices * sizeof(sshape_vertex_t) },
+		.indices.buffer = { mem_alloc(MEM_TAG_GAME, num_indices * sizeof(uint16_t)), num_indices * sizeof(uint16_t) },
+	};
+}
+
+static void bench_level_free(sshape_buffer_t *buf) {
+	mem_free((void*)buf->vertices.buffer.ptr);
+	mem_free((void*)buf->indices.buffer.ptr);
+}
+
+static bool bench_level_same(const sshape_buffer_t *a, const sshape_buffer_t *b) {
+	return a->valid && b->valid
+		&& a->vertices.data_size == b->vertices.data_size
+		&& a->indices.data_size == b->indices.data_size
+		&& memcmp(a->vertices.buffer.ptr, b->vertices.buffer.ptr, a->vertices.data_size) == 0
+		&& memcmp(a->indices.buffer.ptr, b->indices.buffer.ptr, a->indices.data_size) == 0;
+}
+
+static void bench_level_run(int size) {
+	int count = 0;
+	level_prop_t *props = bench_level_props(size, &count);
+	size_t num_vertices = 0;
+	size_t num_indices = 0;
+	level_geometry_size(props, count, &num_vertices, &num_indices);
+	printf("level %dx%d: %d props, %zu vertices, %zu indices\n", size, size, count, num_vertices, num_indices);
+
+	char name[64];
+	sshape_buffer_t serial = bench_level_buffer(num_vertices, num_indices);
+	const sshape_buffer_t empty = serial;
+	uint64_t start = stm_now();
+	for (int r = 0; r < BENCH_LEVEL_REPEAT; r++) {
+		serial = level_build_serial(empty, props, count);
+	}
+	const double serial_us = stm_us(stm_since(start));
+	snprintf(name, sizeof(name), "level/%d/serial", size);
+	bench_result(name, count, BENCH_LEVEL_REPEAT, stm_since(start));
+
+	sshape_buffer_t parallel = bench_level_buffer(num_vertices, num_indices);
+	const sshape_buffer_t parallel_empty = parallel;
+	const int max_threads = bench_max_threads();
+	for (int threads = 1;; threads = threads * 2 < max_threads ? threads * 2 : max_threads) {
+		job_init(threads);
+		// Clear so stale output from the last run can't hide a mismatch
+		memset((void*)parallel_empty.vertices.buffer.ptr, 0, parallel_empty.vertices.buffer.size);
+		memset((void*)parallel_empty.indices.buffer.ptr, 0, parallel_empty.indices.buffer.size);
+		start = stm_now();
+		for (int r = 0; r < BENCH_LEVEL_REPEAT; r++) {
+			parallel = level_build(parallel_empty, props, count);
+		}
+		const uint64_t ticks = stm_since(start);
+		snprintf(name, sizeof(name), "level/%d/parallel/t%d", size, job_num_threads());
+		bench_result(name, count, BENCH_LEVEL_REPEAT, ticks);
+		printf("%-40s %8.2fx vs serial\n", "", serial_us / stm_us(ticks));
+		if (!bench_level_same(&serial, &parallel)) {
+			bench_fail("%s: differs from the serial build", name);
+		}
+		job_shutdown();
+		if (threads == max_threads) {
+			break;
+		}
+	}
+
+	bench_level_free(&serial);
+	bench_level_free(&parallel);
+	mem_free(props);
+}
+
+void bench_level(void) {
+	for (int i = 0; i < (int)(sizeof(bench_level_sizes) / sizeof(bench_level_sizes[0])); i++) {
+		bench_level_run(bench_level_sizes[i]);
+	}
+}
@@ -0,0 +1,183 @@
+#include "bench.h"
+
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "sokol_time.h"
+#include "mixer.h"
+#include "thread.h"
+
+#define BENCH_MIXER_RATE 48000.0f
+#define BENCH_MIXER_BLOCK 256
+#define BENCH_MIXER_BLOCKS 4000
+#define BENCH_MIXER_PRODUCERS 3
+
+static volatile float bench_mixer_sink;
+static mixer_t bench_mixer_state;
+
+static const mixer_sound_t bench_mixer_sound = {
+	.wave = OSC_SAW, .freq = 220.0f, .freq_end = 110.0f, .sweep = 0.5f, .noise = 0.3f,
+	.attack = 0.01f, .decay = 0.1f, .sustain = 0.5f, .hold = -1.0f, .release = 0.1f, .gain = 0.1f,
+};
+
+typedef struct bench_mixer_producer_t {
+	mixer_t *mixer;
+	atomic_bool *done;
+	int played;
+} bench_mixer_producer_t;
+
+// Gameplay stand-in: triggers short sounds as fast as it can
+static void bench_mixer_producer(void *arg) {
+	bench_mixer_producer_t *p = arg;
+	mixer_sound_t sound = bench_mixer_sound;
+	sound.hold = 0.02f;
+	while (!atomic_load(p->done)) {
+		sound.priority = p->played % 3;
+		sound.pan = (float)(p->played % 7) / 3.5f - 1.0f;
+		mixer_play(p->mixer, &sound);
+		p->played++;
+		thread_yield();
+	}
+}
+
+// Renders blocks and reports the average and worst against the time one
+// block may take at 48 kHz
+static void bench_mixer_render(const char *name, mixer_t *m, bool yield) {
+	_Alignas(32) float left[BENCH_MIXER_BLOCK];
+	_Alignas(32) float right[BENCH_MIXER_BLOCK];
+	uint64_t total = 0;
+	uint64_t worst = 0;
+	for (int b = 0; b < BENCH_MIXER_BLOCKS; b++) {
+		memset(left, 0, sizeof(left));
+		memset(right, 0, sizeof(right));
+		const uint64_t start = stm_now();
+		mixer_render(m, left, right, BENCH_MIXER_BLOCK, BENCH_MIXER_RATE);
+		const uint64_t ticks = stm_since(start);
+		total += ticks;
+		worst = ticks > worst ? ticks : worst;
+		bench_mixer_sink += left[b & (BENCH_MIXER_BLOCK - 1)];
+		if (yield) {
+			// Like a device waiting for the next period, lets producers run
+			// even on a single core
+			thread_yield();
+		}
+	}
+	bench_result(name, BENCH_MIXER_BLOCKS * BENCH_MIXER_BLOCK, 1, total);
+	bench_budget(BENCH_MIXER_BLOCKS, BENCH_MIXER_BLOCK, BENCH_MIXER_RATE, total, worst);
+	printf("\n");
+}
+
+// Every voice busy: the most a block can ever cost
+static void bench_mixer_full(void) {
+	mixer_t *m = &bench_mixer_state;
+	mixer_init(m);
+	for (int i = 0; i < MIXER_VOICES; i++) {
+		mixer_play(m, &bench_mixer_sound);
+	}
+	bench_mixer_render("mixer/all_voices", m, false);
+	printf("%-40s %d voices active\n", "", atomic_load(&m->active));
+}
+
+// Producers on other threads flood the queue while the audio thread renders
+static void bench_mixer_flood(void) {
+	mixer_t *m = &bench_mixer_state;
+	mixer_init(m);
+	atomic_bool done = false;
+	bench_mixer_producer_t producers[BENCH_MIXER_PRODUCERS];
+	thread_t threads[BENCH_MIXER_PRODUCERS];
+	int started = 0;
+	for (int i = 0; i < BENCH_MIXER_PRODUCERS; i++) {
+		producers[i] = (bench_mixer_producer_t){.mixer = m, .done = &done};
+		if (thread_start(&threads[i], bench_mixer_producer, &producers[i])) {
+			started++;
+		}
+	}
+	if (started == 0) {
+		printf("mixer/flood: threads unavailable\n");
+		return;
+	}
+	bench_mixer_render("mixer/flood", m, true);
+	atomic_store(&done, true);
+	int played = 0;
+	for (int i = 0; i < started; i++) {
+		thread_join(&threads[i]);
+		played += producers[i].played;
+	}
+	printf("%-40s %d played by %d threads, %u stolen, %u outranked, %u dropped\n", "",
+		played, started, (unsigned)atomic_load(&m->stolen), (unsigned)atomic_load(&m->rejected),
+		(unsigned)atomic_load(&m->queue.dropped));
+}
+
+// A full scene: every voice follows one of MIXER_EMITTERS emitters spread
+// around the listener, the rest of the emitters are spatialized for nothing
+static void bench_mixer_spatial(void) {
+	mixer_t *m = &bench_mixer_state;
+	mixer_init(m);
+	mixer_sound_t sound = bench_mixer_sound;
+	sound.spatial = true;
+	mixer_voice_t voices[MIXER_VOICES];
+	for (int i = 0; i < MIXER_VOICES; i++) {
+		voices[i] = mixer_play(m, &sound);
+	}
+	mixer_scene_t *scene = mixer_scene_begin(m, HMM_Vec3(0, 0, 0), HMM_Vec3(1, 0, 0));
+	for (int e = 0; e < MIXER_EMITTERS; e++) {
+		const float angle = (float)e * 0.7f;
+		const float distance = 1.0f + (float)(e % 40);
+		mixer_scene_add(scene, HMM_Vec3(cosf(angle) * distance, 0.0f, sinf(angle) * distance), 1.0f, 30.0f,
+			e < MIXER_VOICES ? voices[e] : 0);
+	}
+	mixer_scene_publish(m);
+	bench_mixer_render("mixer/spatial", m, false);
+	printf("%-40s %d emitters, %d audible\n", "", MIXER_EMITTERS, atomic_load(&m->audible_emitters));
+}
+
+// Gains for one emitter at a few spots around a listener facing -z
+static void bench_mixer_spatial_check(void) {
+	static const struct {
+		const char *name;
+		hmm_vec3 position;
+	} spots[] = {
+		{ "ahead", { .Z = -5.0f } },
+		{ "right", { .X = 5.0f } },
+		{ "left", { .X = -5.0f } },
+		{ "near", { .X = 0.5f } },
+		{ "past radius", { .X = 25.0f } },
+	};
+	mixer_t *m = &bench_mixer_state;
+	for (int s = 0; s < (int)(sizeof(spots) / sizeof(spots[0])); s++) {
+		mixer_init(m);
+		mixer_sound_t sound = bench_mixer_sound;
+		sound.spatial = true;
+		sound.noise = 0.0f;
+		sound.attack = 0.0f;
+		sound.decay = 0.0f;
+		sound.sustain = 1.0f;
+		sound.gain = 1.0f;
+		const mixer_voice_t voice = mixer_play(m, &sound);
+		mixer_scene_t *scene = mixer_scene_begin(m, HMM_Vec3(0, 0, 0), HMM_Vec3(1, 0, 0));
+		mixer_scene_add(scene, spots[s].position, 1.0f, 20.0f, voice);
+		mixer_scene_publish(m);
+		_Alignas(32) float left[BENCH_MIXER_BLOCK];
+		_Alignas(32) float right[BENCH_MIXER_BLOCK];
+		float peak_left = 0.0f;
+		float peak_right = 0.0f;
+		for (int b = 0; b < 8; b++) {
+			memset(left, 0, sizeof(left));
+			memset(right, 0, sizeof(right));
+			mixer_render(m, left, right, BENCH_MIXER_BLOCK, BENCH_MIXER_RATE);
+			for (int i = 0; i < BENCH_MIXER_BLOCK; i++) {
+				peak_left = fabsf(left[i]) > peak_left ? fabsf(left[i]) : peak_left;
+				peak_right = fabsf(right[i]) > peak_right ? fabsf(right[i]) : peak_right;
+			}
+		}
+		printf("mixer/spatial %-12s peak left %.3f, right %.3f\n", spots[s].name, peak_left, peak_right);
+	}
+}
+
+void bench_mixer(void) {
+	bench_mixer_full();
+	bench_mixer_flood();
+	bench_mixer_spatial();
+	bench_mixer_spatial_check();
+}
@@ -0,0 +1,115 @@
+#include "bench.h"
+
+#include <math.h>
+#include <stdio.h>
+
+#include "sokol_time.h"
+#include "osc.h"
+
+#define BENCH_OSC_SAMPLES (1 << 20)
+#define BENCH_OSC_BLOCK 256
+/// Sine table against sin(), per interpolation
+#define BENCH_OSC_LINEAR_TOLERANCE 1e-5
+#define BENCH_OSC_CUBIC_TOLERANCE 1e-6
+
+static volatile float bench_osc_sink;
+
+// How many voices of this cost one core keeps up with in real time
+static void bench_osc_report(const char *name, uint64_t ticks) {
+	bench_result(name, BENCH_OSC_SAMPLES, 1, ticks);
+	const double samples_per_sec = BENCH_OSC_SAMPLES / stm_sec(ticks);
+	printf("%-40s %8.0f voices @ 44.1 kHz %8.0f voices @ 48 kHz\n", "",
+		samples_per_sec / 44100.0, samples_per_sec / 48000.0);
+}
+
+// The synth as it was before the wavetables: two double precision sin()
+// calls per sample
+static void bench_osc_sin_reference(void) {
+	const float mfreq = 40.0f;
+	const float freqfreq = 1.5f;
+	float block[BENCH_OSC_BLOCK];
+	int sample_index = 0;
+	const uint64_t start = stm_now();
+	for (int b = 0; b < BENCH_OSC_SAMPLES / BENCH_OSC_BLOCK; b++) {
+		for (int i = 0; i < BENCH_OSC_BLOCK; i++) {
+			const float t = (float)sample_index / 44100.0f;
+			const float freq = mfreq * sin(t * freqfreq);
+			block[i] = 0.5f * sin(freq * M_PI * 2);
+			sample_index++;
+		}
+		bench_osc_sink += block[b & (BENCH_OSC_BLOCK - 1)];
+	}
+	bench_osc_report("osc/fm/sin_reference", stm_since(start));
+}
+
+// The same voice on wavetables, as the synth renders it now
+static void bench_osc_fm_wavetable(void) {
+	osc_t lfo;
+	osc_init(&lfo, OSC_SINE, OSC_LINEAR);
+	osc_set_freq(&lfo, 1.5f / (2.0f * (float)M_PI), 44100.0f);
+	float phase[BENCH_OSC_BLOCK];
+	float block[BENCH_OSC_BLOCK];
+	const uint64_t start = stm_now();
+	for (int b = 0; b < BENCH_OSC_SAMPLES / BENCH_OSC_BLOCK; b++) {
+		osc_process(&lfo, phase, BENCH_OSC_BLOCK);
+		for (int i = 0; i < BENCH_OSC_BLOCK; i++) {
+			phase[i] *= 40.0f;
+		}
+		// 40 times the lfo's peak slope
+		osc_lookup(OSC_SINE, phase, block, BENCH_OSC_BLOCK, 40.0f * 1.5f / 44100.0f);
+		bench_osc_sink += block[b & (BENCH_OSC_BLOCK - 1)];
+	}
+	bench_osc_report("osc/fm/wavetable", stm_since(start));
+}
+
+static void bench_osc_wave(osc_wave_t wave, osc_interp_t interp) {
+	osc_t o;
+	osc_init(&o, wave, interp);
+	osc_set_freq(&o, 440.0f, 44100.0f);
+	float block[BENCH_OSC_BLOCK];
+	const uint64_t start = stm_now();
+	for (int b = 0; b < BENCH_OSC_SAMPLES / BENCH_OSC_BLOCK; b++) {
+		osc_process(&o, block, BENCH_OSC_BLOCK);
+		bench_osc_sink += block[b & (BENCH_OSC_BLOCK - 1)];
+	}
+	char name[64];
+	snprintf(name, sizeof(name), "osc/%s/%s", osc_wave_name(wave), interp == OSC_CUBIC ? "cubic" : "linear");
+	bench_osc_report(name, stm_since(start));
+}
+
+// Worst deviation of the sine table from sin() over a few thousand phases
+static void bench_osc_accuracy(void) {
+	osc_t o;
+	double max_error[2] = {0};
+	for (int interp = 0; interp < 2; interp++) {
+		osc_init(&o, OSC_SINE, (osc_interp_t)interp);
+		osc_set_freq(&o, 440.0f, 44100.0f);
+		float block[BENCH_OSC_BLOCK];
+		for (int b = 0; b < 16; b++) {
+			const uint32_t phase = o.phase;
+			osc_process(&o, block, BENCH_OSC_BLOCK);
+			for (int i = 0; i < BENCH_OSC_BLOCK; i++) {
+				const double p = (double)(uint32_t)(phase + (uint32_t)i * o.inc) / 4294967296.0;
+				const double error = fabs(block[i] - sin(2.0 * M_PI * p));
+				max_error[interp] = error > max_error[interp] ? error : max_error[interp];
+			}
+		}
+	}
+	printf("osc/sine max error: linear %.2e, cubic %.2e\n", max_error[OSC_LINEAR], max_error[OSC_CUBIC]);
+	bench_check("osc/sine/linear", max_error[OSC_LINEAR], BENCH_OSC_LINEAR_TOLERANCE);
+	bench_check("osc/sine/cubic", max_error[OSC_CUBIC], BENCH_OSC_CUBIC_TOLERANCE);
+}
+
+void bench_osc(void) {
+	const uint64_t start = stm_now();
+	osc_tables_init();
+	printf("osc tables built in %.2f ms\n", stm_ms(stm_since(start)));
+
+	bench_osc_sin_reference();
+	bench_osc_fm_wavetable();
+	for (int w = 0; w < OSC_WAVE_NUM; w++) {
+		bench_osc_wave((osc_wave_t)w, OSC_LINEAR);
+		bench_osc_wave((osc_wave_t)w, OSC_CUBIC);
+	}
+	bench_osc_accuracy();
+}
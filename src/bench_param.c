@@ -0,0 +1,151 @@
+#include "bench.h"
+
+#include <math.h>
+#include <stdio.h>
+
+#include "sokol_time.h"
+#include "param.h"
+
+#define BENCH_PARAM_SAMPLES (1 << 20)
+#define BENCH_PARAM_BLOCK 256
+#define BENCH_PARAM_RATE 48000
+#define BENCH_PARAM_COUNT 8
+
+static volatile float bench_param_sink;
+static param_bank_t bench_param_bank;
+
+static void bench_param_init(float value) {
+	float initial[PARAM_MAX];
+	for (int i = 0; i < PARAM_MAX; i++) {
+		initial[i] = value;
+	}
+	param_bank_init(&bench_param_bank, initial, BENCH_PARAM_COUNT, BENCH_PARAM_RATE);
+}
+
+// Renders BENCH_PARAM_COUNT parameters while `per_block` ramps arrive every
+// block at random frames, the worst case being a split at every event
+static void bench_param_render(int per_block) {
+	param_bank_t *b = &bench_param_bank;
+	bench_param_init(1.0f);
+	float out[BENCH_PARAM_BLOCK];
+	uint32_t noise = 1;
+	const uint64_t start = stm_now();
+	for (int block = 0; block < BENCH_PARAM_SAMPLES / BENCH_PARAM_BLOCK; block++) {
+		const uint64_t now = (uint64_t)block * BENCH_PARAM_BLOCK;
+		for (int e = 0; e < per_block; e++) {
+			bench_rand(&noise);
+			param_schedule(b, (int)(noise >> 29), now + (noise >> 8) % BENCH_PARAM_BLOCK, (float)(noise >> 16) / 65536.0f,
+				(noise >> 4) % 1024, e % 2 ? PARAM_EXPONENTIAL : PARAM_LINEAR);
+		}
+		param_bank_begin(b, BENCH_PARAM_RATE);
+		for (int done = 0; done < BENCH_PARAM_BLOCK;) {
+			const int k = param_bank_next(b, BENCH_PARAM_BLOCK - done);
+			for (int p = 0; p < BENCH_PARAM_COUNT; p++) {
+				param_render(&b->params[p], out + done, k);
+			}
+			done += k;
+		}
+		bench_param_sink += out[block & (BENCH_PARAM_BLOCK - 1)];
+	}
+	const uint64_t ticks = stm_since(start);
+
+	char name[64];
+	snprintf(name, sizeof(name), "param/render/%d_events_per_block", per_block);
+	bench_result(name, BENCH_PARAM_SAMPLES * BENCH_PARAM_COUNT, 1, ticks);
+}
+
+// Events scheduled inside a block must take effect on their exact frame, not
+// at the block boundary
+static void bench_param_accuracy(void) {
+	param_bank_t *b = &bench_param_bank;
+	bench_param_init(0.0f);
+	const uint64_t when = 1000;
+	const uint32_t ramp = 480;
+	param_schedule(b, 0, when, 1.0f, ramp, PARAM_LINEAR);
+	float out[BENCH_PARAM_BLOCK];
+	int64_t first_change = -1;
+	int64_t reached = -1;
+	for (uint64_t frame = 0; frame < 4 * BENCH_PARAM_BLOCK * 2;) {
+		param_bank_begin(b, BENCH_PARAM_RATE);
+		for (int done = 0; done < BENCH_PARAM_BLOCK;) {
+			const int k = param_bank_next(b, BENCH_PARAM_BLOCK - done);
+			param_render(&b->params[0], out + done, k);
+			done += k;
+		}
+		for (int i = 0; i < BENCH_PARAM_BLOCK; i++, frame++) {
+			if (first_change < 0 && out[i] != 0.0f) {
+				first_change = (int64_t)frame;
+			}
+			if (reached < 0 && out[i] == 1.0f) {
+				reached = (int64_t)frame;
+			}
+		}
+	}
+	// The first rendered sample of a ramp is one step along it
+	printf("param accuracy: ramp scheduled at frame %d moved at %d, reached target at %d (expected %d)\n",
+		(int)when, (int)first_change, (int)reached, (int)(when + ramp - 1));
+}
+
+// Largest jump between neighbouring samples of a sine whose gain goes from 0
+// to 1, set once per block as before versus ramped
+static void bench_param_zipper(float ramp_seconds) {
+	param_bank_t *b = &bench_param_bank;
+	bench_param_init(0.0f);
+	param_set(b, 0, 1.0f, ramp_seconds);
+	float gain[BENCH_PARAM_BLOCK];
+	float previous = 0.0f;
+	float max_jump = 0.0f;
+	int frame = 0;
+	for (int block = 0; block < 16; block++) {
+		param_bank_begin(b, BENCH_PARAM_RATE);
+		for (int done = 0; done < BENCH_PARAM_BLOCK;) {
+			const int k = param_bank_next(b, BENCH_PARAM_BLOCK - done);
+			param_render(&b->params[0], gain + done, k);
+			done += k;
+		}
+		for (int i = 0; i < BENCH_PARAM_BLOCK; i++, frame++) {
+			const float x = gain[i] * sinf(2.0f * (float)M_PI * 100.0f * (float)frame / BENCH_PARAM_RATE + 1.0f);
+			max_jump = fabsf(x - previous) > max_jump ? fabsf(x - previous) : max_jump;
+			previous = x;
+		}
+	}
+	printf("param zipper: gain 0 -> 1 over %5.1f ms, largest sample step %.4f\n", ramp_seconds * 1000.0f, max_jump);
+}
+
+// Cost of scheduling from another thread's point of view, bounded by the
+// queue: the audio thread drains it every block
+static void bench_param_schedule(void) {
+	param_bank_t *b = &bench_param_bank;
+	bench_param_init(0.0f);
+	const int rounds = 4096;
+	uint64_t ticks = 0;
+	int pushed = 0;
+	for (int r = 0; r < rounds; r++) {
+		const uint64_t start = stm_now();
+		for (int i = 0; i < PARAM_EVENTS_PER_BLOCK; i++) {
+			pushed += param_set(b, i % BENCH_PARAM_COUNT, (float)i, 0.01f);
+		}
+		ticks += stm_since(start);
+		param_bank_begin(b, BENCH_PARAM_RATE);
+		for (int done = 0; done < BENCH_PARAM_BLOCK;) {
+			const int k = param_bank_next(b, BENCH_PARAM_BLOCK - done);
+			for (int p = 0; p < BENCH_PARAM_COUNT; p++) {
+				param_advance(&b->params[p], k);
+			}
+			done += k;
+		}
+	}
+	bench_result("param/schedule", PARAM_EVENTS_PER_BLOCK, rounds, ticks);
+	printf("param schedule: %d of %d accepted, %u dropped from the pending list\n", pushed, rounds * PARAM_EVENTS_PER_BLOCK,
+		(unsigned)atomic_load(&b->dropped));
+}
+
+void bench_param(void) {
+	bench_param_render(0);
+	bench_param_render(4);
+	bench_param_render(32);
+	bench_param_schedule();
+	bench_param_accuracy();
+	bench_param_zipper(0.0f);
+	bench_param_zipper(0.02f);
+}
@@ -0,0 +1,136 @@
+#include "bench.h"
+
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "sokol_time.h"
+#include "music.h"
+#include "resample.h"
+#include "synth.h"
+
+#define BENCH_RESAMPLE_DEVICE 48000
+#define BENCH_RESAMPLE_BLOCK 256
+/// Ten seconds at the device rate
+#define BENCH_RESAMPLE_BLOCKS 1875
+
+static volatile float bench_resample_sink;
+static resample_t bench_resample_state;
+
+// Busy scenes keep every mixer voice playing one of these
+static const mixer_sound_t bench_resample_sound = {
+	.wave = OSC_SAW, .freq = 220.0f, .freq_end = 110.0f, .sweep = 0.5f, .noise = 0.3f,
+	.attack = 0.01f, .decay = 0.1f, .sustain = 0.5f, .hold = 0.2f, .release = 0.1f, .gain = 0.05f,
+};
+
+// Upsamples a sine and compares it with the exact one at the device rate,
+// after the filter delay
+static void bench_resample_accuracy(int in_rate, double freq) {
+	resample_t *r = &bench_resample_state;
+	if (!resample_init(r, in_rate, BENCH_RESAMPLE_DEVICE, 1)) {
+		printf("resample %d -> %d: not supported\n", in_rate, BENCH_RESAMPLE_DEVICE);
+		return;
+	}
+	const double delay = (double)(RESAMPLE_TAPS / 2) / in_rate;
+	_Alignas(32) float out[BENCH_RESAMPLE_BLOCK];
+	float *outs[] = { out };
+	uint64_t in_frame = 0;
+	double signal = 0.0;
+	double noise = 0.0;
+	for (int b = 0; b < 200; b++) {
+		const int needed = resample_needed(r, BENCH_RESAMPLE_BLOCK);
+		float *in = resample_input(r, 0);
+		for (int i = 0; i < needed; i++, in_frame++) {
+			in[i] = (float)sin(2.0 * M_PI * freq * (double)in_frame / in_rate);
+		}
+		resample_process(r, outs, BENCH_RESAMPLE_BLOCK);
+		// Past the filter warming up
+		for (int i = 0; b >= 4 && i < BENCH_RESAMPLE_BLOCK; i++) {
+			const double t = (double)(b * BENCH_RESAMPLE_BLOCK + i) / BENCH_RESAMPLE_DEVICE - delay;
+			const double expected = sin(2.0 * M_PI * freq * t);
+			signal += expected * expected;
+			noise += (out[i] - expected) * (out[i] - expected);
+		}
+	}
+	printf("resample %5d -> %d, %2d/%-3d phases, %5.0f Hz sine: %.1f dB SNR\n", in_rate, BENCH_RESAMPLE_DEVICE,
+		r->up, r->down, freq, 10.0 * log10(signal / noise));
+}
+
+static void bench_resample_throughput(int in_rate) {
+	resample_t *r = &bench_resample_state;
+	resample_init(r, in_rate, BENCH_RESAMPLE_DEVICE, 2);
+	_Alignas(32) float left[BENCH_RESAMPLE_BLOCK];
+	_Alignas(32) float right[BENCH_RESAMPLE_BLOCK];
+	float *outs[] = { left, right };
+	uint64_t ticks = 0;
+	for (int b = 0; b < BENCH_RESAMPLE_BLOCKS; b++) {
+		const int needed = resample_needed(r, BENCH_RESAMPLE_BLOCK);
+		for (int c = 0; c < 2; c++) {
+			float *in = resample_input(r, c);
+			for (int i = 0; i < needed; i++) {
+				in[i] = (float)((b + i + c) & 15) / 16.0f;
+			}
+		}
+		const uint64_t start = stm_now();
+		resample_process(r, outs, BENCH_RESAMPLE_BLOCK);
+		ticks += stm_since(start);
+		bench_resample_sink += left[b & (BENCH_RESAMPLE_BLOCK - 1)];
+	}
+	char name[64];
+	snprintf(name, sizeof(name), "resample/stereo/%d", in_rate);
+	bench_result(name, BENCH_RESAMPLE_BLOCKS * BENCH_RESAMPLE_BLOCK, 1, ticks);
+}
+
+// The whole callback with the synth, the music and its reverb running, at
+// the device rate and at an internal rate, and what the internal one saves.
+// Busy adds a full mixer of effects, the load where saving matters.
+static double bench_resample_synth(int internal_rate, bool busy, double base_us) {
+	static synth_t synth;
+	static tracker_song_t song;
+	static float buffer[BENCH_RESAMPLE_BLOCK * 2];
+	synth_init(&synth, BENCH_RESAMPLE_DEVICE, internal_rate);
+	synth.params.playing = true;
+	synth_publish(&synth);
+	if (tracker_song_load(&song, music_theme, music_theme_size)) {
+		tracker_play(&synth.tracker, &song);
+	}
+	uint64_t ticks = 0;
+	for (int b = 0; b < BENCH_RESAMPLE_BLOCKS; b++) {
+		for (int v = atomic_load(&synth.mixer.active); busy && v < MIXER_VOICES; v++) {
+			mixer_play(&synth.mixer, &bench_resample_sound);
+		}
+		const uint64_t start = stm_now();
+		synth_render(&synth, buffer, BENCH_RESAMPLE_BLOCK, 2);
+		ticks += stm_since(start);
+		// Stand in for the UI so the scope ring never fills up
+		while (ring_read(&synth.scope_ring, buffer, BENCH_RESAMPLE_BLOCK) > 0) {
+		}
+		bench_resample_sink += buffer[b & (BENCH_RESAMPLE_BLOCK - 1)];
+	}
+	char name[64];
+	snprintf(name, sizeof(name), "resample/synth%s/%d", busy ? "_busy" : "", synth.sample_rate);
+	bench_result(name, BENCH_RESAMPLE_BLOCKS * BENCH_RESAMPLE_BLOCK, 1, ticks);
+	const double us = stm_us(ticks);
+	bench_budget(BENCH_RESAMPLE_BLOCKS, BENCH_RESAMPLE_BLOCK, BENCH_RESAMPLE_DEVICE, ticks, 0);
+	if (base_us > 0.0) {
+		printf(", %+.0f%% CPU vs %d Hz", 100.0 * (us / base_us - 1.0), BENCH_RESAMPLE_DEVICE);
+	}
+	printf("\n");
+	return us;
+}
+
+void bench_resample(void) {
+	bench_resample_accuracy(24000, 1000.0);
+	bench_resample_accuracy(24000, 8000.0);
+	bench_resample_accuracy(22050, 1000.0);
+	bench_resample_accuracy(22050, 8000.0);
+	bench_resample_accuracy(16000, 5000.0);
+	bench_resample_throughput(24000);
+	bench_resample_throughput(22050);
+	for (int busy = 0; busy < 2; busy++) {
+		const double base_us = bench_resample_synth(0, busy, 0.0);
+		bench_resample_synth(32000, busy, base_us);
+		bench_resample_synth(24000, busy, base_us);
+		bench_resample_synth(22050, busy, base_us);
+	}
+}
@@ -0,0 +1,105 @@
+#include "bench.h"
+
+#include <stdio.h>
+
+#include "sokol_time.h"
+#include "ring.h"
+#include "thread.h"
+
+#define BENCH_RING_CAPACITY 8192
+#define BENCH_RING_BLOCK 256
+#define BENCH_RING_BLOCKS 200000
+
+typedef struct bench_ring_t {
+	ring_t ring;
+	float memory[BENCH_RING_CAPACITY];
+	atomic_bool done;
+	bool stall_consumer; /// consumer sleeps, producer must keep going
+
+	// Producer results
+	uint64_t write_ticks;
+	uint64_t max_write_ticks;
+	int written;
+} bench_ring_t;
+
+// Audio thread stand-in: pushes blocks of consecutive sample numbers as fast
+// as it can and times every write
+static void bench_ring_producer(void *arg) {
+	bench_ring_t *b = arg;
+	float block[BENCH_RING_BLOCK];
+	uint32_t next = 0;
+	for (int i = 0; i < BENCH_RING_BLOCKS; i++) {
+		for (int s = 0; s < BENCH_RING_BLOCK; s++) {
+			// Exact in a float up to 2^24, wraps long before that
+			block[s] = (float)((next + (uint32_t)s) & 0xffffff);
+		}
+		const uint64_t start = stm_now();
+		if (ring_write(&b->ring, block, BENCH_RING_BLOCK)) {
+			b->written++;
+		}
+		const uint64_t ticks = stm_since(start);
+		b->write_ticks += ticks;
+		b->max_write_ticks = ticks > b->max_write_ticks ? ticks : b->max_write_ticks;
+		next += BENCH_RING_BLOCK;
+	}
+	atomic_store(&b->done, true);
+}
+
+static void bench_ring_run(const char *name, bool stall_consumer) {
+	static bench_ring_t b;
+	ring_init(&b.ring, b.memory, BENCH_RING_CAPACITY);
+	atomic_store(&b.done, false);
+	b.stall_consumer = stall_consumer;
+	b.write_ticks = 0;
+	b.max_write_ticks = 0;
+	b.written = 0;
+
+	thread_t producer;
+	const uint64_t start = stm_now();
+	if (!thread_start(&producer, bench_ring_producer, &b)) {
+		printf("%s: threads unavailable\n", name);
+		return;
+	}
+
+	// UI stand-in: odd sized reads so they straddle block boundaries
+	float chunk[1000];
+	uint64_t received = 0;
+	uint64_t torn = 0;
+	float expected = -1.0f;
+	for (;;) {
+		const bool done = atomic_load(&b.done);
+		if (stall_consumer && !done) {
+			thread_sleep_ms(50);
+		}
+		const uint32_t n = ring_read(&b.ring, chunk, 1000);
+		for (uint32_t i = 0; i < n; i++) {
+			const float v = chunk[i];
+			// Dropped blocks leave gaps, but only at block boundaries
+			const bool block_start = ((uint32_t)v % BENCH_RING_BLOCK) == 0;
+			if (expected >= 0.0f && v != expected && !block_start) {
+				torn++;
+			}
+			expected = (float)(((uint32_t)v + 1) & 0xffffff);
+		}
+		received += n;
+		if (done && n == 0) {
+			break;
+		}
+	}
+	thread_join(&producer);
+	const uint64_t ticks = stm_since(start);
+
+	bench_result(name, BENCH_RING_BLOCKS, 1, ticks);
+	printf("%-40s write avg %.3f us, max %.3f us, %d of %d blocks written, %u dropped\n", "",
+		stm_us(b.write_ticks) / BENCH_RING_BLOCKS, stm_us(b.max_write_ticks), b.written, BENCH_RING_BLOCKS,
+		(unsigned)atomic_load(&b.ring.dropped));
+	printf("%-40s %llu samples received, %llu out of order\n", "", (unsigned long long)received, (unsigned long long)torn);
+	if (received != (uint64_t)b.written * BENCH_RING_BLOCK || torn != 0) {
+		bench_fail("%s: lost or reordered samples", name);
+	}
+}
+
+void bench_ring(void) {
+	bench_ring_run("ring/flood", false);
+	bench_ring_run("ring/stalled_reader", true);
+}
@@ -0,0 +1,188 @@
+#include "bench.h"
+
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "sokol_time.h"
+#include "job.h"
+#include "sfx_cache.h"
+
+#define BENCH_SFX_RATE 48000.0f
+#define BENCH_SFX_BLOCK 256
+#define BENCH_SFX_BLOCKS 4000
+#define BENCH_SFX_BYTES (512 * 1024)
+/// Fits about three of the sweeps below
+#define BENCH_SFX_SMALL_BYTES (160 * 1024)
+/// Cached PCM against the mixer's own, well below a 16 bit step
+#define BENCH_SFX_TOLERANCE 1e-5
+
+static volatile float bench_sfx_sink;
+static mixer_t bench_sfx_mixer;
+static sfx_cache_t bench_sfx_state;
+
+// The game's footstep and bump, the busiest effects
+static const mixer_sound_t bench_sfx_sounds[] = {
+	{
+		.wave = OSC_SINE, .freq = 90.0f, .freq_end = 45.0f, .sweep = 0.08f, .noise = 0.6f,
+		.attack = 0.002f, .decay = 0.09f, .gain = 0.4f,
+	},
+	{
+		.wave = OSC_TRIANGLE, .freq = 120.0f, .freq_end = 60.0f, .sweep = 0.15f, .noise = 0.2f,
+		.attack = 0.003f, .decay = 0.05f, .sustain = 0.5f, .hold = 0.05f, .release = 0.15f, .gain = 0.5f,
+	},
+};
+
+#define BENCH_SFX_NUM_SOUNDS (int)(sizeof(bench_sfx_sounds) / sizeof(bench_sfx_sounds[0]))
+
+// Keeps every voice busy with effects, synthesized or from the cache, and
+// reports the block cost against the time one block may take
+static void bench_sfx_cost(const char *name, sfx_cache_t *cache) {
+	mixer_t *m = &bench_sfx_mixer;
+	mixer_init(m);
+	_Alignas(32) float left[BENCH_SFX_BLOCK];
+	_Alignas(32) float right[BENCH_SFX_BLOCK];
+	uint64_t total = 0;
+	uint64_t worst = 0;
+	int played = 0;
+	for (int b = 0; b < BENCH_SFX_BLOCKS; b++) {
+		for (int v = atomic_load(&m->active); v < MIXER_VOICES; v++, played++) {
+			mixer_sound_t sound = bench_sfx_sounds[played % BENCH_SFX_NUM_SOUNDS];
+			sound.pan = (float)(played % 7) / 3.5f - 1.0f;
+			if (cache) {
+				sfx_cache_play(cache, m, &sound);
+			} else {
+				mixer_play(m, &sound);
+			}
+		}
+		memset(left, 0, sizeof(left));
+		memset(right, 0, sizeof(right));
+		const uint64_t start = stm_now();
+		mixer_render(m, left, right, BENCH_SFX_BLOCK, BENCH_SFX_RATE);
+		const uint64_t ticks = stm_since(start);
+		total += ticks;
+		worst = ticks > worst ? ticks : worst;
+		bench_sfx_sink += left[b & (BENCH_SFX_BLOCK - 1)];
+	}
+	bench_result(name, BENCH_SFX_BLOCKS * BENCH_SFX_BLOCK, 1, total);
+	bench_budget(BENCH_SFX_BLOCKS, BENCH_SFX_BLOCK, BENCH_SFX_RATE, total, worst);
+	printf(", %d sounds\n", played);
+}
+
+// A cached sound must play back what the mixer would have synthesized. Noise
+// is seeded per voice, so this compares a pure tone.
+static void bench_sfx_accuracy(sfx_cache_t *cache) {
+	mixer_sound_t sound = bench_sfx_sounds[1];
+	sound.noise = 0.0f;
+	const int frames = mixer_sound_frames(&sound, BENCH_SFX_RATE);
+	_Alignas(32) float synthesized[2][BENCH_SFX_BLOCK];
+	_Alignas(32) float cached[2][BENCH_SFX_BLOCK];
+	mixer_t *m = &bench_sfx_mixer;
+	static mixer_t cached_mixer;
+	mixer_init(m);
+	mixer_init(&cached_mixer);
+	mixer_play(m, &sound);
+	sfx_cache_load(cache, &sound);
+	job_wait(&cache->jobs);
+	sfx_cache_play(cache, &cached_mixer, &sound);
+	float error = 0.0f;
+	float peak = 0.0f;
+	for (int done = 0; done < frames; done += BENCH_SFX_BLOCK) {
+		memset(synthesized, 0, sizeof(synthesized));
+		memset(cached, 0, sizeof(cached));
+		mixer_render(m, synthesized[0], synthesized[1], BENCH_SFX_BLOCK, BENCH_SFX_RATE);
+		mixer_render(&cached_mixer, cached[0], cached[1], BENCH_SFX_BLOCK, BENCH_SFX_RATE);
+		for (int i = 0; i < BENCH_SFX_BLOCK; i++) {
+			const float e = fabsf(synthesized[0][i] - cached[0][i]);
+			error = e > error ? e : error;
+			peak = fabsf(synthesized[0][i]) > peak ? fabsf(synthesized[0][i]) : peak;
+		}
+	}
+	printf("sfx accuracy: %d samples, max error %.2e (peak %.3f)\n", frames, (double)error, (double)peak);
+	bench_check("sfx/accuracy", error, BENCH_SFX_TOLERANCE);
+}
+
+// More patches than fit: the oldest go, the one still playing stays
+static void bench_sfx_eviction(void) {
+	sfx_cache_t *c = &bench_sfx_state;
+	sfx_cache_init(c, BENCH_SFX_SMALL_BYTES, BENCH_SFX_RATE);
+	mixer_t *m = &bench_sfx_mixer;
+	mixer_init(m);
+	mixer_sound_t sound = bench_sfx_sounds[1];
+	sfx_cache_load(c, &sound);
+	job_wait(&c->jobs);
+	sfx_cache_play(c, m, &sound);
+	_Alignas(32) float left[BENCH_SFX_BLOCK];
+	_Alignas(32) float right[BENCH_SFX_BLOCK];
+	mixer_render(m, left, right, BENCH_SFX_BLOCK, BENCH_SFX_RATE);
+	const int patches = 16;
+	int refused = 0;
+	for (int i = 0; i < patches; i++) {
+		mixer_sound_t other = sound;
+		other.freq = 200.0f + 10.0f * (float)i;
+		refused += !sfx_cache_load(c, &other);
+		job_wait(&c->jobs);
+	}
+	int resident = 0;
+	bool playing_kept = false;
+	for (int i = 0; i < SFX_CACHE_ENTRIES; i++) {
+		resident += c->entries[i].bytes > 0;
+		playing_kept = playing_kept || (c->entries[i].bytes > 0 && c->entries[i].patch.freq == sound.freq);
+	}
+	printf("sfx eviction: %d patches into %zu KiB, %d resident, %u evicted, %d refused\n", patches + 1,
+		c->capacity / 1024, resident, (unsigned)c->evictions, refused);
+	if (!playing_kept) {
+		bench_fail("sfx eviction: evicted the patch a voice is playing");
+	}
+	sfx_cache_shutdown(c);
+}
+
+// A new mixer rate re-renders every cached patch at that rate
+static void bench_sfx_rate_change(void) {
+	sfx_cache_t *c = &bench_sfx_state;
+	sfx_cache_init(c, BENCH_SFX_BYTES, BENCH_SFX_RATE);
+	for (int i = 0; i < BENCH_SFX_NUM_SOUNDS; i++) {
+		sfx_cache_load(c, &bench_sfx_sounds[i]);
+	}
+	job_wait(&c->jobs);
+	const float rate = BENCH_SFX_RATE * 2.0f;
+	sfx_cache_set_rate(c, rate);
+	job_wait(&c->jobs);
+	int rendered = 0;
+	int stale = 0;
+	for (int i = 0; i < SFX_CACHE_ENTRIES; i++) {
+		const sfx_entry_t *e = &c->entries[i];
+		if (e->bytes > 0 && e->sample_rate == rate && e->num_samples > mixer_sound_frames(&e->patch, BENCH_SFX_RATE)) {
+			rendered++;
+		} else if (e->bytes > 0 && e->sample_rate != rate) {
+			stale++;
+		}
+	}
+	printf("sfx rate change: %d of %d patches rendered again at %.0f Hz\n", rendered, BENCH_SFX_NUM_SOUNDS, (double)rate);
+	if (rendered != BENCH_SFX_NUM_SOUNDS || stale) {
+		bench_fail("sfx rate change: %d patches left at the old rate", stale);
+	}
+	sfx_cache_shutdown(c);
+}
+
+void bench_sfx_cache(void) {
+	job_init(0);
+	sfx_cache_t *c = &bench_sfx_state;
+	sfx_cache_init(c, BENCH_SFX_BYTES, BENCH_SFX_RATE);
+	const uint64_t start = stm_now();
+	for (int i = 0; i < BENCH_SFX_NUM_SOUNDS; i++) {
+		sfx_cache_load(c, &bench_sfx_sounds[i]);
+	}
+	job_wait(&c->jobs);
+	printf("sfx cache: %d sounds, %zu bytes, rendered in %.1f us\n", BENCH_SFX_NUM_SOUNDS, c->used, stm_us(stm_since(start)));
+
+	bench_sfx_cost("sfx/synthesized", NULL);
+	bench_sfx_cost("sfx/cached", c);
+	printf("%-40s %u hits, %u synthesized\n", "", (unsigned)c->hits, (unsigned)c->misses);
+	bench_sfx_accuracy(c);
+	sfx_cache_shutdown(c);
+
+	bench_sfx_eviction();
+	bench_sfx_rate_change();
+	job_shutdown();
+}
@@ -0,0 +1,135 @@
+#include "bench.h"
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "sokol_time.h"
+#include "music.h"
+#include "tracker.h"
+
+#define BENCH_TRACKER_RATE 48000.0f
+#define BENCH_TRACKER_BLOCK 256
+/// A minute of music at 48 kHz
+#define BENCH_TRACKER_BLOCKS 11250
+/// Samples a note may start away from its row, none
+#define BENCH_TRACKER_TOLERANCE 0.0
+/// Rows of the click song played, a note every other row
+#define BENCH_TRACKER_ROWS 40
+
+static volatile float bench_tracker_sink;
+static mixer_t bench_tracker_mixer;
+static tracker_t bench_tracker_state;
+static tracker_song_t bench_tracker_song;
+
+// One channel of white noise bursts, a note and a release per two rows. 123
+// bpm makes a row 5853.66 samples long, so rows don't fall on block edges.
+static const uint8_t bench_tracker_clicks[] = {
+	'T', '4', 'T', 'K', 1,
+	123, 4, 1, 4, 1, 1, 1,
+	OSC_SQUARE, 255, 0, 0, 255, 0, 255, 0, 0, 0,
+	0,
+	0x83, TRACKER_NOTE(4, 0), 1,
+	0x81, TRACKER_NOTE_OFF,
+	TRACKER_NOTE(4, 0), 1, 64,
+	0x81, TRACKER_NOTE_OFF,
+};
+
+// Plays the theme and reports the cost of the sequencer alone and of the
+// whole music block against the time one block may take
+static void bench_tracker_cost(void) {
+	mixer_t *m = &bench_tracker_mixer;
+	tracker_t *t = &bench_tracker_state;
+	mixer_init(m);
+	tracker_init(t);
+	tracker_play(t, &bench_tracker_song);
+	_Alignas(32) float left[BENCH_TRACKER_BLOCK];
+	_Alignas(32) float right[BENCH_TRACKER_BLOCK];
+	uint64_t sequencer = 0;
+	uint64_t total = 0;
+	uint64_t worst = 0;
+	int peak_voices = 0;
+	for (int b = 0; b < BENCH_TRACKER_BLOCKS; b++) {
+		memset(left, 0, sizeof(left));
+		memset(right, 0, sizeof(right));
+		const uint64_t start = stm_now();
+		tracker_render(t, m, BENCH_TRACKER_BLOCK, BENCH_TRACKER_RATE);
+		const uint64_t sequenced = stm_now();
+		mixer_render(m, left, right, BENCH_TRACKER_BLOCK, BENCH_TRACKER_RATE);
+		const uint64_t ticks = stm_since(start);
+		sequencer += stm_diff(sequenced, start);
+		total += ticks;
+		worst = ticks > worst ? ticks : worst;
+		const int voices = atomic_load(&m->active);
+		peak_voices = voices > peak_voices ? voices : peak_voices;
+		bench_tracker_sink += left[b & (BENCH_TRACKER_BLOCK - 1)];
+	}
+	bench_result("tracker/sequencer", BENCH_TRACKER_BLOCKS * BENCH_TRACKER_BLOCK, 1, sequencer);
+	bench_budget(BENCH_TRACKER_BLOCKS, BENCH_TRACKER_BLOCK, BENCH_TRACKER_RATE, sequencer, 0);
+	printf(", %u rows\n", (unsigned)atomic_load(&t->rows_played));
+	bench_result("tracker/with_voices", BENCH_TRACKER_BLOCKS * BENCH_TRACKER_BLOCK, 1, total);
+	bench_budget(BENCH_TRACKER_BLOCKS, BENCH_TRACKER_BLOCK, BENCH_TRACKER_RATE, total, worst);
+	printf(", up to %d voices\n", peak_voices);
+}
+
+// Every note must start on the sample its row starts on, wherever the row
+// falls inside a block
+static void bench_tracker_accuracy(void) {
+	tracker_song_t song;
+	if (!tracker_song_load(&song, bench_tracker_clicks, sizeof(bench_tracker_clicks))) {
+		bench_fail("tracker accuracy: test song doesn't load");
+		return;
+	}
+	mixer_t *m = &bench_tracker_mixer;
+	tracker_t *t = &bench_tracker_state;
+	mixer_init(m);
+	tracker_init(t);
+	tracker_play(t, &song);
+	const double row_samples = BENCH_TRACKER_RATE * 60.0 / (123.0 * 4.0);
+	_Alignas(32) float left[BENCH_TRACKER_BLOCK];
+	_Alignas(32) float right[BENCH_TRACKER_BLOCK];
+	int onsets = 0;
+	int missed = 0;
+	int64_t worst = 0;
+	bool sounding = false;
+	for (int64_t frame = 0; frame < (int64_t)(row_samples * BENCH_TRACKER_ROWS);) {
+		memset(left, 0, sizeof(left));
+		memset(right, 0, sizeof(right));
+		tracker_render(t, m, BENCH_TRACKER_BLOCK, BENCH_TRACKER_RATE);
+		mixer_render(m, left, right, BENCH_TRACKER_BLOCK, BENCH_TRACKER_RATE);
+		for (int i = 0; i < BENCH_TRACKER_BLOCK; i++, frame++) {
+			const bool now = left[i] != 0.0f;
+			if (now && !sounding) {
+				// A row starts on the sample its exact time falls into
+				const int64_t row = (int64_t)floor((double)frame / row_samples + 0.5);
+				const int64_t expected = (int64_t)floor((double)row * row_samples);
+				const int64_t error = llabs(frame - expected);
+				worst = error > worst ? error : worst;
+				missed += error != 0;
+				onsets++;
+			}
+			sounding = now;
+		}
+	}
+	printf("tracker accuracy: %d notes, %d not on their row's sample, worst %d samples off\n", onsets, missed, (int)worst);
+	// The last block may run into the row after the last one
+	if (onsets < BENCH_TRACKER_ROWS / 2) {
+		bench_fail("tracker accuracy: %d notes started, expected %d", onsets, BENCH_TRACKER_ROWS / 2);
+	}
+	bench_check("tracker/accuracy", (double)worst, BENCH_TRACKER_TOLERANCE);
+}
+
+void bench_tracker(void) {
+	if (!tracker_song_load(&bench_tracker_song, music_theme, music_theme_size)) {
+		bench_fail("tracker: theme doesn't load");
+		return;
+	}
+	const tracker_song_t *s = &bench_tracker_song;
+	const double seconds = (double)s->order_length * s->rows * 60.0 / (s->bpm * s->rows_per_beat);
+	printf("tracker theme: %zu bytes for %.1f s of music (%d patterns, %d positions, %d instruments), %.1f bytes/s\n",
+		s->size, seconds, s->num_patterns, s->order_length, s->num_instruments, (double)s->size / seconds);
+	printf("tracker memory: %zu bytes of song state, %zu bytes of player\n", sizeof(tracker_song_t), sizeof(tracker_t));
+	bench_tracker_cost();
+	bench_tracker_accuracy();
+}
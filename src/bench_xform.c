@@ -0,0 +1,211 @@
+#include "bench.h"
+
+#include <math.h>
+#include <stdio.h>
+
+#include "sokol_time.h"
+#include "aabb.h"
+#include "mem.h"
+#include "xform.h"
+
+/// Objects transformed per size, over as many repeats as it takes
+#define BENCH_XFORM_WORK 4000000
+#define BENCH_XFORM_MAX 100000
+#define BENCH_XFORM_TOLERANCE 1e-4f
+
+static const int bench_xform_sizes[] = { 1000, 10000, 100000 };
+static volatile float bench_xform_sink;
+
+typedef struct bench_xform_data_t {
+	hmm_mat4 *models;
+	hmm_mat4 *out;
+	hmm_mat4 *expected;
+	hmm_vec4 *points; /// the same points as soa, w = 1
+	hmm_vec4 *points_out;
+	aabb_t *boxes; /// the same boxes as boxes_soa
+	aabb_t *boxes_out;
+	float *soa; /// backs the arrays below
+	xform_points_t points_soa;
+	xform_points_t points_soa_out;
+	xform_boxes_t boxes_soa;
+	xform_boxes_t boxes_soa_out;
+} bench_xform_data_t;
+
+static void bench_xform_report(const char *name, int n, int repeat, uint64_t ticks, double base_us) {
+	char full[64];
+	snprintf(full, sizeof(full), "xform/%s/%d", name, n);
+	bench_result(full, n, repeat, ticks);
+	if (base_us > 0.0) {
+		printf("%-40s %8.2fx vs one at a time\n", "", base_us / stm_us(ticks));
+	}
+}
+
+static void bench_xform_check(const char *name, int n, float error) {
+	char full[64];
+	snprintf(full, sizeof(full), "xform/%s/%d", name, n);
+	bench_check(full, error, BENCH_XFORM_TOLERANCE);
+}
+
+// The box around all eight transformed corners, what a caller without
+// xform_boxes() would do
+static aabb_t bench_xform_box(const hmm_mat4 m, const aabb_t b) {
+	aabb_t out = { INFINITY, INFINITY, INFINITY, -INFINITY, -INFINITY, -INFINITY };
+	for (int c = 0; c < 8; c++) {
+		const hmm_vec4 p = HMM_MultiplyMat4ByVec4(m, HMM_Vec4((c & 1) ? b.max_x : b.min_x,
+			(c & 2) ? b.max_y : b.min_y, (c & 4) ? b.max_z : b.min_z, 1.0f));
+		out.min_x = fminf(out.min_x, p.X);
+		out.min_y = fminf(out.min_y, p.Y);
+		out.min_z = fminf(out.min_z, p.Z);
+		out.max_x = fmaxf(out.max_x, p.X);
+		out.max_y = fmaxf(out.max_y, p.Y);
+		out.max_z = fmaxf(out.max_z, p.Z);
+	}
+	return out;
+}
+
+// Matrices go through view_proj, points and bounds into view space
+static void bench_xform_run(bench_xform_data_t *d, const hmm_mat4 *view_proj, const hmm_mat4 *view, int n) {
+	const int repeat = BENCH_XFORM_WORK / n;
+
+	uint64_t start = stm_now();
+	for (int r = 0; r < repeat; r++) {
+		for (int i = 0; i < n; i++) {
+			d->expected[i] = HMM_MultiplyMat4(*view_proj, d->models[i]);
+		}
+		bench_xform_sink += d->expected[r % n].Elements[3][0];
+	}
+	uint64_t ticks = stm_since(start);
+	bench_xform_report("mat4/each", n, repeat, ticks, 0.0);
+	double base_us = stm_us(ticks);
+	start = stm_now();
+	for (int r = 0; r < repeat; r++) {
+		xform_mul_mat4(d->out, view_proj, d->models, n);
+		bench_xform_sink += d->out[r % n].Elements[3][0];
+	}
+	bench_xform_report("mat4/batch", n, repeat, stm_since(start), base_us);
+	float error = 0.0f;
+	for (int i = 0; i < n; i++) {
+		for (int k = 0; k < 16; k++) {
+			error = fmaxf(error, fabsf(d->out[i].Elements[k / 4][k % 4] - d->expected[i].Elements[k / 4][k % 4]));
+		}
+	}
+	bench_xform_check("mat4", n, error);
+
+	start = stm_now();
+	for (int r = 0; r < repeat; r++) {
+		for (int i = 0; i < n; i++) {
+			d->points_out[i] = HMM_MultiplyMat4ByVec4(*view, d->points[i]);
+		}
+		bench_xform_sink += d->points_out[r % n].X;
+	}
+	ticks = stm_since(start);
+	bench_xform_report("points/each", n, repeat, ticks, 0.0);
+	base_us = stm_us(ticks);
+	start = stm_now();
+	for (int r = 0; r < repeat; r++) {
+		xform_points(&d->points_soa_out, view, &d->points_soa, n);
+		bench_xform_sink += d->points_soa_out.x[r % n];
+	}
+	bench_xform_report("points/batch", n, repeat, stm_since(start), base_us);
+	error = 0.0f;
+	for (int i = 0; i < n; i++) {
+		error = fmaxf(error, fabsf(d->points_soa_out.x[i] - d->points_out[i].X));
+		error = fmaxf(error, fabsf(d->points_soa_out.y[i] - d->points_out[i].Y));
+		error = fmaxf(error, fabsf(d->points_soa_out.z[i] - d->points_out[i].Z));
+	}
+	bench_xform_check("points", n, error);
+
+	start = stm_now();
+	for (int r = 0; r < repeat; r++) {
+		for (int i = 0; i < n; i++) {
+			d->boxes_out[i] = bench_xform_box(*view, d->boxes[i]);
+		}
+		bench_xform_sink += d->boxes_out[r % n].min_x;
+	}
+	ticks = stm_since(start);
+	bench_xform_report("boxes/corners", n, repeat, ticks, 0.0);
+	base_us = stm_us(ticks);
+	start = stm_now();
+	for (int r = 0; r < repeat; r++) {
+		xform_boxes(&d->boxes_soa_out, view, &d->boxes_soa, n);
+		bench_xform_sink += d->boxes_soa_out.min_x[r % n];
+	}
+	bench_xform_report("boxes/batch", n, repeat, stm_since(start), base_us);
+	error = 0.0f;
+	for (int i = 0; i < n; i++) {
+		const aabb_t *b = &d->boxes_out[i];
+		error = fmaxf(error, fabsf(d->boxes_soa_out.min_x[i] - b->min_x));
+		error = fmaxf(error, fabsf(d->boxes_soa_out.min_y[i] - b->min_y));
+		error = fmaxf(error, fabsf(d->boxes_soa_out.min_z[i] - b->min_z));
+		error = fmaxf(error, fabsf(d->boxes_soa_out.max_x[i] - b->max_x));
+		error = fmaxf(error, fabsf(d->boxes_soa_out.max_y[i] - b->max_y));
+		error = fmaxf(error, fabsf(d->boxes_soa_out.max_z[i] - b->max_z));
+	}
+	bench_xform_check("boxes", n, error);
+}
+
+void bench_xform(void) {
+	const int n = BENCH_XFORM_MAX;
+	bench_xform_data_t d = {
+		.models = mem_alloc(MEM_TAG_GAME, sizeof(hmm_mat4) * n),
+		.out = mem_alloc(MEM_TAG_GAME, sizeof(hmm_mat4) * n),
+		.expected = mem_alloc(MEM_TAG_GAME, sizeof(hmm_mat4) * n),
+		.points = mem_alloc(MEM_TAG_GAME, sizeof(hmm_vec4) * n),
+		.points_out = mem_alloc(MEM_TAG_GAME, sizeof(hmm_vec4) * n),
+		.boxes = mem_alloc(MEM_TAG_GAME, sizeof(aabb_t) * n),
+		.boxes_out = mem_alloc(MEM_TAG_GAME, sizeof(aabb_t) * n),
+		.soa = mem_alloc(MEM_TAG_GAME, sizeof(float) * n * 18),
+	};
+	float *soa = d.soa;
+	float **arrays[] = {
+		&d.points_soa.x, &d.points_soa.y, &d.points_soa.z,
+		&d.points_soa_out.x, &d.points_soa_out.y, &d.points_soa_out.z,
+		&d.boxes_soa.min_x, &d.boxes_soa.min_y, &d.boxes_soa.min_z,
+		&d.boxes_soa.max_x, &d.boxes_soa.max_y, &d.boxes_soa.max_z,
+		&d.boxes_soa_out.min_x, &d.boxes_soa_out.min_y, &d.boxes_soa_out.min_z,
+		&d.boxes_soa_out.max_x, &d.boxes_soa_out.max_y, &d.boxes_soa_out.max_z,
+	};
+	for (int a = 0; a < 18; a++) {
+		*arrays[a] = soa + (size_t)a * n;
+	}
+
+	// Props scattered over a level: translated, rotated and scaled
+	uint32_t seed = 1;
+	for (int i = 0; i < n; i++) {
+		const hmm_vec3 position = HMM_Vec3(50.0f * bench_random(&seed), 5.0f * bench_random(&seed),
+			50.0f * bench_random(&seed));
+		const float angle = 180.0f * bench_random(&seed);
+		const float scale = 1.5f + bench_random(&seed);
+		d.models[i] = HMM_MultiplyMat4(HMM_Translate(position),
+			HMM_MultiplyMat4(HMM_Rotate(angle, HMM_Vec3(0.0f, 1.0f, 0.0f)), HMM_Scale(HMM_Vec3(scale, scale, scale))));
+		d.points[i] = HMM_Vec4v(position, 1.0f);
+		d.points_soa.x[i] = position.X;
+		d.points_soa.y[i] = position.Y;
+		d.points_soa.z[i] = position.Z;
+		const hmm_vec3 half = HMM_Vec3(1.0f + bench_random(&seed), 1.0f + bench_random(&seed),
+			1.0f + bench_random(&seed));
+		d.boxes[i] = (aabb_t){ position.X - half.X, position.Y - half.Y, position.Z - half.Z,
+			position.X + half.X, position.Y + half.Y, position.Z + half.Z };
+		d.boxes_soa.min_x[i] = d.boxes[i].min_x;
+		d.boxes_soa.min_y[i] = d.boxes[i].min_y;
+		d.boxes_soa.min_z[i] = d.boxes[i].min_z;
+		d.boxes_soa.max_x[i] = d.boxes[i].max_x;
+		d.boxes_soa.max_y[i] = d.boxes[i].max_y;
+		d.boxes_soa.max_z[i] = d.boxes[i].max_z;
+	}
+	const hmm_mat4 view = HMM_LookAt(HMM_Vec3(0.0f, 20.0f, 60.0f), HMM_Vec3(0.0f, 0.0f, 0.0f), HMM_Vec3(0.0f, 1.0f, 0.0f));
+	const hmm_mat4 view_proj = HMM_MultiplyMat4(HMM_Perspective(60.0f, 16.0f / 9.0f, 0.01f, 1000.0f), view);
+
+	for (int s = 0; s < (int)(sizeof(bench_xform_sizes) / sizeof(bench_xform_sizes[0])); s++) {
+		bench_xform_run(&d, &view_proj, &view, bench_xform_sizes[s]);
+	}
+
+	mem_free(d.models);
+	mem_free(d.out);
+	mem_free(d.expected);
+	mem_free(d.points);
+	mem_free(d.points_out);
+	mem_free(d.boxes);
+	mem_free(d.boxes_out);
+	mem_free(d.soa);
+}
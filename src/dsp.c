@@ -0,0 +1,105 @@
+#include "dsp.h"
+
+const char *dsp_simd_name(void) {
+	return SIMD_NAME;
+}
+
+void dsp_gain(float *x, float gain, int n) {
+	const vf_t g = vf_set1(gain);
+	int i = 0;
+	for (; i + SIMD_WIDTH <= n; i += SIMD_WIDTH) {
+		vf_store(x + i, vf_mul(vf_load(x + i), g));
+	}
+	for (; i < n; i++) {
+		x[i] *= gain;
+	}
+}
+
+void dsp_mul(float *x, const float *y, int n) {
+	int i = 0;
+	for (; i + SIMD_WIDTH <= n; i += SIMD_WIDTH) {
+		vf_store(x + i, vf_mul(vf_load(x + i), vf_load(y + i)));
+	}
+	for (; i < n; i++) {
+		x[i] *= y[i];
+	}
+}
+
+void dsp_clamp(float *x, float lo, float hi, int n) {
+	const vf_t l = vf_set1(lo);
+	const vf_t h = vf_set1(hi);
+	int i = 0;
+	for (; i + SIMD_WIDTH <= n; i += SIMD_WIDTH) {
+		vf_store(x + i, vf_min(vf_max(vf_load(x + i), l), h));
+	}
+	for (; i < n; i++) {
+		const float v = x[i] > lo ? x[i] : lo;
+		x[i] = v < hi ? v : hi;
+	}
+}
+
+void dsp_mix(float *dst, const float *src, float gain, int n) {
+	const vf_t g = vf_set1(gain);
+	int i = 0;
+	for (; i + SIMD_WIDTH <= n; i += SIMD_WIDTH) {
+		vf_store(dst + i, vf_add(vf_load(dst + i), vf_mul(vf_load(src + i), g)));
+	}
+	for (; i < n; i++) {
+		dst[i] += src[i] * gain;
+	}
+}
+
+void dsp_mix_ramp(float *dst, const float *src, float g0, float g1, int n) {
+	const float step = (g1 - g0) / (float)n;
+	const vf_t vstep = vf_set1(step * SIMD_WIDTH);
+	vf_t g = vf_add(vf_set1(g0), vf_mul(vi_to_vf(vi_ramp(1, 1)), vf_set1(step)));
+	int i = 0;
+	for (; i + SIMD_WIDTH <= n; i += SIMD_WIDTH) {
+		vf_store(dst + i, vf_add(vf_load(dst + i), vf_mul(vf_load(src + i), g)));
+		g = vf_add(g, vstep);
+	}
+	for (; i < n; i++) {
+		dst[i] += src[i] * (g0 + step * (float)(i + 1));
+	}
+}
+
+void dsp_interleave_stereo(float *out, const float *left, const float *right, int num_channels, int n) {
+	int i = 0;
+	if (num_channels == 1) {
+		const vf_t half = vf_set1(0.5f);
+		for (; i + SIMD_WIDTH <= n; i += SIMD_WIDTH) {
+			vf_store(out + i, vf_mul(vf_add(vf_load(left + i), vf_load(right + i)), half));
+		}
+		for (; i < n; i++) {
+			out[i] = 0.5f * (left[i] + right[i]);
+		}
+		return;
+	}
+#if defined(__SSE2__) || defined(_M_X64)
+	if (num_channels == 2) {
+		for (; i + 4 <= n; i += 4) {
+			const __m128 l = _mm_loadu_ps(left + i);
+			const __m128 r = _mm_loadu_ps(right + i);
+			_mm_storeu_ps(out + 2 * i, _mm_unpacklo_ps(l, r));
+			_mm_storeu_ps(out + 2 * i + 4, _mm_unpackhi_ps(l, r));
+		}
+	}
+#elif defined(__wasm_simd128__)
+	if (num_channels == 2) {
+		for (; i + 4 <= n; i += 4) {
+			const v128_t l = wasm_v128_load(left + i);
+			const v128_t r = wasm_v128_load(right + i);
+			wasm_v128_store(out + 2 * i, wasm_i32x4_shuffle(l, r, 0, 4, 1, 5));
+			wasm_v128_store(out + 2 * i + 4, wasm_i32x4_shuffle(l, r, 2, 6, 3, 7));
+		}
+	}
+#endif
+	for (; i < n; i++) {
+		float *frame = out + i * num_channels;
+		frame[0] = left[i];
+		frame[1] = right[i];
+		for (int c = 2; c < num_channels; c++) {
+			frame[c] = 0.0f;
+		}
+	}
+}
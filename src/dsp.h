@@ -0,0 +1,33 @@
+#ifndef TOWER4_DSP_H
+#define TOWER4_DSP_H
+
+// Block DSP kernels, vectorized with simd.h.
+//
+// Kernels on mono blocks work in place and accept any length; 64 to 256
+// samples aligned to DSP_ALIGN keep everything in L1 and avoid split loads.
+// Clamps use min/max instead of branches. The interleave kernel writes
+// num_channels samples per input frame and can't run in place, see below.
+
+#include "simd.h"
+
+#define DSP_ALIGN SIMD_ALIGN
+
+/// Instruction set the kernels were compiled for
+const char *dsp_simd_name(void);
+
+/// x *= gain
+void dsp_gain(float *x, float gain, int n);
+/// x *= y, sample by sample
+void dsp_mul(float *x, const float *y, int n);
+/// x = min(max(x, lo), hi)
+void dsp_clamp(float *x, float lo, float hi, int n);
+/// dst += src * gain
+void dsp_mix(float *dst, const float *src, float gain, int n);
+/// dst += src * gain, gain ramping linearly from g0 towards g1 (reached
+/// after the last sample)
+void dsp_mix_ramp(float *dst, const float *src, float g0, float g1, int n);
+/// Interleaves a stereo pair: averaged for mono devices, silence on any
+/// channel past the second. out must not overlap left or right.
+void dsp_interleave_stereo(float *out, const float *left, const float *right, int num_channels, int n);
+
+#endif
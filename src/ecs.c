@@ -0,0 +1,255 @@
+#include "ecs.h"
+
+#include <string.h>
+
+#include "mem.h"
+
+static const size_t ecs_component_size[ECS_COMPONENT_NUM] = {
+	[ECS_TRANSFORM] = sizeof(ecs_transform_t),
+	[ECS_COLLIDER] = sizeof(ecs_collider_t),
+	[ECS_MESH] = sizeof(ecs_mesh_t),
+	[ECS_EMITTER] = sizeof(ecs_emitter_t),
+};
+
+// Slot of a live entity, -1 for stale or malformed handles
+static int ecs_slot_of(const ecs_world_t *w, ecs_entity_t e) {
+	const uint32_t slot = e.id & ECS_SLOT_MASK;
+	if (e.id == 0 || slot >= (uint32_t)w->max_entities) {
+		return -1;
+	}
+	const uint16_t generation = w->slots[slot].generation;
+	if (generation != (uint16_t)(e.id >> ECS_SLOT_SHIFT) || (generation & 1) == 0) {
+		return -1;
+	}
+	return (int)slot;
+}
+
+static bool ecs_grow(ecs_archetype_t *a, int capacity) {
+	if (capacity <= a->capacity) {
+		return true;
+	}
+
+	ecs_entity_t *entities = mem_alloc(MEM_TAG_GAME, sizeof(ecs_entity_t) * (size_t)capacity);
+	void *columns[ECS_COMPONENT_NUM] = {0};
+	bool ok = entities != NULL;
+	for (int c = 0; c < ECS_COMPONENT_NUM && ok; c++) {
+		if (a->mask & ECS_HAS(c)) {
+			columns[c] = mem_alloc(MEM_TAG_GAME, ecs_component_size[c] * (size_t)capacity);
+			ok = columns[c] != NULL;
+		}
+	}
+	if (!ok) {
+		mem_free(entities);
+		for (int c = 0; c < ECS_COMPONENT_NUM; c++) {
+			mem_free(columns[c]);
+		}
+		return false;
+	}
+
+	if (a->count > 0) {
+		memcpy(entities, a->entities, sizeof(ecs_entity_t) * (size_t)a->count);
+	}
+	mem_free(a->entities);
+	a->entities = entities;
+	for (int c = 0; c < ECS_COMPONENT_NUM; c++) {
+		if (columns[c]) {
+			if (a->count > 0) {
+				memcpy(columns[c], a->columns[c], ecs_component_size[c] * (size_t)a->count);
+			}
+			mem_free(a->columns[c]);
+			a->columns[c] = columns[c];
+		}
+	}
+	a->capacity = capacity;
+	return true;
+}
+
+// Appends a zeroed row, returns its index or -1
+static int ecs_push_row(ecs_archetype_t *a, ecs_entity_t e) {
+	if (a->count == a->capacity && !ecs_grow(a, a->capacity ? a->capacity * 2 : 64)) {
+		return -1;
+	}
+	const int row = a->count++;
+	a->entities[row] = e;
+	for (int c = 0; c < ECS_COMPONENT_NUM; c++) {
+		if (a->columns[c]) {
+			memset((uint8_t*)a->columns[c] + ecs_component_size[c] * (size_t)row, 0, ecs_component_size[c]);
+		}
+	}
+	return row;
+}
+
+// Swap-removes a row and patches the slot of the entity moved into it
+static void ecs_remove_row(ecs_world_t *w, ecs_archetype_t *a, int row) {
+	const int last = --a->count;
+	if (row == last) {
+		return;
+	}
+	const ecs_entity_t moved = a->entities[last];
+	a->entities[row] = moved;
+	for (int c = 0; c < ECS_COMPONENT_NUM; c++) {
+		if (a->columns[c]) {
+			const size_t size = ecs_component_size[c];
+			memcpy((uint8_t*)a->columns[c] + size * (size_t)row, (uint8_t*)a->columns[c] + size * (size_t)last, size);
+		}
+	}
+	w->slots[moved.id & ECS_SLOT_MASK].row = (uint32_t)row;
+}
+
+bool ecs_init(ecs_world_t *w, int max_entities) {
+	memset(w, 0, sizeof(*w));
+	if (max_entities > (int)ECS_MAX_ENTITIES) {
+		max_entities = ECS_MAX_ENTITIES;
+	}
+	w->slots = mem_alloc(MEM_TAG_GAME, sizeof(ecs_slot_t) * (size_t)max_entities);
+	if (!w->slots) {
+		return false;
+	}
+	w->max_entities = max_entities;
+	for (int i = 0; i < max_entities; i++) {
+		w->slots[i] = (ecs_slot_t){ .row = (uint32_t)(i + 1) };
+	}
+	for (uint32_t mask = 0; mask < ECS_ARCHETYPE_NUM; mask++) {
+		w->archetypes[mask].mask = mask;
+	}
+	return true;
+}
+
+void ecs_shutdown(ecs_world_t *w) {
+	for (int i = 0; i < ECS_ARCHETYPE_NUM; i++) {
+		ecs_archetype_t *a = &w->archetypes[i];
+		mem_free(a->entities);
+		for (int c = 0; c < ECS_COMPONENT_NUM; c++) {
+			mem_free(a->columns[c]);
+		}
+	}
+	mem_free(w->slots);
+	memset(w, 0, sizeof(*w));
+}
+
+bool ecs_reserve(ecs_world_t *w, uint32_t mask, int capacity) {
+	return ecs_grow(&w->archetypes[mask & (ECS_ARCHETYPE_NUM - 1)], capacity);
+}
+
+ecs_entity_t ecs_create(ecs_world_t *w, uint32_t mask) {
+	mask &= ECS_ARCHETYPE_NUM - 1;
+	if (w->count >= w->max_entities) {
+		return (ecs_entity_t){0};
+	}
+
+	const uint32_t slot = w->free_head;
+	ecs_slot_t *s = &w->slots[slot];
+	const ecs_entity_t e = { ((uint32_t)(uint16_t)(s->generation + 1) << ECS_SLOT_SHIFT) | slot };
+	const int row = ecs_push_row(&w->archetypes[mask], e);
+	if (row < 0) {
+		return (ecs_entity_t){0};
+	}
+
+	w->free_head = s->row;
+	s->generation++;
+	s->row = (uint32_t)row;
+	s->archetype = (uint8_t)mask;
+	w->count++;
+	return e;
+}
+
+bool ecs_destroy(ecs_world_t *w, ecs_entity_t e) {
+	const int slot = ecs_slot_of(w, e);
+	if (slot < 0) {
+		return false;
+	}
+
+	ecs_slot_t *s = &w->slots[slot];
+	ecs_remove_row(w, &w->archetypes[s->archetype], (int)s->row);
+	// Even generation: all outstanding handles to this slot go stale
+	s->generation++;
+	s->row = w->free_head;
+	w->free_head = (uint32_t)slot;
+	w->count--;
+	return true;
+}
+
+bool ecs_alive(const ecs_world_t *w, ecs_entity_t e) {
+	return ecs_slot_of(w, e) >= 0;
+}
+
+bool ecs_set_components(ecs_world_t *w, ecs_entity_t e, uint32_t mask) {
+	mask &= ECS_ARCHETYPE_NUM - 1;
+	const int slot = ecs_slot_of(w, e);
+	if (slot < 0) {
+		return false;
+	}
+	ecs_slot_t *s = &w->slots[slot];
+	if (s->archetype == mask) {
+		return true;
+	}
+
+	ecs_archetype_t *from = &w->archetypes[s->archetype];
+	ecs_archetype_t *to = &w->archetypes[mask];
+	const int row = ecs_push_row(to, e);
+	if (row < 0) {
+		return false;
+	}
+	for (int c = 0; c < ECS_COMPONENT_NUM; c++) {
+		if (from->columns[c] && to->columns[c]) {
+			const size_t size = ecs_component_size[c];
+			memcpy((uint8_t*)to->columns[c] + size * (size_t)row, (uint8_t*)from->columns[c] + size * s->row, size);
+		}
+	}
+	ecs_remove_row(w, from, (int)s->row);
+	s->row = (uint32_t)row;
+	s->archetype = (uint8_t)mask;
+	return true;
+}
+
+uint32_t ecs_components(const ecs_world_t *w, ecs_entity_t e) {
+	const int slot = ecs_slot_of(w, e);
+	return slot < 0 ? 0 : w->slots[slot].archetype;
+}
+
+void *ecs_get(ecs_world_t *w, ecs_entity_t e, ecs_component_t component) {
+	const int slot = ecs_slot_of(w, e);
+	if (slot < 0) {
+		return NULL;
+	}
+	const ecs_slot_t *s = &w->slots[slot];
+	uint8_t *column = w->archetypes[s->archetype].columns[component];
+	return column ? column + ecs_component_size[component] * s->row : NULL;
+}
+
+ecs_iter_t ecs_query(ecs_world_t *w, uint32_t mask) {
+	return (ecs_iter_t){ .world = w, .mask = mask };
+}
+
+bool ecs_next(ecs_iter_t *it) {
+	while (it->next_archetype < ECS_ARCHETYPE_NUM) {
+		ecs_archetype_t *a = &it->world->archetypes[it->next_archetype++];
+		if ((a->mask & it->mask) != it->mask || a->count == 0) {
+			continue;
+		}
+		it->count = a->count;
+		it->entities = a->entities;
+		it->transform = a->columns[ECS_TRANSFORM];
+		it->collider = a->columns[ECS_COLLIDER];
+		it->mesh = a->columns[ECS_MESH];
+		it->emitter = a->columns[ECS_EMITTER];
+		return true;
+	}
+	return false;
+}
+
+void ecs_update_colliders(ecs_world_t *w) {
+	for (ecs_iter_t it = ecs_query(w, ECS_HAS(ECS_TRANSFORM) | ECS_HAS(ECS_COLLIDER)); ecs_next(&it);) {
+		const ecs_transform_t *transform = it.transform;
+		ecs_collider_t *collider = it.collider;
+		for (int i = 0; i < it.count; i++) {
+			const hmm_vec3 p = transform[i].position;
+			const hmm_vec3 h = HMM_MultiplyVec3f(collider[i].half_extents, transform[i].scale);
+			collider[i].bounds = (aabb_t){
+				.min_x = p.X - h.X, .max_x = p.X + h.X,
+				.min_y = p.Y - h.Y, .max_y = p.Y + h.Y,
+				.min_z = p.Z - h.Z, .max_z = p.Z + h.Z,
+			};
+		}
+	}
+}
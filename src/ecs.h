@@ -0,0 +1,128 @@
+#ifndef TOWER4_ECS_H
+#define TOWER4_ECS_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "HandmadeMath.h"
+#include "aabb.h"
+
+// Minimal archetype ECS.
+//
+// Every combination of components is an archetype with one tightly packed
+// column per component, so a system only streams through the data it asks
+// for. With four components there are at most 16 archetypes and they are
+// indexed directly by their component mask.
+//
+// Entity handles use the same layout as sokol_gfx resource ids: slot index in
+// the low 16 bits, per-slot generation above. Odd generations are alive, so
+// an id of 0 is never valid and stale handles are rejected.
+//
+// Usage:
+//   for (ecs_iter_t it = ecs_query(w, ECS_HAS(ECS_TRANSFORM) | ECS_HAS(ECS_COLLIDER)); ecs_next(&it);) {
+//       for (int i = 0; i < it.count; i++) { it.transform[i] ... it.collider[i] ... }
+//   }
+
+typedef enum ecs_component_t {
+	ECS_TRANSFORM,
+	ECS_COLLIDER,
+	ECS_MESH,
+	ECS_EMITTER,
+	ECS_COMPONENT_NUM,
+} ecs_component_t;
+
+#define ECS_HAS(component) (1u << (component))
+#define ECS_ARCHETYPE_NUM (1 << ECS_COMPONENT_NUM)
+
+#define ECS_SLOT_SHIFT 16
+#define ECS_SLOT_MASK ((1u << ECS_SLOT_SHIFT) - 1)
+#define ECS_MAX_ENTITIES ECS_SLOT_MASK
+
+typedef struct ecs_transform_t {
+	hmm_vec3 position;
+	float scale;
+} ecs_transform_t;
+
+typedef struct ecs_collider_t {
+	hmm_vec3 half_extents; /// before scale
+	aabb_t bounds; /// world space, see ecs_update_colliders()
+} ecs_collider_t;
+
+typedef struct ecs_mesh_t {
+	int base_element;
+	int num_elements;
+} ecs_mesh_t;
+
+typedef struct ecs_emitter_t {
+	float gain;
+	float radius; /// distance at which the emitter is silent
+	uint32_t voice;
+} ecs_emitter_t;
+
+typedef struct ecs_entity_t { uint32_t id; } ecs_entity_t;
+
+typedef struct ecs_archetype_t {
+	uint32_t mask;
+	int count;
+	int capacity;
+	ecs_entity_t *entities;
+	void *columns[ECS_COMPONENT_NUM]; /// NULL for components not in mask
+} ecs_archetype_t;
+
+typedef struct ecs_slot_t {
+	uint32_t row; /// in its archetype while alive, next free slot otherwise
+	uint16_t generation;
+	uint8_t archetype;
+} ecs_slot_t;
+
+typedef struct ecs_world_t {
+	ecs_archetype_t archetypes[ECS_ARCHETYPE_NUM];
+	ecs_slot_t *slots;
+	int max_entities;
+	int count;
+	uint32_t free_head;
+} ecs_world_t;
+
+typedef struct ecs_iter_t {
+	ecs_world_t *world;
+	uint32_t mask;
+	int next_archetype;
+
+	// Columns of the current archetype, only the queried ones are valid
+	int count;
+	const ecs_entity_t *entities;
+	ecs_transform_t *transform;
+	ecs_collider_t *collider;
+	ecs_mesh_t *mesh;
+	ecs_emitter_t *emitter;
+} ecs_iter_t;
+
+/// max_entities is clamped to ECS_MAX_ENTITIES. Returns false when out of memory.
+bool ecs_init(ecs_world_t *w, int max_entities);
+void ecs_shutdown(ecs_world_t *w);
+/// Grows the archetype for mask up front so spawning doesn't allocate later.
+bool ecs_reserve(ecs_world_t *w, uint32_t mask, int capacity);
+
+/// Components start zeroed. Returns id 0 when full or out of memory.
+ecs_entity_t ecs_create(ecs_world_t *w, uint32_t mask);
+bool ecs_destroy(ecs_world_t *w, ecs_entity_t e);
+bool ecs_alive(const ecs_world_t *w, ecs_entity_t e);
+/// Moves the entity to the archetype for mask, keeping shared components.
+bool ecs_set_components(ecs_world_t *w, ecs_entity_t e, uint32_t mask);
+uint32_t ecs_components(const ecs_world_t *w, ecs_entity_t e);
+/// NULL if the entity is stale or lacks the component. Invalidated by any
+/// create/destroy/set_components in the same archetype.
+void *ecs_get(ecs_world_t *w, ecs_entity_t e, ecs_component_t component);
+
+#define ECS_GET_TRANSFORM(w, e) ((ecs_transform_t*)ecs_get((w), (e), ECS_TRANSFORM))
+#define ECS_GET_COLLIDER(w, e) ((ecs_collider_t*)ecs_get((w), (e), ECS_COLLIDER))
+#define ECS_GET_MESH(w, e) ((ecs_mesh_t*)ecs_get((w), (e), ECS_MESH))
+#define ECS_GET_EMITTER(w, e) ((ecs_emitter_t*)ecs_get((w), (e), ECS_EMITTER))
+
+ecs_iter_t ecs_query(ecs_world_t *w, uint32_t mask);
+bool ecs_next(ecs_iter_t *it);
+
+/// System: recomputes collider bounds from transforms.
+void ecs_update_colliders(ecs_world_t *w);
+
+#endif
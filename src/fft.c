@@ -0,0 +1,111 @@
+#include "fft.h"
+
+#include <math.h>
+
+bool fft_init(fft_t *f, int size) {
+	if (size < 4 || size > FFT_MAX_SIZE || (size & (size - 1)) != 0) {
+		return false;
+	}
+	f->size = size;
+	f->half = size / 2;
+	int bits = 0;
+	while ((1 << bits) < f->half) {
+		bits++;
+	}
+	for (int k = 0; k < f->half; k++) {
+		const double angle = -2.0 * M_PI * k / f->half;
+		f->twiddle_re[k] = (float)cos(angle);
+		f->twiddle_im[k] = (float)sin(angle);
+		int reversed = 0;
+		for (int b = 0; b < bits; b++) {
+			reversed |= ((k >> b) & 1) << (bits - 1 - b);
+		}
+		f->bitrev[k] = (uint16_t)reversed;
+	}
+	for (int k = 0; k <= size / 4; k++) {
+		const double angle = -2.0 * M_PI * k / size;
+		f->split_re[k] = (float)cos(angle);
+		f->split_im[k] = (float)sin(angle);
+	}
+	return true;
+}
+
+// In place complex FFT of f->half points already in bit reversed order
+static void fft_complex(const fft_t *f, float *re, float *im) {
+	const int m = f->half;
+	int bits = 0;
+	while ((1 << bits) < m) {
+		bits++;
+	}
+	int h = 1;
+	if ((bits & 1) != 0) {
+		for (int k = 0; k < m; k += 2) {
+			const float ar = re[k], ai = im[k];
+			const float br = re[k + 1], bi = im[k + 1];
+			re[k] = ar + br;
+			im[k] = ai + bi;
+			re[k + 1] = ar - br;
+			im[k + 1] = ai - bi;
+		}
+		h = 2;
+	}
+	// Radix-2 stages h and 2h at once over blocks of 4h
+	for (; h < m; h *= 4) {
+		const int stride = m / (4 * h);
+		for (int j = 0; j < h; j++) {
+			const int t = j * stride;
+			const float w1r = f->twiddle_re[t], w1i = f->twiddle_im[t];
+			const float w2r = f->twiddle_re[2 * t], w2i = f->twiddle_im[2 * t];
+			const float w3r = f->twiddle_re[3 * t], w3i = f->twiddle_im[3 * t];
+			for (int k = j; k < m; k += 4 * h) {
+				const int i1 = k + h, i2 = k + 2 * h, i3 = k + 3 * h;
+				const float b1r = re[i1] * w2r - im[i1] * w2i, b1i = re[i1] * w2i + im[i1] * w2r;
+				const float b2r = re[i2] * w1r - im[i2] * w1i, b2i = re[i2] * w1i + im[i2] * w1r;
+				const float b3r = re[i3] * w3r - im[i3] * w3i, b3i = re[i3] * w3i + im[i3] * w3r;
+				const float a0r = re[k] + b1r, a0i = im[k] + b1i;
+				const float a1r = re[k] - b1r, a1i = im[k] - b1i;
+				const float sr = b2r + b3r, si = b2i + b3i;
+				const float dr = b2r - b3r, di = b2i - b3i;
+				re[k] = a0r + sr;
+				im[k] = a0i + si;
+				re[i2] = a0r - sr;
+				im[i2] = a0i - si;
+				// a1 -/+ i * d
+				re[i1] = a1r + di;
+				im[i1] = a1i - dr;
+				re[i3] = a1r - di;
+				im[i3] = a1i + dr;
+			}
+		}
+	}
+}
+
+void fft_real(const fft_t *f, const float *in, float *re, float *im) {
+	const int m = f->half;
+	for (int n = 0; n < m; n++) {
+		re[f->bitrev[n]] = in[2 * n];
+		im[f->bitrev[n]] = in[2 * n + 1];
+	}
+	fft_complex(f, re, im);
+
+	// Untangle the even (E) and odd (O) samples' spectra:
+	// X[k] = E + W^k O and X[m - k] = conj(E - W^k O)
+	const float zr = re[0], zi = im[0];
+	re[0] = zr + zi;
+	im[0] = 0.0f;
+	re[m] = zr - zi;
+	im[m] = 0.0f;
+	for (int k = 1; k <= m / 2; k++) {
+		const float ar = re[k], ai = im[k];
+		const float br = re[m - k], bi = -im[m - k];
+		const float er = 0.5f * (ar + br), ei = 0.5f * (ai + bi);
+		// O = -i (A - B) / 2
+		const float odr = 0.5f * (ai - bi), odi = -0.5f * (ar - br);
+		const float wr = f->split_re[k], wi = f->split_im[k];
+		const float tr = odr * wr - odi * wi, ti = odr * wi + odi * wr;
+		re[k] = er + tr;
+		im[k] = ei + ti;
+		re[m - k] = er - tr;
+		im[m - k] = -(ei - ti);
+	}
+}
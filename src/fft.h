@@ -0,0 +1,33 @@
+#ifndef TOWER4_FFT_H
+#define TOWER4_FFT_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+// Real FFT for power of two sizes.
+//
+// N real samples are packed into N/2 complex points (even samples real, odd
+// samples imaginary), transformed with radix-4 passes (each doing two
+// radix-2 stages with three complex multiplies per four points, plus one
+// radix-2 pass when log2(N/2) is odd) and split into the N/2+1 bins of the
+// real signal. Twiddles and the bit reversal order are computed once by
+// fft_init(), so a transform does no trigonometry.
+
+#define FFT_MAX_SIZE 4096
+
+typedef struct fft_t {
+	int size; /// real samples
+	int half; /// complex points of the inner transform
+	float twiddle_re[FFT_MAX_SIZE / 2]; /// e^(-2 pi i k / half)
+	float twiddle_im[FFT_MAX_SIZE / 2];
+	float split_re[FFT_MAX_SIZE / 4 + 1]; /// e^(-2 pi i k / size)
+	float split_im[FFT_MAX_SIZE / 4 + 1];
+	uint16_t bitrev[FFT_MAX_SIZE / 2];
+} fft_t;
+
+/// size must be a power of two from 4 to FFT_MAX_SIZE.
+bool fft_init(fft_t *f, int size);
+/// Transforms size samples into size/2+1 bins, re and im hold as many.
+void fft_real(const fft_t *f, const float *in, float *re, float *im);
+
+#endif
@@ -0,0 +1,3 @@
+// HandmadeMath implementation, see CMakeLists.txt for the SSE setting
+#define HANDMADE_MATH_IMPLEMENTATION
+#include "HandmadeMath.h"
@@ -0,0 +1,366 @@
+#include "job.h"
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "mem.h"
+#include "profiler.h"
+#include "thread.h"
+
+#define JOB_DEQUE_MASK (JOB_DEQUE_SIZE - 1)
+#define JOB_SPINS_BEFORE_SLEEP 64
+#define JOB_CACHE_LINE 64
+
+_Static_assert((JOB_DEQUE_SIZE & JOB_DEQUE_MASK) == 0, "JOB_DEQUE_SIZE must be a power of two");
+
+typedef struct job_t {
+	job_desc_t desc;
+	job_counter_t *counter;
+} job_t;
+
+typedef struct job_worker_t {
+	// Chase-Lev deque, top and bottom on separate cache lines
+	_Alignas(JOB_CACHE_LINE) _Atomic int64_t top;
+	_Alignas(JOB_CACHE_LINE) _Atomic int64_t bottom;
+	// Jobs are stored by value. A thief copies its slot before claiming it
+	// with the CAS on top; the owner can only overwrite that slot once top
+	// moved past it, in which case the CAS fails and the copy is discarded.
+	_Alignas(JOB_CACHE_LINE) job_t buffer[JOB_DEQUE_SIZE];
+	uint32_t steal_seed;
+
+	int index;
+	thread_t thread;
+} job_worker_t;
+
+static struct {
+	job_worker_t *workers;
+	void *workers_memory;
+	int num_threads;
+	int num_started;
+	atomic_bool running;
+
+	thread_sema_t wake;
+	atomic_int sleeping;
+
+	// Submissions from threads that aren't job threads
+	thread_mutex_t inject_lock;
+	job_t inject[JOB_DEQUE_SIZE];
+	int inject_head;
+	int inject_count;
+	atomic_int inject_pending;
+} jobs;
+
+static _Thread_local int job_tls_index = -1;
+
+static bool deque_push(job_worker_t *w, const job_t *job) {
+	const int64_t b = atomic_load_explicit(&w->bottom, memory_order_relaxed);
+	const int64_t t = atomic_load_explicit(&w->top, memory_order_acquire);
+	if (b - t >= JOB_DEQUE_SIZE) {
+		return false;
+	}
+	w->buffer[b & JOB_DEQUE_MASK] = *job;
+	atomic_store_explicit(&w->bottom, b + 1, memory_order_release);
+	return true;
+}
+
+static bool deque_pop(job_worker_t *w, job_t *out) {
+	const int64_t b = atomic_load_explicit(&w->bottom, memory_order_relaxed) - 1;
+	atomic_store_explicit(&w->bottom, b, memory_order_relaxed);
+	atomic_thread_fence(memory_order_seq_cst);
+	int64_t t = atomic_load_explicit(&w->top, memory_order_relaxed);
+
+	if (t > b) {
+		// Empty
+		atomic_store_explicit(&w->bottom, b + 1, memory_order_relaxed);
+		return false;
+	}
+
+	*out = w->buffer[b & JOB_DEQUE_MASK];
+	if (t == b) {
+		// Last job, race thieves for it
+		const bool won = atomic_compare_exchange_strong_explicit(&w->top, &t, t + 1,
+				memory_order_seq_cst, memory_order_relaxed);
+		atomic_store_explicit(&w->bottom, b + 1, memory_order_relaxed);
+		return won;
+	}
+	return true;
+}
+
+static bool deque_steal(job_worker_t *w, job_t *out) {
+	int64_t t = atomic_load_explicit(&w->top, memory_order_acquire);
+	atomic_thread_fence(memory_order_seq_cst);
+	const int64_t b = atomic_load_explicit(&w->bottom, memory_order_acquire);
+	if (t >= b) {
+		return false;
+	}
+
+	const job_t copy = w->buffer[t & JOB_DEQUE_MASK];
+	if (!atomic_compare_exchange_strong_explicit(&w->top, &t, t + 1, memory_order_seq_cst, memory_order_relaxed)) {
+		return false;
+	}
+	*out = copy;
+	return true;
+}
+
+static bool inject_push(const job_t *job) {
+	thread_mutex_lock(&jobs.inject_lock);
+	const bool ok = jobs.inject_count < JOB_DEQUE_SIZE;
+	if (ok) {
+		jobs.inject[(jobs.inject_head + jobs.inject_count) & JOB_DEQUE_MASK] = *job;
+		jobs.inject_count++;
+		atomic_fetch_add_explicit(&jobs.inject_pending, 1, memory_order_seq_cst);
+	}
+	thread_mutex_unlock(&jobs.inject_lock);
+	return ok;
+}
+
+static bool inject_pop(job_t *out) {
+	if (atomic_load_explicit(&jobs.inject_pending, memory_order_relaxed) == 0) {
+		return false;
+	}
+	thread_mutex_lock(&jobs.inject_lock);
+	const bool ok = jobs.inject_count > 0;
+	if (ok) {
+		*out = jobs.inject[jobs.inject_head];
+		jobs.inject_head = (jobs.inject_head + 1) & JOB_DEQUE_MASK;
+		jobs.inject_count--;
+		atomic_fetch_sub_explicit(&jobs.inject_pending, 1, memory_order_relaxed);
+	}
+	thread_mutex_unlock(&jobs.inject_lock);
+	return ok;
+}
+
+static bool job_next(int self, job_t *out) {
+	if (self >= 0 && deque_pop(&jobs.workers[self], out)) {
+		return true;
+	}
+	if (inject_pop(out)) {
+		return true;
+	}
+
+	// Start at a pseudo random victim so thieves spread out
+	uint32_t seed = self >= 0 ? jobs.workers[self].steal_seed : (uint32_t)(uintptr_t)out;
+	seed = seed * 1664525u + 1013904223u;
+	if (self >= 0) {
+		jobs.workers[self].steal_seed = seed;
+	}
+	const int n = jobs.num_threads;
+	const int start = (int)((seed >> 16) % (uint32_t)n);
+	for (int i = 0; i < n; i++) {
+		const int victim = (start + i) % n;
+		if (victim != self && deque_steal(&jobs.workers[victim], out)) {
+			return true;
+		}
+	}
+	return false;
+}
+
+static void job_submit(const job_t *job);
+
+// Queues the continuation of a counter whose jobs are all done. The flag
+// keeps job_wait() on the counter from returning, and the counter alive,
+// until the continuation has been read.
+static void job_counter_then(job_counter_t *counter) {
+	const job_t next = { .desc = counter->then, .counter = counter->then_counter };
+	atomic_fetch_sub_explicit(&counter->pending, JOB_THEN_PENDING, memory_order_release);
+	job_submit(&next);
+}
+
+static void job_execute(const job_t *job) {
+	job->desc.fn(job->desc.arg, job->desc.begin, job->desc.end);
+	if (job->counter && atomic_fetch_sub_explicit(&job->counter->pending, 1, memory_order_acq_rel) == JOB_THEN_PENDING + 1) {
+		job_counter_then(job->counter);
+	}
+}
+
+static void job_worker_main(void *arg) {
+	job_worker_t *w = arg;
+	job_tls_index = w->index;
+
+	int spins = 0;
+	while (atomic_load_explicit(&jobs.running, memory_order_acquire)) {
+		job_t job;
+		if (job_next(w->index, &job)) {
+			job_execute(&job);
+			spins = 0;
+			continue;
+		}
+		if (++spins < JOB_SPINS_BEFORE_SLEEP) {
+			thread_yield();
+			continue;
+		}
+
+		// Announce the nap before the last look so a concurrent job_run()
+		// either sees us sleeping or we see its job.
+		atomic_fetch_add_explicit(&jobs.sleeping, 1, memory_order_seq_cst);
+		if (job_next(w->index, &job)) {
+			atomic_fetch_sub_explicit(&jobs.sleeping, 1, memory_order_relaxed);
+			job_execute(&job);
+			spins = 0;
+			continue;
+		}
+		thread_sema_wait(&jobs.wake);
+		atomic_fetch_sub_explicit(&jobs.sleeping, 1, memory_order_relaxed);
+		spins = 0;
+	}
+
+	prof_shutdown();
+}
+
+void job_init(int num_threads) {
+	if (num_threads <= 0) {
+		const char *env = getenv("TOWER4_THREADS");
+		num_threads = env ? atoi(env) : 0;
+	}
+	if (num_threads <= 0) {
+		num_threads = thread_cpu_count();
+	}
+	if (num_threads > JOB_MAX_THREADS) {
+		num_threads = JOB_MAX_THREADS;
+	}
+#if defined(THREAD_NONE)
+	num_threads = 1;
+#endif
+
+	// Workers contain cache line aligned members, mem_alloc() only guarantees 16
+	const size_t size = sizeof(job_worker_t) * (size_t)num_threads + JOB_CACHE_LINE;
+	jobs.workers_memory = mem_alloc(MEM_TAG_GAME, size);
+	jobs.workers = (job_worker_t*)(((uintptr_t)jobs.workers_memory + JOB_CACHE_LINE - 1) & ~(uintptr_t)(JOB_CACHE_LINE - 1));
+	memset(jobs.workers, 0, sizeof(job_worker_t) * (size_t)num_threads);
+
+	thread_sema_init(&jobs.wake, 0);
+	thread_mutex_init(&jobs.inject_lock);
+	atomic_store(&jobs.running, true);
+	// Fixed before any worker runs. Deques of workers that fail to start stay
+	// empty and are harmless to steal from.
+	jobs.num_threads = num_threads;
+	jobs.num_started = 1;
+	job_tls_index = 0;
+
+	for (int i = 0; i < num_threads; i++) {
+		jobs.workers[i].index = i;
+		jobs.workers[i].steal_seed = 0x9e3779b9u * (uint32_t)(i + 1);
+	}
+	for (int i = 1; i < num_threads; i++) {
+		if (!thread_start(&jobs.workers[i].thread, job_worker_main, &jobs.workers[i])) {
+			break;
+		}
+		jobs.num_started = i + 1;
+	}
+}
+
+void job_shutdown(void) {
+	if (!jobs.workers) {
+		return;
+	}
+	atomic_store(&jobs.running, false);
+	thread_sema_post(&jobs.wake, jobs.num_threads);
+	for (int i = 1; i < jobs.num_started; i++) {
+		thread_join(&jobs.workers[i].thread);
+	}
+	thread_sema_destroy(&jobs.wake);
+	thread_mutex_destroy(&jobs.inject_lock);
+	mem_free(jobs.workers_memory);
+	memset(&jobs, 0, sizeof(jobs));
+	job_tls_index = -1;
+}
+
+int job_num_threads(void) {
+	return jobs.num_threads > 0 ? jobs.num_threads : 1;
+}
+
+int job_thread_index(void) {
+	return job_tls_index;
+}
+
+// Queues one job whose counter already accounts for it
+static void job_submit(const job_t *job) {
+	const int self = job_tls_index;
+	bool queued = false;
+	if (jobs.num_threads <= 1) {
+		queued = false;
+	} else if (self >= 0) {
+		queued = deque_push(&jobs.workers[self], job);
+	} else {
+		queued = inject_push(job);
+	}
+	if (!queued) {
+		// No threads or queue full: do it now
+		job_execute(job);
+	}
+}
+
+static void job_wake(int count) {
+	atomic_thread_fence(memory_order_seq_cst);
+	const int sleeping = atomic_load_explicit(&jobs.sleeping, memory_order_relaxed);
+	if (sleeping > 0) {
+		thread_sema_post(&jobs.wake, sleeping < count ? sleeping : count);
+	}
+}
+
+void job_run(const job_desc_t *descs, int count, job_counter_t *counter) {
+	if (counter) {
+		atomic_fetch_add_explicit(&counter->pending, count, memory_order_relaxed);
+	}
+	for (int i = 0; i < count; i++) {
+		job_submit(&(job_t){ .desc = descs[i], .counter = counter });
+	}
+	job_wake(count);
+}
+
+void job_run_after(job_counter_t *counter, const job_desc_t *job, job_counter_t *then_counter) {
+	if (then_counter) {
+		atomic_fetch_add_explicit(&then_counter->pending, 1, memory_order_relaxed);
+	}
+	counter->then = *job;
+	counter->then_counter = then_counter;
+	// Publishes the continuation. With nothing left to wait for it's ours to
+	// queue, otherwise the job taking pending down to the flag queues it.
+	if (atomic_fetch_add_explicit(&counter->pending, JOB_THEN_PENDING, memory_order_acq_rel) == 0) {
+		job_counter_then(counter);
+	}
+	job_wake(1);
+}
+
+void job_wait(job_counter_t *counter) {
+	const int self = job_tls_index;
+	while (atomic_load_explicit(&counter->pending, memory_order_acquire) > 0) {
+		job_t job;
+		if (jobs.num_threads > 1 && job_next(self, &job)) {
+			job_execute(&job);
+		} else {
+			thread_yield();
+		}
+	}
+}
+
+void job_parallel_for(int count, int batch, job_fn fn, void *arg) {
+	if (count <= 0) {
+		return;
+	}
+	const int threads = job_num_threads();
+	if (batch <= 0) {
+		// A few batches per thread evens out uneven work
+		batch = (count + threads * 4 - 1) / (threads * 4);
+	}
+	if (threads == 1 || count <= batch) {
+		fn(arg, 0, count);
+		return;
+	}
+
+	job_counter_t counter = {0};
+	job_desc_t descs[64];
+	int n = 0;
+	for (int begin = 0; begin < count; begin += batch) {
+		const int end = begin + batch < count ? begin + batch : count;
+		descs[n++] = (job_desc_t){ .fn = fn, .arg = arg, .begin = begin, .end = end };
+		if (n == 64) {
+			job_run(descs, n, &counter);
+			n = 0;
+		}
+	}
+	job_run(descs, n, &counter);
+	job_wait(&counter);
+}
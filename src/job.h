@@ -0,0 +1,63 @@
+#ifndef TOWER4_JOB_H
+#define TOWER4_JOB_H
+
+#include <stdatomic.h>
+
+// Work-stealing job system.
+//
+// Every job thread (the thread calling job_init() is thread 0) owns a
+// Chase-Lev deque: it pushes and pops at the bottom, idle threads steal from
+// the top. Threads outside the system (audio, simulation) submit through a
+// small locked queue. Completion is tracked with counters; job_wait() keeps
+// executing other jobs until its counter drops to zero, so waiting inside a
+// job can't deadlock. job_run_after() chains a continuation onto a counter
+// instead of waiting for it, e.g. a merge after the jobs it depends on.
+//
+// TOWER4_THREADS overrides the thread count (including the main thread).
+// Without thread support (web builds) everything runs inline on the caller.
+
+#define JOB_MAX_THREADS 64
+/// Outstanding jobs per thread, power of two. Overflow runs inline.
+#define JOB_DEQUE_SIZE 1024
+
+typedef void (*job_fn)(void *arg, int begin, int end);
+
+typedef struct job_desc_t {
+	job_fn fn;
+	void *arg;
+	int begin;
+	int end;
+} job_desc_t;
+
+typedef struct job_counter_t {
+	atomic_int pending; /// jobs left, plus JOB_THEN_PENDING while a continuation waits
+	// Continuation, see job_run_after()
+	job_desc_t then;
+	struct job_counter_t *then_counter;
+} job_counter_t;
+
+/// Flag in job_counter_t.pending, above any job count
+#define JOB_THEN_PENDING (1 << 30)
+
+/// num_threads <= 0 picks TOWER4_THREADS or the number of cpus.
+void job_init(int num_threads);
+void job_shutdown(void);
+/// Threads executing jobs, including the one that called job_init()
+int job_num_threads(void);
+/// 0..job_num_threads()-1 on job threads, -1 elsewhere
+int job_thread_index(void);
+
+/// Adds count to counter (may be NULL) and queues the jobs.
+void job_run(const job_desc_t *jobs, int count, job_counter_t *counter);
+/// Helps executing jobs until counter reaches zero.
+void job_wait(job_counter_t *counter);
+/// Queues job once counter reaches zero, right away if it already has. One
+/// continuation per counter at a time. then_counter (may be NULL) counts the
+/// continuation from this call on, so waiting on it covers the whole chain;
+/// job_wait(counter) returns once the continuation is queued.
+void job_run_after(job_counter_t *counter, const job_desc_t *job, job_counter_t *then_counter);
+/// Splits [0, count) into batches of about batch items (0 picks a size) and
+/// runs them in parallel, returns when all are done.
+void job_parallel_for(int count, int batch, job_fn fn, void *arg);
+
+#endif
@@ -0,0 +1,211 @@
+#include "level.h"
+
+#include <assert.h>
+#include <stdint.h>
+
+#include "job.h"
+#include "profiler.h"
+
+/// Upper bound for chunks per build, chunks grow beyond it for huge levels
+#define LEVEL_MAX_CHUNKS 256
+/// Props per chunk, enough to amortize the job overhead
+#define LEVEL_MIN_CHUNK_PROPS 16
+
+#define LEVEL_PILLAR_SLICES 10
+#define LEVEL_PILLAR_STACKS 3
+
+static sshape_sizes_t level_prop_sizes(const level_prop_t *prop) {
+	switch (prop->type) {
+	case LEVEL_PROP_FLOOR:
+		return sshape_plane_sizes((uint32_t)(prop->tiles > 0 ? prop->tiles : 1));
+	case LEVEL_PROP_PILLAR: {
+		const sshape_sizes_t slab = sshape_box_sizes(1);
+		const sshape_sizes_t column = sshape_cylinder_sizes(LEVEL_PILLAR_SLICES, LEVEL_PILLAR_STACKS);
+		return (sshape_sizes_t){
+			.vertices = { .num = 2 * slab.vertices.num + column.vertices.num, .size = 2 * slab.vertices.size + column.vertices.size },
+			.indices = { .num = 2 * slab.indices.num + column.indices.num, .size = 2 * slab.indices.size + column.indices.size },
+		};
+	}
+	case LEVEL_PROP_BOX:
+		return sshape_box_sizes(1);
+	}
+	return (sshape_sizes_t){0};
+}
+
+static sshape_buffer_t level_build_pillar(const sshape_buffer_t *in_buf, const hmm_vec3 translation) {
+	const hmm_mat4 box_transform = HMM_Translate(HMM_AddVec3(translation, HMM_Vec3(0.0f, -1.4f, 0.0f)));
+	sshape_buffer_t buf = *in_buf;
+
+	buf = sshape_build_box(&buf, &(sshape_box_t){
+		.merge = true,
+		.width = 1.0f,
+		.height = 0.2f,
+		.depth = 1.0f,
+		.tiles = 1,
+		.transform = sshape_mat4((const float *)box_transform.Elements)
+	});
+
+	const hmm_mat4 cylinder_transform = HMM_Translate(HMM_AddVec3(translation, HMM_Vec3(0.0f, 0.0f, 0.0f)));
+	buf = sshape_build_cylinder(&buf, &(sshape_cylinder_t){
+		.merge = true,
+		.radius = 0.45f,
+		.height = 3.0f,
+		.slices = LEVEL_PILLAR_SLICES,
+		.stacks = LEVEL_PILLAR_STACKS,
+		.transform = sshape_mat4((const float *)cylinder_transform.Elements)
+	});
+
+	const hmm_mat4 box_transform2 = HMM_Translate(HMM_AddVec3(translation, HMM_Vec3(0.0f, 1.4f, 0.0f)));
+	buf = sshape_build_box(&buf, &(sshape_box_t){
+		.merge = true,
+		.width = 1.0f,
+		.height = 0.2f,
+		.depth = 1.0f,
+		.tiles = 1,
+		.transform = sshape_mat4((const float *)box_transform2.Elements)
+	});
+
+	return buf;
+}
+
+static sshape_buffer_t level_build_prop(const sshape_buffer_t *buf, const level_prop_t *prop) {
+	const hmm_mat4 transform = HMM_Translate(prop->position);
+	switch (prop->type) {
+	case LEVEL_PROP_FLOOR:
+		return sshape_build_plane(buf, &(sshape_plane_t){
+			.merge = true,
+			.width = prop->size.X,
+			.depth = prop->size.Z,
+			.tiles = (uint16_t)(prop->tiles > 0 ? prop->tiles : 1),
+			.transform = sshape_mat4((const float *)transform.Elements)
+		});
+	case LEVEL_PROP_PILLAR:
+		return level_build_pillar(buf, prop->position);
+	case LEVEL_PROP_BOX:
+		return sshape_build_box(buf, &(sshape_box_t){
+			.merge = true,
+			.width = prop->size.X,
+			.height = prop->size.Y,
+			.depth = prop->size.Z,
+			.tiles = 1,
+			.transform = sshape_mat4((const float *)transform.Elements)
+		});
+	}
+	sshape_buffer_t invalid = *buf;
+	invalid.valid = false;
+	return invalid;
+}
+
+void level_geometry_size(const level_prop_t *props, int count, size_t *num_vertices, size_t *num_indices) {
+	*num_vertices = 0;
+	*num_indices = 0;
+	for (int i = 0; i < count; i++) {
+		const sshape_sizes_t sizes = level_prop_sizes(&props[i]);
+		*num_vertices += sizes.vertices.num;
+		*num_indices += sizes.indices.num;
+	}
+}
+
+sshape_buffer_t level_build_serial(sshape_buffer_t buf, const level_prop_t *props, int count) {
+	size_t num_vertices = 0;
+	size_t num_indices = 0;
+	level_geometry_size(props, count, &num_vertices, &num_indices);
+	if (buf.vertices.data_size / sizeof(sshape_vertex_t) + num_vertices > LEVEL_MAX_VERTICES) {
+		buf.valid = false;
+		return buf;
+	}
+	for (int i = 0; i < count && (i == 0 || buf.valid); i++) {
+		buf = level_build_prop(&buf, &props[i]);
+	}
+	return buf;
+}
+
+typedef struct level_build_ctx_t {
+	const level_prop_t *props;
+	int count;
+	int chunk_props;
+	sshape_vertex_t *vertices;
+	uint16_t *indices;
+	// Prefix sums, chunk c covers [offset[c], offset[c + 1])
+	size_t vertex_offset[LEVEL_MAX_CHUNKS + 1];
+	size_t index_offset[LEVEL_MAX_CHUNKS + 1];
+	atomic_int failed;
+} level_build_ctx_t;
+
+static void level_build_chunks(void *arg, int begin, int end) {
+	level_build_ctx_t *ctx = arg;
+	for (int c = begin; c < end; c++) {
+		const size_t v0 = ctx->vertex_offset[c];
+		const size_t i0 = ctx->index_offset[c];
+		const size_t num_vertices = ctx->vertex_offset[c + 1] - v0;
+		const size_t num_indices = ctx->index_offset[c + 1] - i0;
+
+		// The chunk's slice of the output acts as its own buffer, so the
+		// shapes produce chunk local indices
+		sshape_buffer_t chunk = {
+			.vertices.buffer = { ctx->vertices + v0, num_vertices * sizeof(sshape_vertex_t) },
+			.indices.buffer = { ctx->indices + i0, num_indices * sizeof(uint16_t) },
+		};
+		const int first = c * ctx->chunk_props;
+		const int last = first + ctx->chunk_props < ctx->count ? first + ctx->chunk_props : ctx->count;
+		chunk = level_build_serial(chunk, &ctx->props[first], last - first);
+		if (!chunk.valid || chunk.vertices.data_size != num_vertices * sizeof(sshape_vertex_t) || chunk.indices.data_size != num_indices * sizeof(uint16_t)) {
+			atomic_store_explicit(&ctx->failed, 1, memory_order_relaxed);
+			continue;
+		}
+
+		// Rebase while the indices are still in cache, level_build() made sure
+		// all of them fit in 16 bits
+		const uint16_t base = (uint16_t)v0;
+		uint16_t *indices = ctx->indices + i0;
+		for (size_t i = 0; i < num_indices; i++) {
+			indices[i] = (uint16_t)(indices[i] + base);
+		}
+	}
+}
+
+sshape_buffer_t level_build(sshape_buffer_t buf, const level_prop_t *props, int count) {
+	PROF_ZONE_BEGIN(level_build_parallel);
+	assert(buf.vertices.data_size == 0 && buf.indices.data_size == 0);
+
+	level_build_ctx_t ctx = {
+		.props = props,
+		.count = count,
+		.vertices = (sshape_vertex_t*)buf.vertices.buffer.ptr,
+		.indices = (uint16_t*)buf.indices.buffer.ptr,
+	};
+	ctx.chunk_props = (count + LEVEL_MAX_CHUNKS - 1) / LEVEL_MAX_CHUNKS;
+	if (ctx.chunk_props < LEVEL_MIN_CHUNK_PROPS) {
+		ctx.chunk_props = LEVEL_MIN_CHUNK_PROPS;
+	}
+	const int num_chunks = (count + ctx.chunk_props - 1) / ctx.chunk_props;
+
+	// Prefix sum over the exact prop sizes
+	for (int c = 0; c < num_chunks; c++) {
+		size_t num_vertices = 0;
+		size_t num_indices = 0;
+		const int first = c * ctx.chunk_props;
+		const int n = first + ctx.chunk_props < count ? ctx.chunk_props : count - first;
+		level_geometry_size(&props[first], n, &num_vertices, &num_indices);
+		ctx.vertex_offset[c + 1] = ctx.vertex_offset[c] + num_vertices;
+		ctx.index_offset[c + 1] = ctx.index_offset[c] + num_indices;
+	}
+
+	const size_t vertex_bytes = ctx.vertex_offset[num_chunks] * sizeof(sshape_vertex_t);
+	const size_t index_bytes = ctx.index_offset[num_chunks] * sizeof(uint16_t);
+	buf.valid = count > 0 && buf.vertices.buffer.ptr && buf.indices.buffer.ptr
+		&& vertex_bytes <= buf.vertices.buffer.size && index_bytes <= buf.indices.buffer.size
+		&& ctx.vertex_offset[num_chunks] <= LEVEL_MAX_VERTICES;
+	if (buf.valid) {
+		job_parallel_for(num_chunks, 1, level_build_chunks, &ctx);
+		buf.valid = atomic_load(&ctx.failed) == 0;
+	}
+	if (buf.valid) {
+		buf.vertices.data_size = vertex_bytes;
+		buf.indices.data_size = index_bytes;
+		buf.vertices.shape_offset = 0;
+		buf.indices.shape_offset = 0;
+	}
+	PROF_ZONE_END(level_build_parallel);
+	return buf;
+}
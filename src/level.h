@@ -0,0 +1,50 @@
+#ifndef TOWER4_LEVEL_H
+#define TOWER4_LEVEL_H
+
+#include <stddef.h>
+
+#include "sokol_gfx.h"
+#include "sokol_shape.h"
+#include "HandmadeMath.h"
+
+// Level geometry.
+//
+// A level is a list of props that are merged into one vertex and index
+// buffer, drawn with a single sg_draw(). Every prop has an exact, known size,
+// so level_build() can compute all vertex and index offsets with a prefix sum
+// up front, build the props on the job system straight into their slice of
+// the output and rebase the chunk's indices in the same job. The result is
+// byte for byte what level_build_serial() produces.
+//
+// sokol_shape only writes 16 bit indices, so levels with more than
+// LEVEL_MAX_VERTICES vertices are rejected with an invalid buffer instead of
+// wrapping. That caps a floor with pillars at about 26x26 tiles, small enough
+// that the parallel build is not expected to scale with core count: `--bench
+// level` measures it, single digit milliseconds either way.
+
+/// Vertices a single level can address with 16 bit indices
+#define LEVEL_MAX_VERTICES 65536
+
+typedef enum level_prop_type_t {
+	LEVEL_PROP_FLOOR, /// plane of size.X by size.Z, `tiles` per side
+	LEVEL_PROP_PILLAR, /// cylinder between two slabs
+	LEVEL_PROP_BOX,
+} level_prop_type_t;
+
+typedef struct level_prop_t {
+	level_prop_type_t type;
+	hmm_vec3 position;
+	hmm_vec3 size; /// floor and box only
+	int tiles; /// floor only, 0 means 1
+} level_prop_t;
+
+/// Exact vertex and index counts of all props together
+void level_geometry_size(const level_prop_t *props, int count, size_t *num_vertices, size_t *num_indices);
+
+/// Reference implementation: builds prop after prop into one buffer.
+sshape_buffer_t level_build_serial(sshape_buffer_t buf, const level_prop_t *props, int count);
+/// Builds the props in parallel chunks into buf, which must be empty and
+/// large enough (see level_geometry_size()). The result is a single shape.
+sshape_buffer_t level_build(sshape_buffer_t buf, const level_prop_t *props, int count);
+
+#endif
@@ -1,6 +1,7 @@
 #include <stdint.h>
 #include <math.h>
 #include <assert.h>
+#include <stdlib.h>
 #include <string.h>
 
 #include "sokol_app.h"
@@ -16,284 +17,226 @@
 #include "sokol_imgui.h"
 #endif
 
-#define HANDMADE_MATH_IMPLEMENTATION
-// TODO: Enable SSE on non WEBGL Builds
-#define HANDMADE_MATH_NO_SSE
 #include "HandmadeMath.h"
 
 #include "shader/shapes.glsl.h"
+#include "profiler.h"
+#include "arena.h"
+#include "mem.h"
+#include "ecs.h"
+#include "job.h"
+#include "sim.h"
+#include "level.h"
+#include "music.h"
+#include "synth.h"
+#include "audio.h"
+#include "sfx_cache.h"
+#include "spectrum.h"
+#ifdef ENABLE_BENCH
+#include "audio_render.h"
+#include "bench.h"
+#endif
 //#include "shader/honeycomb.glsl.h"
 
-typedef struct audio_system {
-	int sample_index;  /// what sample we are playing/time indexx
-
-	float amplitude; /// volume
-	float end_amplitude;
-	float freqfreq;
-	float freq;
-	float mfreq;
-
-	float decay; /// decay for fake reverb
-	
-	float audio_frames[2048*16]; /// buffer for audio data
-	bool is_playing;
-} audio_system;
-
-typedef struct aabb_t {
-	float min_x;
-	float min_y;
-	float min_z;
-
-	float max_x;
-	float max_y;
-	float max_z;
-} aabb_t;
-
-static bool aabb_collides(const aabb_t a, const aabb_t b) {
-	const bool x_collides = (a.min_x <= b.max_x && a.max_x >= b.min_x);
-	const bool y_collides = (a.min_y <= b.max_y && a.max_y >= b.min_y);
-	const bool z_collides = (a.min_z <= b.max_z && a.max_z >= b.min_z);
-	return x_collides && y_collides && z_collides;
-}
-
-typedef struct object_t {
-	hmm_vec3 position;
-	aabb_t aabb;
-
-	// TODO: Mesh data
-} object_t;
-
+// Size of a cache line on every target we ship, also enough for AVX/WASM SIMD loads
+#define CACHE_LINE_SIZE 64
+
+// Main thread -> simulation, published once per frame
+typedef struct sim_input_t {
+	bool forward_down;
+	bool right_down;
+	bool left_down;
+	bool back_down;
+
+	float pitch;
+	float yaw;
+	float movement_speed; /// per tick
+
+	uint32_t teleport_seq; /// bumped when the debug UI moves the camera
+	hmm_vec3 teleport_position;
+} sim_input_t;
+
+#define SNAPSHOT_MAX_OBJECTS 64
+
+// Simulation -> main thread, one per tick. Everything the frame needs to
+// draw, so rendering never touches simulation state.
+typedef struct render_snapshot_t {
+	uint64_t tick;
+	hmm_vec3 camera_position;
+	hmm_mat4 view;
+
+	int num_entities;
+	int num_objects;
+	struct snapshot_object {
+		ecs_entity_t entity;
+		ecs_transform_t transform;
+		aabb_t bounds;
+	} objects[SNAPSHOT_MAX_OBJECTS]; /// colliders, for debugging
+} render_snapshot_t;
+
+#define FRAME_ARENA_SIZE (256 * 1024)
+#define SCRATCH_ARENA_SIZE (1024 * 1024)
+
+static _Alignas(CACHE_LINE_SIZE) uint8_t frame_arena_memory[FRAME_ARENA_SIZE];
+static _Alignas(CACHE_LINE_SIZE) uint8_t scratch_arena_memory[SCRATCH_ARENA_SIZE];
+
+// Game state, grouped per subsystem and ordered by how often it is touched.
+// Every hot block starts on its own cache line so a frame only pulls in the
+// lines it actually uses; setup-only and debug data goes to the end.
 static struct {
-	sg_pipeline pip;
-	sg_bindings bind;
-	sg_pass_action pass_action;
-    sshape_element_range_t elms;
+	// Owned by the simulation thread once it runs
+	_Alignas(CACHE_LINE_SIZE) struct {
+		struct camera {
+			hmm_vec3 position;
+
+			// Points away/opposite from camera direction
+			hmm_vec3 direction;
+			hmm_vec3 right;
+			hmm_vec3 up;
+		} camera;
+		aabb_t aabb;
+		uint32_t teleport_seq; /// last sim_input_t.teleport_seq applied
+		float step_distance; /// walked since the last footstep
+		bool step_left;
+		bool blocked; /// collided last tick
+	} player;
+
+	// Owned by the main thread, written on every input event
+	_Alignas(CACHE_LINE_SIZE) sim_input_t input;
+	float mouse_sensitivity;
+
+	// Entities the level needs to find again
+	_Alignas(CACHE_LINE_SIZE) struct {
+		ecs_entity_t cube;
+	} level;
+
+	// Everything frame() hands to sokol_gfx
+	_Alignas(CACHE_LINE_SIZE) struct {
+		vs_params_t vs_params;
+		fs_params_t fs_params; /// spectrum bands, see spectrum.h
+		uint64_t laptime;
+		sshape_element_range_t elms;
+		sg_pipeline pip;
+		sg_bindings bind;
+		sg_pass_action pass_action;
+	} render;
+
+	// Cold: allocators and debug UI
+	// The frame arena is for lists built and dropped within one frame, such as
+	// culling results and draw queues. The level is still a single merged draw,
+	// so nothing allocates from it yet and the Memory window shows it empty.
+	_Alignas(CACHE_LINE_SIZE) arena_t frame_arena; /// transient data, reset at the end of every frame
+	arena_t scratch_arena; /// load-time work, pop back to a mark when done
 
-	uint64_t laptime;
 	struct {
 		bool show_synth;
+		bool show_profiler;
+		bool show_memory;
 	} ui;
-
-    vs_params_t vs_params;
-
-	struct camera {
-		hmm_vec3 position;
-	
-		// Points away/opposite from camera direction
-		hmm_vec3 direction;
-		hmm_vec3 right;
-		hmm_vec3 up;
-
-		float pitch;
-		float yaw;
-	} camera;
-	aabb_t player_aabb;
-
-	aabb_t aabbs[16];
-	int n_aabbs;
-	audio_system audio;
-
-	struct {
-		bool forward_down;
-		bool right_down;
-		bool left_down;
-		bool back_down;
-	} input;
-
-	float movement_speed;
-	float mouse_sensitivity;
 } state;
 
-static void audio_init(audio_system *sys) {
-	sys->sample_index = 0;
-
-	sys->amplitude = 0.5f;
-	sys->end_amplitude = 0.5f;
-
-	sys->mfreq = 40.0;
-	sys->freq = 30.0;
-	sys->freqfreq = 1.5;
-	sys->decay = 0.7f;
-	sys->is_playing = false;
-}
-
-
-static void audio_play(audio_system *as) {
-	// TODO: Refactor
-	const int num_frames = saudio_expect();
-	static bool scnd_buf = false;
-	if (as->is_playing && num_frames > 0) {
-		const int num_samples = num_frames * saudio_channels();
-		for (int i = 0; i < num_samples; i++) {
-			const float t = (float)as->sample_index / 44100.0f;
-			//audio_frames[i] = amplitude * sin((float)audio_index/44100.0 * freq *  M_PI * 2);
-			as->freq = as->mfreq * sin(t * as->freqfreq);
-			float val = as->amplitude * sin(as->freq * M_PI * 2);
-			if (val >= 0.5) {
-				val = 0.5;
-			}
-			val *= as->end_amplitude;
-			as->audio_frames[scnd_buf ? i+2048 : i] = val;
-			as->sample_index++;
-		}
-
-		// Echo
-		for (int i = 0; i < 2048; i++)
-		{
-			// WARNING: overflow potential
-			if (scnd_buf) {
-				as->audio_frames[i + 2048] += as->audio_frames[i] * as->decay;
-			} else {
-				as->audio_frames[i] += as->audio_frames[i + 2048] * as->decay;
-			}
-		}
-
-		saudio_push(&as->audio_frames[scnd_buf ? 2048 : 0], num_samples);
-		scnd_buf = !scnd_buf;
-	}
-}
-
-static sshape_buffer_t build_pillar(const sshape_buffer_t *in_buf, const hmm_vec3 translation) {
-    const hmm_mat4 box_transform = HMM_Translate(HMM_AddVec3(translation, HMM_Vec3(0.0f, -1.4f, 0.0f)));
-    sshape_buffer_t buf = *in_buf;
-
-	buf = sshape_build_box(&buf, &(sshape_box_t){
-		.merge = true,
-		.width = 1.0f,
-		.height = 0.2f,
-		.depth = 1.0f,
-		.tiles = 1,
-		.transform = sshape_mat4(&box_transform.Elements[0][0])
-	});
-
-    const hmm_mat4 cylinder_transform = HMM_Translate(HMM_AddVec3(translation, HMM_Vec3(0.0f, 0.0f, 0.0f)));
-	buf = sshape_build_cylinder(&buf, &(sshape_cylinder_t){
-		.merge = true,
-        .radius = 0.45f,
-        .height = 3.0f,
-        .slices = 10,
-        .stacks = 3,
-		.transform = sshape_mat4(&cylinder_transform.Elements[0][0])
-	});
-
-    const hmm_mat4 box_transform2 = HMM_Translate(HMM_AddVec3(translation, HMM_Vec3(0.0f, 1.4f, 0.0f)));
-	buf = sshape_build_box(&buf, &(sshape_box_t){
-		.merge = true,
-		.width = 1.0f,
-		.height = 0.2f,
-		.depth = 1.0f,
-		.tiles = 1,
-		.transform = sshape_mat4(&box_transform2.Elements[0][0])
-	});
+// Game objects, see ecs.h. Only the simulation touches them after init.
+static ecs_world_t world;
+
+// Handoff between main and simulation thread, see sim.h
+static sim_buffer_t input_buffer;
+static sim_buffer_t snapshot_buffer;
+static _Alignas(CACHE_LINE_SIZE) sim_input_t input_slots[3];
+static _Alignas(CACHE_LINE_SIZE) render_snapshot_t snapshot_slots[3];
+
+// Shared with the audio thread, see synth.h
+static synth_t synth;
+static tracker_song_t music;
+static audio_t audio;
+static sfx_cache_t sfx_cache;
+static spectrum_t spectrum;
+
+// Sound effects, played through synth.mixer from sfx_cache
+#define SFX_CACHE_BYTES (512 * 1024)
+#define FOOTSTEP_DISTANCE 1.5f
+static const mixer_sound_t sound_footstep = {
+	.wave = OSC_SINE, .freq = 90.0f, .freq_end = 45.0f, .sweep = 0.08f, .noise = 0.6f,
+	.attack = 0.002f, .decay = 0.09f, .gain = 0.4f,
+};
+static const mixer_sound_t sound_bump = {
+	.wave = OSC_TRIANGLE, .freq = 120.0f, .freq_end = 60.0f, .sweep = 0.15f, .noise = 0.2f,
+	.attack = 0.003f, .decay = 0.05f, .sustain = 0.5f, .hold = 0.05f, .release = 0.15f, .gain = 0.5f, .priority = 1,
+};
+static const mixer_sound_t sound_click = {
+	.wave = OSC_SQUARE, .freq = 1800.0f, .attack = 0.0005f, .decay = 0.03f, .gain = 0.15f, .priority = 2,
+};
+// Loops on emitters until stopped
+static const mixer_sound_t sound_hum = {
+	.wave = OSC_SAW, .freq = 55.0f, .noise = 0.05f, .attack = 0.5f, .sustain = 1.0f, .hold = -1.0f, .release = 0.5f,
+	.gain = 0.3f, .priority = 3, .spatial = true,
+};
+static const mixer_sound_t sound_machine = {
+	.wave = OSC_TRIANGLE, .freq = 330.0f, .noise = 0.3f, .attack = 0.5f, .sustain = 1.0f, .hold = -1.0f, .release = 0.5f,
+	.gain = 0.2f, .priority = 3, .spatial = true,
+};
+
+// Fills the scratch arena with the level's geometry and uploads it
+static void upload_level(const level_prop_t *props, int count) {
+	const size_t scratch_mark = arena_mark(&state.scratch_arena);
+	size_t num_vertices = 0;
+	size_t num_indices = 0;
+	level_geometry_size(props, count, &num_vertices, &num_indices);
+	sshape_vertex_t *vertices = ARENA_PUSH_ARRAY(&state.scratch_arena, sshape_vertex_t, num_vertices);
+	uint16_t *indices = ARENA_PUSH_ARRAY(&state.scratch_arena, uint16_t, num_indices);
+	assert(vertices && indices);
+	sshape_buffer_t buf = {
+		.vertices.buffer = { vertices, num_vertices * sizeof(sshape_vertex_t) },
+		.indices.buffer  = { indices, num_indices * sizeof(uint16_t) },
+	};
+	buf = level_build(buf, props, count);
+	assert(buf.valid);
 
-	return buf;
+	// extract element range for sg_draw()
+	state.render.elms = sshape_element_range(&buf);
+	const sg_buffer_desc vbuf_desc = sshape_vertex_buffer_desc(&buf);
+	const sg_buffer_desc ibuf_desc = sshape_index_buffer_desc(&buf);
+	// TODO: somehow return this instead of setting state
+	state.render.bind.vertex_buffers[0] = sg_make_buffer(&vbuf_desc);
+	state.render.bind.index_buffer = sg_make_buffer(&ibuf_desc);
+	arena_pop_to(&state.scratch_arena, scratch_mark);
 }
 
-
 static void build_test_level(void) {
-    // generate merged shape geometries
-    sshape_vertex_t vertices[6 * 1024];
-    uint16_t indices[16 * 1024];
-    sshape_buffer_t buf = {
-        .vertices.buffer = SSHAPE_RANGE(vertices),
-        .indices.buffer  = SSHAPE_RANGE(indices),
-    };
-
-	// Floor
-	const hmm_mat4 floor_transform = HMM_Translate(HMM_Vec3(0, 0, 0));
-	buf = sshape_build_plane(&buf, &(sshape_plane_t){
-		.width = 10.0f,
-		.depth = 10.0f,
-		.transform = sshape_mat4(&floor_transform.Elements[0][0])
-	});
+	PROF_ZONE_BEGIN(level_build);
+	const hmm_vec3 box_size = HMM_Vec3(2.0f, 2.0f, 2.0f);
+	const level_prop_t props[] = {
+		{ .type = LEVEL_PROP_FLOOR, .position = HMM_Vec3(0, 0, 0), .size = HMM_Vec3(10.0f, 0, 10.0f) },
+		{ .type = LEVEL_PROP_BOX, .position = HMM_Vec3(0, 1.0f, 0), .size = box_size },
+	};
+	upload_level(props, (int)(sizeof(props) / sizeof(props[0])));
 
-	const hmm_mat4 box_transform = HMM_Translate(HMM_Vec3(0, 1.0f, 0));
-	sshape_box_t box = {
-		.merge = true,
-		.width = 2.0f,
-		.height = 2.0f,
-		.depth = 2.0f,
-		.tiles = 1,
-		.transform = sshape_mat4(&box_transform.Elements[0][0])
+	state.level.cube = ecs_create(&world, ECS_HAS(ECS_TRANSFORM) | ECS_HAS(ECS_COLLIDER) | ECS_HAS(ECS_EMITTER));
+	*ECS_GET_TRANSFORM(&world, state.level.cube) = (ecs_transform_t){
+		.position = HMM_Vec3(0, 1.0f, 0),
+		.scale = 1.0f,
 	};
-	buf = sshape_build_box(&buf, &box);
-	aabb_t box_aabb = {
-		.min_x = -box.width * 0.5f,
-		.max_x = box.width * 0.5f,
-		.min_y = -box.height * 0.5f,
-		.max_y = box.height * 0.5f,
-		.min_z = -box.depth * 0.5f,
-		.max_z = box.depth * 0.5f,
+	ECS_GET_COLLIDER(&world, state.level.cube)->half_extents = HMM_MultiplyVec3f(box_size, 0.5f);
+	*ECS_GET_EMITTER(&world, state.level.cube) = (ecs_emitter_t){
+		.gain = 1.0f,
+		.radius = 20.0f,
+		.voice = mixer_play(&synth.mixer, &sound_hum),
 	};
-	state.aabbs[0] = box_aabb;
-	state.n_aabbs = 1;
-
-    assert(buf.valid);
-
-    // extract element range for sg_draw()
-    state.elms = sshape_element_range(&buf);
-    const sg_buffer_desc vbuf_desc = sshape_vertex_buffer_desc(&buf);
-    const sg_buffer_desc ibuf_desc = sshape_index_buffer_desc(&buf);
-	// TODO: somehow return this instead of setting state
-    state.bind.vertex_buffers[0] = sg_make_buffer(&vbuf_desc);
-    state.bind.index_buffer = sg_make_buffer(&ibuf_desc);
-}
-
-static void build_level(void) {
-    // generate merged shape geometries
-    sshape_vertex_t vertices[6 * 1024];
-    uint16_t indices[16 * 1024];
-    sshape_buffer_t buf = {
-        .vertices.buffer = SSHAPE_RANGE(vertices),
-        .indices.buffer  = SSHAPE_RANGE(indices),
-    };
-
-	// Floor
-	const hmm_mat4 floor_transform = HMM_Translate(HMM_Vec3(0, -1.5, 4.0));
-	buf = sshape_build_plane(&buf, &(sshape_plane_t){
-		.width = 10.0f,
-		.depth = 10.0f,
-		.transform = sshape_mat4(&floor_transform.Elements[0][0])
-	});
+	ecs_update_colliders(&world);
 
-	// Pillars
-	for (int i = 0; i < 5; i++) {
-		const float dz = i * 2.0f;
-		buf = build_pillar(&buf, HMM_Vec3(2.0f, 0, dz));
-		buf = build_pillar(&buf, HMM_Vec3(-2.0f, 0, dz));
-	}
-
-	const hmm_mat4 door_tf = HMM_Translate(HMM_Vec3(-0.55f, -0.5f, 0.5f));
-	buf = sshape_build_box(&buf, &(sshape_box_t){
-		.merge = true,
-		.width = 1.0f,
-		.height = 2.0f,
-		.depth = 0.1f,
-		.tiles = 1,
-		.transform = sshape_mat4(&door_tf.Elements[0][0])
-	});
-	const hmm_mat4 door2_tf = HMM_Translate(HMM_Vec3(0.55f, -0.5f, 0.5f));
-	buf = sshape_build_box(&buf, &(sshape_box_t){
-		.merge = true,
-		.width = 1.0f,
-		.height = 2.0f,
-		.depth = 0.1f,
-		.tiles = 1,
-		.transform = sshape_mat4(&door2_tf.Elements[0][0])
-	});
-
-    assert(buf.valid);
-
-    // extract element range for sg_draw()
-    state.elms = sshape_element_range(&buf);
-    const sg_buffer_desc vbuf_desc = sshape_vertex_buffer_desc(&buf);
-    const sg_buffer_desc ibuf_desc = sshape_index_buffer_desc(&buf);
-	// TODO: somehow return this instead of setting state
-    state.bind.vertex_buffers[0] = sg_make_buffer(&vbuf_desc);
-    state.bind.index_buffer = sg_make_buffer(&ibuf_desc);
+	// Something to walk around and listen to, off to the side
+	const ecs_entity_t machine = ecs_create(&world, ECS_HAS(ECS_TRANSFORM) | ECS_HAS(ECS_EMITTER));
+	*ECS_GET_TRANSFORM(&world, machine) = (ecs_transform_t){
+		.position = HMM_Vec3(4.0f, 0.5f, -4.0f),
+		.scale = 1.0f,
+	};
+	*ECS_GET_EMITTER(&world, machine) = (ecs_emitter_t){
+		.gain = 1.0f,
+		.radius = 12.0f,
+		.voice = mixer_play(&synth.mixer, &sound_machine),
+	};
+	PROF_ZONE_END(level_build);
 }
 
-
 static aabb_t make_player_aabb(const hmm_vec3 pos) {
 	const float player_width = 1.0;
 	const float player_height = 2.0;
@@ -309,21 +252,149 @@ static aabb_t make_player_aabb(const hmm_vec3 pos) {
 	};
 }
 
-static void camera_update() {
-	const float yaw = HMM_ToRadians(state.camera.yaw);
-	const float pitch = HMM_ToRadians(state.camera.pitch);
+static void camera_update(const sim_input_t *input) {
+	const float yaw = HMM_ToRadians(input->yaw);
+	const float pitch = HMM_ToRadians(input->pitch);
 
 	const hmm_vec3 dir = HMM_Vec3(cos(yaw) * cos(pitch), sin(pitch), sin(yaw) * cos(pitch));
-	state.camera.direction = HMM_NormalizeVec3(dir);
+	state.player.camera.direction = HMM_NormalizeVec3(dir);
+}
+
+// Simulation tick, runs on the simulation thread (or inline on the web)
+static void simulate(void *userdata, double dt) {
+	(void)userdata;
+	(void)dt;
+	const sim_input_t *input = sim_buffer_read(&input_buffer);
+	if (input->teleport_seq != state.player.teleport_seq) {
+		state.player.teleport_seq = input->teleport_seq;
+		state.player.camera.position = input->teleport_position;
+	}
+
+	PROF_ZONE_BEGIN(movement);
+	hmm_vec3 dir = state.player.camera.direction;
+	hmm_vec3 input_vec = {0};
+
+	if (input->forward_down) {
+		input_vec = dir;
+	} else if (input->back_down) {
+		input_vec = HMM_MultiplyVec3f(dir, -1);
+	}
+	if (input->left_down) {
+		input_vec = HMM_MultiplyVec3f(HMM_NormalizeVec3(HMM_Cross(dir, state.player.camera.up)),-1);
+	} else if (input->right_down) {
+		input_vec = HMM_NormalizeVec3(HMM_Cross(dir, state.player.camera.up));
+	}
+
+	hmm_vec3 vel = HMM_MultiplyVec3f(input_vec, input->movement_speed);
+	vel.Y = 0;
+	const hmm_vec3 new_position = HMM_AddVec3(state.player.camera.position, vel);
+
+	state.player.aabb = make_player_aabb(new_position);
+	PROF_ZONE_BEGIN(collision);
+	bool collides = false;
+	for (ecs_iter_t it = ecs_query(&world, ECS_HAS(ECS_COLLIDER)); ecs_next(&it) && !collides;) {
+		for (int i = 0; i < it.count && !collides; i++) {
+			collides = aabb_collides(state.player.aabb, it.collider[i].bounds);
+		}
+	}
+	if (!collides) {
+		// No collision -> Allow movement
+		state.player.camera.position = new_position;
+		state.player.step_distance += HMM_LengthVec3(vel);
+		if (state.player.step_distance > FOOTSTEP_DISTANCE) {
+			state.player.step_distance -= FOOTSTEP_DISTANCE;
+			state.player.step_left = !state.player.step_left;
+			mixer_sound_t step = sound_footstep;
+			step.pan = state.player.step_left ? -0.2f : 0.2f;
+			sfx_cache_play(&sfx_cache, &synth.mixer, &step);
+		}
+	} else if (!state.player.blocked) {
+		sfx_cache_play(&sfx_cache, &synth.mixer, &sound_bump);
+	}
+	state.player.blocked = collides;
+	PROF_ZONE_END(collision);
+
+	camera_update(input);
+	PROF_ZONE_END(movement);
+
+	// The mixer spatializes every emitter against this listener. Emitters
+	// whose voice was stolen drop the dead handle.
+	PROF_ZONE_BEGIN(audio_scene);
+	for (mixer_voice_t lost; (lost = mixer_next_lost(&synth.mixer));) {
+		for (ecs_iter_t it = ecs_query(&world, ECS_HAS(ECS_EMITTER)); ecs_next(&it);) {
+			for (int i = 0; i < it.count; i++) {
+				if (it.emitter[i].voice == lost) {
+					it.emitter[i].voice = 0;
+				}
+			}
+		}
+	}
+	const hmm_vec3 listener_right = HMM_NormalizeVec3(HMM_Cross(state.player.camera.direction, state.player.camera.up));
+	mixer_scene_t *scene = mixer_scene_begin(&synth.mixer, state.player.camera.position, listener_right);
+	for (ecs_iter_t it = ecs_query(&world, ECS_HAS(ECS_TRANSFORM) | ECS_HAS(ECS_EMITTER)); ecs_next(&it);) {
+		for (int i = 0; i < it.count; i++) {
+			if (it.emitter[i].voice) {
+				mixer_scene_add(scene, it.transform[i].position, it.emitter[i].gain, it.emitter[i].radius, it.emitter[i].voice);
+			}
+		}
+	}
+	mixer_scene_publish(&synth.mixer);
+	PROF_ZONE_END(audio_scene);
+
+	render_snapshot_t *snapshot = sim_buffer_back(&snapshot_buffer);
+	snapshot->tick = sim_tick_count();
+	snapshot->camera_position = state.player.camera.position;
+	snapshot->view = HMM_LookAt(state.player.camera.position, HMM_AddVec3(state.player.camera.position, state.player.camera.direction), HMM_Vec3(0.0f, 1.0f, 0.0f));
+	snapshot->num_entities = world.count;
+	snapshot->num_objects = 0;
+	for (ecs_iter_t it = ecs_query(&world, ECS_HAS(ECS_TRANSFORM) | ECS_HAS(ECS_COLLIDER)); ecs_next(&it);) {
+		for (int i = 0; i < it.count && snapshot->num_objects < SNAPSHOT_MAX_OBJECTS; i++) {
+			snapshot->objects[snapshot->num_objects++] = (struct snapshot_object){
+				.entity = it.entities[i],
+				.transform = it.transform[i],
+				.bounds = it.collider[i].bounds,
+			};
+		}
+	}
+	sim_buffer_publish(&snapshot_buffer);
+}
+
+static void publish_input(void) {
+	*(sim_input_t*)sim_buffer_back(&input_buffer) = state.input;
+	sim_buffer_publish(&input_buffer);
 }
 
 static void init(void)
 {
+	mem_init();
 	sg_setup(&(sg_desc){.context = sapp_sgcontext()});
 	stm_setup();
-	saudio_setup(&(saudio_desc){});
+	prof_init(false);
+	job_init(0);
+	arena_init(&state.frame_arena, "frame", frame_arena_memory, sizeof(frame_arena_memory));
+	arena_init(&state.scratch_arena, "scratch", scratch_arena_memory, sizeof(scratch_arena_memory));
+	const char *synth_rate = getenv("TOWER4_SYNTH_RATE");
+	synth_init(&synth, 44100, synth_rate ? atoi(synth_rate) : 0);
+	if (tracker_song_load(&music, music_theme, music_theme_size)) {
+		synth.music = &music;
+		tracker_play(&synth.tracker, &music);
+	}
+	// The analyzer taps the mix, it has to be in place before the stream starts
+	spectrum_init(&spectrum);
+	synth.tap = &spectrum.ring;
+	audio_init(&audio, &(saudio_desc){
+		.sample_rate = synth.device_rate,
+		.stream_userdata_cb = synth_stream_cb,
+		.user_data = &synth,
+	});
+	// Cached PCM plays on the mixer, at the DSP rate
+	sfx_cache_init(&sfx_cache, SFX_CACHE_BYTES, (float)synth_dsp_rate(&synth, saudio_isvalid() ? saudio_sample_rate() : synth.device_rate));
+	sfx_cache_load(&sfx_cache, &sound_footstep);
+	sfx_cache_load(&sfx_cache, &sound_bump);
+	sfx_cache_load(&sfx_cache, &sound_click);
 
 #ifdef ENABLE_IMGUI
+	igSetAllocatorFunctions(mem_imgui_alloc, mem_imgui_free, NULL);
 	simgui_setup(&(simgui_desc_t){0});
 	ImGuiIO *io = igGetIO();
 	io->FontGlobalScale = 2.0f;
@@ -332,11 +403,11 @@ static void init(void)
 	//sg_shader shader = sg_make_shader(shapes_shader_desc(sg_query_backend()));
 	sg_shader shader = sg_make_shader(shapes_shader_desc(sg_query_backend()));
 
-	state.pass_action = (sg_pass_action) {
+	state.render.pass_action = (sg_pass_action) {
 		.colors[0] = { .action = SG_ACTION_CLEAR, .value = {0.0f, 0.0f, 0.0f, 1.0f}}
 	};
 
-	state.pip = sg_make_pipeline(&(sg_pipeline_desc) {
+	state.render.pip = sg_make_pipeline(&(sg_pipeline_desc) {
 		.shader = shader,
 		.layout = {
 			.buffers[0] = sshape_buffer_layout_desc(),
@@ -355,144 +426,165 @@ static void init(void)
         },
 	});
 
+	ecs_init(&world, 4096);
 	build_test_level();
 
-	state.camera.position = (hmm_vec3){ .Z=15.f, .Y=1.5f };
-	state.camera.direction = (hmm_vec3){ .Z=-1.0f };
-	state.camera.right = HMM_NormalizeVec3(HMM_Cross((hmm_vec3){ .Y=1.0f }, state.camera.direction));
-	state.camera.up = HMM_Cross(state.camera.direction, state.camera.right);
+	state.player.camera.position = (hmm_vec3){ .Z=15.f, .Y=1.5f };
+	state.player.camera.direction = (hmm_vec3){ .Z=-1.0f };
+	state.player.camera.right = HMM_NormalizeVec3(HMM_Cross((hmm_vec3){ .Y=1.0f }, state.player.camera.direction));
+	state.player.camera.up = HMM_Cross(state.player.camera.direction, state.player.camera.right);
 
-	state.camera.yaw = -90.0f;
-	state.camera.pitch = 0.0f;
-
-	state.movement_speed = 0.1f;
+	state.input.yaw = -90.0f;
+	state.input.pitch = 0.0f;
+	state.input.movement_speed = 0.1f;
 	state.mouse_sensitivity = 0.1f;
-	camera_update();
-
-	audio_init(&state.audio);
+	camera_update(&state.input);
+
+	// Publish a first snapshot before the thread starts so the first frame
+	// has something to draw
+	sim_buffer_init(&input_buffer, &input_slots[0], &input_slots[1], &input_slots[2]);
+	sim_buffer_init(&snapshot_buffer, &snapshot_slots[0], &snapshot_slots[1], &snapshot_slots[2]);
+	publish_input();
+	simulate(NULL, 0.0);
+	sim_start(&(sim_desc_t){ .tick = simulate, .tick_rate = 60 });
 }
 
 static uint64_t render_duration;
 
 
-#ifdef ENABLE_IMGUI
-static void audio_ui(audio_system* as) {
-		igBegin("Synth", &state.ui.show_synth, ImGuiWindowFlags_None);
-		igCheckbox("Enable", &as->is_playing);
-		igSliderFloat("amplitude", &as->amplitude, 0, 1, "%f", ImGuiSliderFlags_None);
-		igSliderFloat("end_amplitude", &as->end_amplitude, 0, 1, "%f", ImGuiSliderFlags_None);
-		igSliderFloat("freq", &as->freq, 0, 2000, "%f", ImGuiSliderFlags_None);
-		igSliderFloat("mfreq", &as->mfreq, 0, 2000, "%f", ImGuiSliderFlags_None);
-		igSliderFloat("freqfreq", &as->freqfreq, 0, 100, "%f", ImGuiSliderFlags_None);
-		igSliderFloat("decay", &as->decay, 0, 1, "%f", ImGuiSliderFlags_None);
-		// TODO: Propper ringbuffer for plotting the waveforms?
-		// igPlotLinesFloatPtr("buffer", audio_frames, 2048, 0, "", -1.0 , 1.0, (ImVec2){200, 200}, 0);
-		igEnd();
-}
-#endif
-
-
-
 static void frame(void)
 {
+	mem_frame_begin();
+	audio_update(&audio);
+	if (saudio_isvalid()) {
+		// A restarted stream may come back at another rate
+		sfx_cache_set_rate(&sfx_cache, (float)synth_dsp_rate(&synth, saudio_sample_rate()));
+	}
 	uint64_t now = stm_now();
 	const int width = sapp_width();
 	const int height = sapp_height();
-	const double delta_time = stm_sec(stm_round_to_common_refresh_rate(stm_laptime(&state.laptime)));
+	const double delta_time = stm_sec(stm_round_to_common_refresh_rate(stm_laptime(&state.render.laptime)));
+	const render_snapshot_t *snapshot = sim_buffer_read(&snapshot_buffer);
+	spectrum_update(&spectrum, saudio_isvalid() ? saudio_sample_rate() : 0, (float)delta_time);
 
 #ifdef ENABLE_IMGUI
+	PROF_ZONE_BEGIN(ui);
 	// Show UI if enabled
 	simgui_new_frame(width, height, delta_time);
 	if (state.ui.show_synth) {
 		igSetNextWindowPos((ImVec2){10, 10}, ImGuiCond_Once, (ImVec2){0, 0});
 		igSetNextWindowSize((ImVec2){400, 600}, ImGuiCond_Once);
 
-		audio_ui(&state.audio);
+		synth_ui(&synth, &state.ui.show_synth);
+		igSetNextWindowPos((ImVec2){420, 10}, ImGuiCond_Once, (ImVec2){0, 0});
+		audio_ui(&audio, &state.ui.show_synth);
+		igSetNextWindowPos((ImVec2){420, 320}, ImGuiCond_Once, (ImVec2){0, 0});
+		sfx_cache_ui(&sfx_cache, &state.ui.show_synth);
+		igSetNextWindowPos((ImVec2){830, 10}, ImGuiCond_Once, (ImVec2){0, 0});
+		spectrum_ui(&spectrum, &state.ui.show_synth);
+	}
+	if (state.ui.show_profiler) {
+		prof_ui(&state.ui.show_profiler);
+	}
+	if (state.ui.show_memory) {
+		igBegin("Memory", &state.ui.show_memory, ImGuiWindowFlags_None);
+		arena_ui(&state.frame_arena);
+		arena_ui(&state.scratch_arena);
+		igSeparator();
+		mem_ui();
+		igEnd();
 	}
 
 	igBegin("Camera", NULL, ImGuiSliderFlags_None);
-	igDragFloat("Camera X", &state.camera.position.X, 0.01f, -20.0f, 20.0f, "%f", ImGuiSliderFlags_None);
-	igDragFloat("Camera Y", &state.camera.position.Y, 0.01f, -20.0f, 20.0f, "%f", ImGuiSliderFlags_None);
-	igDragFloat("Camera Z", &state.camera.position.Z, 0.01f, -20.0f, 20.0f, "%f", ImGuiSliderFlags_None);
+	// The simulation owns the camera, edits are sent over as a teleport
+	hmm_vec3 camera_position = snapshot->camera_position;
+	bool camera_moved = igDragFloat("Camera X", &camera_position.X, 0.01f, -20.0f, 20.0f, "%f", ImGuiSliderFlags_None);
+	camera_moved |= igDragFloat("Camera Y", &camera_position.Y, 0.01f, -20.0f, 20.0f, "%f", ImGuiSliderFlags_None);
+	camera_moved |= igDragFloat("Camera Z", &camera_position.Z, 0.01f, -20.0f, 20.0f, "%f", ImGuiSliderFlags_None);
+	if (camera_moved) {
+		state.input.teleport_position = camera_position;
+		state.input.teleport_seq++;
+	}
 	igValueFloat("Rendering: ", (float)stm_ms(render_duration), "%.2f ms");
+	igValueInt("Job threads", job_num_threads());
+	igText("Simulation: %s, tick %llu", sim_threaded() ? "thread" : "inline", (unsigned long long)snapshot->tick);
 
-	igDragFloat("Speed", &state.movement_speed, 0.001f, 0.0f, 10.0f, "%f", ImGuiSliderFlags_None);
+	igDragFloat("Speed", &state.input.movement_speed, 0.001f, 0.0f, 10.0f, "%f", ImGuiSliderFlags_None);
 	igDragFloat("Sensitivity", &state.mouse_sensitivity, 0.001f, 0.0f, 1.0f, "%f", ImGuiSliderFlags_None);
-	igValueFloat("Pitch: ", state.camera.pitch, "%.2f °");
-	igValueFloat("YAW: ", state.camera.yaw, "%.2f °");
-
-	igText("Cube");
+	igValueFloat("Pitch: ", state.input.pitch, "%.2f °");
+	igValueFloat("YAW: ", state.input.yaw, "%.2f °");
 
-	igValueFloat("min_x", state.aabbs[0].min_x, "%.2f");
-	igValueFloat("max_x", state.aabbs[0].max_x, "%.2f");
-	igValueFloat("min_y", state.aabbs[0].min_y, "%.2f");
-	igValueFloat("max_y", state.aabbs[0].max_y, "%.2f");
-	igValueFloat("min_z", state.aabbs[0].min_z, "%.2f");
-	igValueFloat("max_z", state.aabbs[0].max_z, "%.2f");
+	igValueInt("Entities", snapshot->num_entities);
+	for (int i = 0; i < snapshot->num_objects; i++) {
+		if (snapshot->objects[i].entity.id != state.level.cube.id) {
+			continue;
+		}
+		const aabb_t bounds = snapshot->objects[i].bounds;
+		igText("Cube");
+
+		igValueFloat("min_x", bounds.min_x, "%.2f");
+		igValueFloat("max_x", bounds.max_x, "%.2f");
+		igValueFloat("min_y", bounds.min_y, "%.2f");
+		igValueFloat("max_y", bounds.max_y, "%.2f");
+		igValueFloat("min_z", bounds.min_z, "%.2f");
+		igValueFloat("max_z", bounds.max_z, "%.2f");
+	}
 
 	igEnd();
+	PROF_ZONE_END(ui);
 #endif
 
-	hmm_vec3 dir = state.camera.direction;
-	hmm_vec3 input_vec = {0};
-
-	if (state.input.forward_down) {
-		input_vec = dir;
-	} else if (state.input.back_down) {
-		input_vec = HMM_MultiplyVec3f(dir, -1);
-	}
-	if (state.input.left_down) {
-		input_vec = HMM_MultiplyVec3f(HMM_NormalizeVec3(HMM_Cross(dir, state.camera.up)),-1);
-	} else if (state.input.right_down) {
-		input_vec = HMM_NormalizeVec3(HMM_Cross(dir, state.camera.up));
-	}
-
-	hmm_vec3 vel = HMM_MultiplyVec3f(input_vec, state.movement_speed);
-	vel.Y = 0;
-	const hmm_vec3 new_position = HMM_AddVec3(state.camera.position, vel);
-
-	state.player_aabb = make_player_aabb(new_position);
-	// TODO: Check with every aabb in level
-	if (!aabb_collides(state.player_aabb, state.aabbs[0])) {
-		// No collision -> Allow movement
-		state.camera.position = new_position;
-	}
 
-	camera_update();
+	publish_input();
+	sim_update(delta_time);
 
-	audio_play(&state.audio);
-
-	sg_begin_default_pass(&state.pass_action, width, height);
-	sg_apply_pipeline(state.pip);
-	sg_apply_bindings(&state.bind);
+	PROF_ZONE_BEGIN(render);
+	sg_begin_default_pass(&state.render.pass_action, width, height);
+	sg_apply_pipeline(state.render.pip);
+	sg_apply_bindings(&state.render.bind);
+	snapshot = sim_buffer_read(&snapshot_buffer);
 
 	// Render shapes
     // build model-view-projection matrix
     hmm_mat4 proj = HMM_Perspective(60.0f, sapp_widthf()/sapp_heightf(), 0.01f, 1000.0f);
 
-    hmm_mat4 view = HMM_LookAt(state.camera.position, HMM_AddVec3(state.camera.position, state.camera.direction), HMM_Vec3(0.0f, 1.0f, 0.0f));
-    hmm_mat4 view_proj = HMM_MultiplyMat4(proj, view);
+    hmm_mat4 view_proj = HMM_MultiplyMat4(proj, snapshot->view);
     hmm_mat4 model = HMM_Translate(HMM_Vec3(0.0, 0.0, 0.0));
     
-	state.vs_params.mvp = HMM_MultiplyMat4(view_proj, model);
-
-	sg_apply_uniforms(SG_SHADERSTAGE_VS, SLOT_vs_params, &SG_RANGE(state.vs_params));
-	sg_draw(state.elms.base_element, state.elms.num_elements, 1);
+	state.render.vs_params.mvp = HMM_MultiplyMat4(view_proj, model);
+
+	sg_apply_uniforms(SG_SHADERSTAGE_VS, SLOT_vs_params, &SG_RANGE(state.render.vs_params));
+	// Bass brightens the shapes, treble tints them blue
+	const float *bands = spectrum.bands;
+	state.render.fs_params.bands_low = HMM_Vec4(bands[0], bands[1], bands[2], bands[3]);
+	state.render.fs_params.bands_high = HMM_Vec4(bands[4], bands[5], bands[6], bands[7]);
+	sg_apply_uniforms(SG_SHADERSTAGE_FS, SLOT_fs_params, &SG_RANGE(state.render.fs_params));
+	sg_draw(state.render.elms.base_element, state.render.elms.num_elements, 1);
 #ifdef ENABLE_IMGUI
 	simgui_render();
 #endif
 	sg_end_pass();
 	sg_commit();
+	PROF_ZONE_END(render);
 	render_duration = stm_since(now);
+	prof_frame_end();
+	arena_reset(&state.frame_arena);
+	mem_frame_end();
 }
 
 static void cleanup(void)
 {
-	saudio_shutdown();
+	audio_shutdown(&audio);
 #ifdef ENABLE_IMGUI
 	simgui_shutdown();
 #endif
 	sg_shutdown();
+	sim_stop();
+	sfx_cache_shutdown(&sfx_cache);
+	spectrum_shutdown(&spectrum);
+	ecs_shutdown(&world);
+	job_shutdown();
+	prof_shutdown();
 }
 
 #define TOGGLE(property) do { property = !property; } while(0)
@@ -518,13 +610,13 @@ static void event(const sapp_event *ev)
 				const float dx = ev->mouse_dx * state.mouse_sensitivity;
 				const float dy = ev->mouse_dy * state.mouse_sensitivity;
 
-				state.camera.yaw += dx;
-				state.camera.pitch -= dy;
+				state.input.yaw += dx;
+				state.input.pitch -= dy;
 
-				if(state.camera.pitch > 89.0f)
-					state.camera.pitch = 89.0f;
-				if(state.camera.pitch < -89.0f)
-					state.camera.pitch = -89.0f;
+				if(state.input.pitch > 89.0f)
+					state.input.pitch = 89.0f;
+				if(state.input.pitch < -89.0f)
+					state.input.pitch = -89.0f;
 			}
 			break;
 
@@ -544,6 +636,15 @@ static void event(const sapp_event *ev)
 				break;
 			case SAPP_KEYCODE_F1:
 				TOGGLE(state.ui.show_synth);
+				sfx_cache_play(&sfx_cache, &synth.mixer, &sound_click);
+				break;
+			case SAPP_KEYCODE_F2:
+				TOGGLE(state.ui.show_profiler);
+				sfx_cache_play(&sfx_cache, &synth.mixer, &sound_click);
+				break;
+			case SAPP_KEYCODE_F3:
+				TOGGLE(state.ui.show_memory);
+				sfx_cache_play(&sfx_cache, &synth.mixer, &sound_click);
 				break;
 			case SAPP_KEYCODE_F11:
 				sapp_toggle_fullscreen();
@@ -593,8 +694,17 @@ static void event(const sapp_event *ev)
 
 sapp_desc sokol_main(int argc, char *argv[])
 {
+#ifdef ENABLE_BENCH
+	if (argc > 1 && strcmp(argv[1], "--bench") == 0) {
+		exit(bench_main(argc - 2, argv + 2));
+	}
+	if (argc > 1 && strcmp(argv[1], "--render-audio") == 0) {
+		exit(audio_render_main(argc - 2, argv + 2));
+	}
+#else
 	(void)argc;
 	(void)argv;
+#endif
 	return (sapp_desc){
 	    .init_cb = init,
 	    .frame_cb = frame,
@@ -0,0 +1,234 @@
+#include "mem.h"
+
+#include <stdatomic.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifdef ENABLE_IMGUI
+#define CIMGUI_DEFINE_ENUMS_AND_STRUCTS
+#include "cimgui.h"
+#endif
+
+#if defined(__GLIBC__)
+#define MEM_BACKTRACE
+#include <execinfo.h>
+#include <unistd.h>
+#endif
+
+#define MEM_MAGIC 0x7031a11cu
+
+// Prepended to every allocation, 16 bytes to keep malloc's alignment
+typedef struct mem_header_t {
+	uint64_t size;
+	uint32_t tag;
+	uint32_t magic;
+} mem_header_t;
+
+typedef struct mem_tag_counters_t {
+	_Atomic size_t live_bytes;
+	_Atomic size_t peak_bytes;
+	_Atomic uint64_t allocs;
+	_Atomic uint64_t frees;
+} mem_tag_counters_t;
+
+static struct {
+	mem_tag_counters_t tags[MEM_TAG_NUM];
+
+	_Atomic int guard;
+	_Atomic uint64_t frame_index;
+	_Atomic uint64_t frame_allocs;
+	uint64_t last_frame_allocs;
+	_Atomic uint64_t violations;
+} mem;
+
+static _Thread_local bool mem_reporting;
+/// Only ever set on the thread running frame(), allocations of the audio,
+/// simulation and job threads don't count towards the frame
+static _Thread_local bool mem_in_frame;
+
+static const char *mem_tag_names[MEM_TAG_NUM] = {
+	[MEM_TAG_GAME] = "game",
+	[MEM_TAG_SOKOL_APP] = "sokol_app",
+	[MEM_TAG_SOKOL_GFX] = "sokol_gfx",
+	[MEM_TAG_SOKOL_AUDIO] = "sokol_audio",
+	[MEM_TAG_SOKOL_IMGUI] = "sokol_imgui",
+	[MEM_TAG_IMGUI] = "imgui",
+	[MEM_TAG_SFX_CACHE] = "sfx_cache",
+};
+
+static void mem_report_violation(mem_tag_t tag, size_t size) {
+	// backtrace() and stdio may allocate themselves, don't recurse into the report
+	if (mem_reporting) {
+		return;
+	}
+	mem_reporting = true;
+
+	atomic_fetch_add_explicit(&mem.violations, 1, memory_order_relaxed);
+	fprintf(stderr, "tower4: %zu byte allocation (%s) in frame %llu\n", size, mem_tag_names[tag],
+			(unsigned long long)atomic_load_explicit(&mem.frame_index, memory_order_relaxed));
+#ifdef MEM_BACKTRACE
+	void *frames[32];
+	const int num_frames = backtrace(frames, 32);
+	backtrace_symbols_fd(frames, num_frames, STDERR_FILENO);
+#endif
+
+	if (atomic_load_explicit(&mem.guard, memory_order_relaxed) == MEM_GUARD_ABORT) {
+		abort();
+	}
+	mem_reporting = false;
+}
+
+static void mem_track_alloc(mem_tag_t tag, size_t size) {
+	mem_tag_counters_t *c = &mem.tags[tag];
+	const size_t live = atomic_fetch_add_explicit(&c->live_bytes, size, memory_order_relaxed) + size;
+	size_t peak = atomic_load_explicit(&c->peak_bytes, memory_order_relaxed);
+	while (live > peak && !atomic_compare_exchange_weak_explicit(&c->peak_bytes, &peak, live,
+				memory_order_relaxed, memory_order_relaxed)) {
+	}
+	atomic_fetch_add_explicit(&c->allocs, 1, memory_order_relaxed);
+
+	if (mem_in_frame) {
+		atomic_fetch_add_explicit(&mem.frame_allocs, 1, memory_order_relaxed);
+		if (atomic_load_explicit(&mem.frame_index, memory_order_relaxed) > MEM_WARMUP_FRAMES
+				&& atomic_load_explicit(&mem.guard, memory_order_relaxed) != MEM_GUARD_OFF) {
+			mem_report_violation(tag, size);
+		}
+	}
+}
+
+void *mem_alloc(mem_tag_t tag, size_t size) {
+	mem_header_t *header = malloc(sizeof(mem_header_t) + size);
+	if (!header) {
+		return NULL;
+	}
+	header->size = size;
+	header->tag = tag;
+	header->magic = MEM_MAGIC;
+	mem_track_alloc(tag, size);
+	return header + 1;
+}
+
+void *mem_calloc(mem_tag_t tag, size_t num, size_t size) {
+	if (size && num > (SIZE_MAX - sizeof(mem_header_t)) / size) {
+		return NULL;
+	}
+	void *ptr = mem_alloc(tag, num * size);
+	if (ptr) {
+		memset(ptr, 0, num * size);
+	}
+	return ptr;
+}
+
+void mem_free(void *ptr) {
+	if (!ptr) {
+		return;
+	}
+	mem_header_t *header = (mem_header_t*)ptr - 1;
+	if (header->magic != MEM_MAGIC || header->tag >= MEM_TAG_NUM) {
+		fprintf(stderr, "tower4: mem_free() of a pointer not from mem_alloc()\n");
+		abort();
+	}
+	header->magic = 0;
+
+	mem_tag_counters_t *c = &mem.tags[header->tag];
+	atomic_fetch_sub_explicit(&c->live_bytes, (size_t)header->size, memory_order_relaxed);
+	atomic_fetch_add_explicit(&c->frees, 1, memory_order_relaxed);
+	free(header);
+}
+
+void mem_init(void) {
+	const char *env = getenv("TOWER4_NO_MALLOC");
+	if (!env) {
+		return;
+	}
+	if (strcmp(env, "abort") == 0) {
+		mem_set_guard(MEM_GUARD_ABORT);
+	} else if (env[0] != '\0' && strcmp(env, "0") != 0) {
+		mem_set_guard(MEM_GUARD_LOG);
+	}
+}
+
+void mem_set_guard(mem_guard_t guard) {
+	atomic_store_explicit(&mem.guard, (int)guard, memory_order_relaxed);
+}
+
+mem_guard_t mem_guard(void) {
+	return (mem_guard_t)atomic_load_explicit(&mem.guard, memory_order_relaxed);
+}
+
+void mem_frame_begin(void) {
+	atomic_fetch_add_explicit(&mem.frame_index, 1, memory_order_relaxed);
+	mem_in_frame = true;
+}
+
+void mem_frame_end(void) {
+	mem_in_frame = false;
+	mem.last_frame_allocs = atomic_exchange_explicit(&mem.frame_allocs, 0, memory_order_relaxed);
+}
+
+mem_stats_t mem_tag_stats(mem_tag_t tag) {
+	const mem_tag_counters_t *c = &mem.tags[tag];
+	return (mem_stats_t){
+		.live_bytes = atomic_load_explicit(&c->live_bytes, memory_order_relaxed),
+		.peak_bytes = atomic_load_explicit(&c->peak_bytes, memory_order_relaxed),
+		.allocs = atomic_load_explicit(&c->allocs, memory_order_relaxed),
+		.frees = atomic_load_explicit(&c->frees, memory_order_relaxed),
+	};
+}
+
+const char *mem_tag_name(mem_tag_t tag) {
+	return tag < MEM_TAG_NUM ? mem_tag_names[tag] : "?";
+}
+
+uint64_t mem_last_frame_allocs(void) {
+	return mem.last_frame_allocs;
+}
+
+uint64_t mem_violations(void) {
+	return atomic_load_explicit(&mem.violations, memory_order_relaxed);
+}
+
+void *mem_imgui_alloc(size_t size, void *user_data) {
+	(void)user_data;
+	return mem_alloc(MEM_TAG_IMGUI, size);
+}
+
+void mem_imgui_free(void *ptr, void *user_data) {
+	(void)user_data;
+	mem_free(ptr);
+}
+
+#ifdef ENABLE_IMGUI
+void mem_ui(void) {
+	static const char *guard_names[] = { "off", "log", "abort" };
+	int guard = (int)mem_guard();
+	if (igComboStr_arr("No-malloc guard", &guard, guard_names, 3, -1)) {
+		mem_set_guard((mem_guard_t)guard);
+	}
+	igText("Allocations last frame: %llu", (unsigned long long)mem_last_frame_allocs());
+	if (mem_violations()) {
+		igTextColored((ImVec4){1, 0.3f, 0.3f, 1}, "%llu allocations after warmup",
+				(unsigned long long)mem_violations());
+	}
+
+	if (igBeginTable("heap", 5, ImGuiTableFlags_RowBg | ImGuiTableFlags_Borders, (ImVec2){0, 0}, 0)) {
+		igTableSetupColumn("tag", ImGuiTableColumnFlags_None, 0, 0);
+		igTableSetupColumn("live KB", ImGuiTableColumnFlags_None, 0, 0);
+		igTableSetupColumn("peak KB", ImGuiTableColumnFlags_None, 0, 0);
+		igTableSetupColumn("allocs", ImGuiTableColumnFlags_None, 0, 0);
+		igTableSetupColumn("frees", ImGuiTableColumnFlags_None, 0, 0);
+		igTableHeadersRow();
+		for (int i = 0; i < MEM_TAG_NUM; i++) {
+			const mem_stats_t s = mem_tag_stats((mem_tag_t)i);
+			igTableNextRow(ImGuiTableRowFlags_None, 0);
+			igTableNextColumn(); igText("%s", mem_tag_names[i]);
+			igTableNextColumn(); igText("%.1f", (double)s.live_bytes / 1024.0);
+			igTableNextColumn(); igText("%.1f", (double)s.peak_bytes / 1024.0);
+			igTableNextColumn(); igText("%llu", (unsigned long long)s.allocs);
+			igTableNextColumn(); igText("%llu", (unsigned long long)s.frees);
+		}
+		igEndTable();
+	}
+}
+#endif
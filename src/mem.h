@@ -0,0 +1,69 @@
+#ifndef TOWER4_MEM_H
+#define TOWER4_MEM_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// Instrumented heap allocator.
+//
+// Every heap allocation of the game, sokol (see deps/sokol/sokol.c) and
+// Dear ImGui goes through here, tagged by subsystem. The guard mode reports
+// allocations that happen inside frame() once the warmup frames are over.
+
+typedef enum mem_tag_t {
+	MEM_TAG_GAME,
+	MEM_TAG_SOKOL_APP,
+	MEM_TAG_SOKOL_GFX,
+	MEM_TAG_SOKOL_AUDIO,
+	MEM_TAG_SOKOL_IMGUI,
+	MEM_TAG_IMGUI,
+	MEM_TAG_SFX_CACHE,
+	MEM_TAG_NUM,
+} mem_tag_t;
+
+typedef enum mem_guard_t {
+	MEM_GUARD_OFF,
+	MEM_GUARD_LOG, /// print the allocation with a backtrace
+	MEM_GUARD_ABORT, /// same as log, then abort()
+} mem_guard_t;
+
+/// Frames after which allocations inside frame() count as violations
+#define MEM_WARMUP_FRAMES 120
+
+typedef struct mem_stats_t {
+	size_t live_bytes;
+	size_t peak_bytes;
+	uint64_t allocs;
+	uint64_t frees;
+} mem_stats_t;
+
+void *mem_alloc(mem_tag_t tag, size_t size);
+void *mem_calloc(mem_tag_t tag, size_t num, size_t size);
+void mem_free(void *ptr);
+
+/// Reads the guard mode from TOWER4_NO_MALLOC ("log" or "abort").
+void mem_init(void);
+void mem_set_guard(mem_guard_t guard);
+mem_guard_t mem_guard(void);
+
+/// Brackets frame() on the main thread, allocations the calling thread makes
+/// in between count towards the frame.
+void mem_frame_begin(void);
+void mem_frame_end(void);
+
+mem_stats_t mem_tag_stats(mem_tag_t tag);
+const char *mem_tag_name(mem_tag_t tag);
+uint64_t mem_last_frame_allocs(void);
+uint64_t mem_violations(void);
+
+/// Allocator callbacks for igSetAllocatorFunctions()
+void *mem_imgui_alloc(size_t size, void *user_data);
+void mem_imgui_free(void *ptr, void *user_data);
+
+#ifdef ENABLE_IMGUI
+/// Draws the per-tag table into the current window.
+void mem_ui(void);
+#endif
+
+#endif
@@ -0,0 +1,549 @@
+#include "mixer.h"
+
+#include <math.h>
+#include <string.h>
+
+#ifdef ENABLE_IMGUI
+#define CIMGUI_DEFINE_ENUMS_AND_STRUCTS
+#include "cimgui.h"
+#endif
+
+#include "dsp.h"
+#include "profiler.h"
+
+void mixer_init(mixer_t *m) {
+	memset(m, 0, sizeof(*m));
+	osc_tables_init();
+	mpsc_init(&m->queue, m->queue_memory, MIXER_QUEUE, sizeof(mixer_cmd_t));
+	mpsc_init(&m->lost, m->lost_memory, MIXER_LOST, sizeof(mixer_voice_t));
+	atomic_init(&m->next_id, 1);
+	m->bus_gain = 1.0f;
+	m->ui_bus_gain = 1.0f;
+	sim_buffer_init(&m->scene_buffer, &m->scene_slots[0], &m->scene_slots[1], &m->scene_slots[2]);
+}
+
+static mixer_voice_t mixer_next_id(mixer_t *m) {
+	mixer_voice_t id = atomic_fetch_add_explicit(&m->next_id, 1, memory_order_relaxed);
+	if (id == 0) {
+		id = atomic_fetch_add_explicit(&m->next_id, 1, memory_order_relaxed);
+	}
+	return id;
+}
+
+static void mixer_release_samples(atomic_int *users) {
+	if (users) {
+		atomic_fetch_sub_explicit(users, 1, memory_order_release);
+	}
+}
+
+mixer_voice_t mixer_play(mixer_t *m, const mixer_sound_t *sound) {
+	const mixer_voice_t id = mixer_next_id(m);
+	if (!mpsc_push(&m->queue, &(mixer_cmd_t){.type = MIXER_CMD_PLAY, .voice = id, .sound = *sound})) {
+		mixer_release_samples(sound->users);
+		return 0;
+	}
+	return id;
+}
+
+void mixer_stop(mixer_t *m, mixer_voice_t voice) {
+	mpsc_push(&m->queue, &(mixer_cmd_t){.type = MIXER_CMD_STOP, .voice = voice});
+}
+
+void mixer_set(mixer_t *m, mixer_voice_t voice, float gain, float pan) {
+	mpsc_push(&m->queue, &(mixer_cmd_t){.type = MIXER_CMD_SET, .voice = voice, .gain = gain, .pan = pan});
+}
+
+void mixer_set_bus_gain(mixer_t *m, float gain) {
+	mpsc_push(&m->queue, &(mixer_cmd_t){.type = MIXER_CMD_BUS_GAIN, .gain = gain});
+}
+
+mixer_voice_t mixer_next_lost(mixer_t *m) {
+	mixer_voice_t voice = 0;
+	return mpsc_pop(&m->lost, &voice) ? voice : 0;
+}
+
+mixer_scene_t *mixer_scene_begin(mixer_t *m, hmm_vec3 listener_position, hmm_vec3 listener_right) {
+	mixer_scene_t *scene = sim_buffer_back(&m->scene_buffer);
+	scene->listener_position = listener_position;
+	scene->listener_right = listener_right;
+	scene->count = 0;
+	return scene;
+}
+
+bool mixer_scene_add(mixer_scene_t *scene, hmm_vec3 position, float gain, float radius, mixer_voice_t voice) {
+	if (scene->count == MIXER_EMITTERS) {
+		return false;
+	}
+	const int i = scene->count++;
+	scene->x[i] = position.X;
+	scene->y[i] = position.Y;
+	scene->z[i] = position.Z;
+	scene->gain[i] = gain;
+	scene->radius[i] = radius;
+	scene->voice[i] = voice;
+	return true;
+}
+
+void mixer_scene_publish(mixer_t *m) {
+	sim_buffer_publish(&m->scene_buffer);
+}
+
+// Equal power
+static void mixer_pan(mixer_voice_state_t *v, float pan) {
+	pan = pan < -1.0f ? -1.0f : pan > 1.0f ? 1.0f : pan;
+	const float angle = (pan + 1.0f) * (float)M_PI * 0.25f;
+	v->pan_left = cosf(angle);
+	v->pan_right = sinf(angle);
+}
+
+static mixer_voice_state_t *mixer_find(mixer_t *m, mixer_voice_t id) {
+	for (int i = 0; i < MIXER_VOICES; i++) {
+		if (m->voices[i].id == id && m->voices[i].stage != MIXER_STAGE_OFF) {
+			return &m->voices[i];
+		}
+	}
+	return NULL;
+}
+
+// Whether a is a better voice to give up than b
+static bool mixer_steal_before(const mixer_voice_state_t *a, const mixer_voice_state_t *b) {
+	if (a->priority != b->priority) {
+		return a->priority < b->priority;
+	}
+	const bool a_releasing = a->stage == MIXER_STAGE_RELEASE;
+	const bool b_releasing = b->stage == MIXER_STAGE_RELEASE;
+	if (a_releasing != b_releasing) {
+		return a_releasing;
+	}
+	return a->level * a->gain < b->level * b->gain;
+}
+
+static mixer_voice_state_t *mixer_allocate(mixer_t *m, int priority) {
+	mixer_voice_state_t *victim = NULL;
+	for (int i = 0; i < MIXER_VOICES; i++) {
+		mixer_voice_state_t *v = &m->voices[i];
+		if (v->stage == MIXER_STAGE_OFF) {
+			return v;
+		}
+		if (!victim || mixer_steal_before(v, victim)) {
+			victim = v;
+		}
+	}
+	if (victim->priority > priority) {
+		atomic_fetch_add_explicit(&m->rejected, 1, memory_order_relaxed);
+		return NULL;
+	}
+	atomic_fetch_add_explicit(&m->stolen, 1, memory_order_relaxed);
+	return victim;
+}
+
+static float mixer_rate(float amount, float seconds, float sample_rate) {
+	return seconds > 0.0f ? amount / (seconds * sample_rate) : 1.0f;
+}
+
+static void mixer_voice_init(mixer_voice_state_t *v, mixer_voice_t id, const mixer_sound_t *s, float sample_rate) {
+	const float sustain = s->sustain < 0.0f ? 0.0f : s->sustain > 1.0f ? 1.0f : s->sustain;
+	*v = (mixer_voice_state_t){
+		.id = id,
+		.stage = MIXER_STAGE_ATTACK,
+		.priority = s->priority,
+		.freq = s->freq,
+		.noise = s->noise,
+		.noise_state = id * 2654435761u | 1,
+		.attack_rate = mixer_rate(1.0f, s->attack, sample_rate),
+		.decay_rate = mixer_rate(1.0f - sustain, s->decay, sample_rate),
+		.sustain = sustain,
+		.hold_left = s->hold < 0.0f ? -1 : (int)(s->hold * sample_rate),
+		.release_time = s->release * sample_rate > 1.0f ? s->release * sample_rate : 1.0f,
+		.gain = s->gain,
+		.release_in = -1,
+		.spatial = s->spatial,
+	};
+	if (s->freq_end > 0.0f && s->freq > 0.0f && s->sweep > 0.0f) {
+		v->sweep_rate = log2f(s->freq_end / s->freq) / (s->sweep * sample_rate);
+		v->sweep_step = exp2f(v->sweep_rate * MIXER_CONTROL);
+		v->sweep_left = (int)(s->sweep * sample_rate);
+	}
+	if (s->samples) {
+		// The envelope is in the samples
+		v->samples = s->samples;
+		v->num_samples = s->num_samples;
+		v->users = s->users;
+		v->stage = MIXER_STAGE_SUSTAIN;
+		v->level = 1.0f;
+		v->sustain = 1.0f;
+		v->hold_left = -1;
+		v->noise = 0.0f;
+		v->sweep_left = 0;
+	}
+	mixer_pan(v, s->pan);
+	if (v->samples) {
+		// Already faded in
+		v->left = v->gain * v->pan_left;
+		v->right = v->gain * v->pan_right;
+	}
+	osc_init(&v->osc, s->wave, OSC_LINEAR);
+	osc_set_freq(&v->osc, v->freq, sample_rate);
+}
+
+static mixer_voice_state_t *mixer_start(mixer_t *m, const mixer_cmd_t *cmd, float sample_rate) {
+	mixer_voice_state_t *v = mixer_allocate(m, cmd->sound.priority);
+	if (!v) {
+		mixer_release_samples(cmd->sound.users);
+		return NULL;
+	}
+	// A stolen voice lets go of its samples and its handle
+	if (v->stage != MIXER_STAGE_OFF) {
+		mpsc_push(&m->lost, &v->id);
+	}
+	mixer_release_samples(v->users);
+	mixer_voice_init(v, cmd->voice, &cmd->sound, sample_rate);
+	return v;
+}
+
+static void mixer_release(mixer_voice_state_t *v) {
+	if (v->stage != MIXER_STAGE_RELEASE) {
+		v->stage = MIXER_STAGE_RELEASE;
+		v->release_rate = v->level / v->release_time;
+	}
+}
+
+// Moves the voices' per sample rates over to a new sample rate
+static void mixer_follow_rate(mixer_t *m, float sample_rate) {
+	if (m->sample_rate == sample_rate) {
+		return;
+	}
+	const float scale = m->sample_rate > 0.0f ? sample_rate / m->sample_rate : 1.0f;
+	m->sample_rate = sample_rate;
+	for (int i = 0; i < MIXER_VOICES; i++) {
+		mixer_voice_state_t *v = &m->voices[i];
+		if (v->stage == MIXER_STAGE_OFF || scale == 1.0f) {
+			continue;
+		}
+		v->attack_rate /= scale;
+		v->decay_rate /= scale;
+		v->release_rate /= scale;
+		v->release_time *= scale;
+		if (v->hold_left > 0) {
+			v->hold_left = (int)((float)v->hold_left * scale);
+		}
+		if (v->sweep_left > 0) {
+			v->sweep_rate /= scale;
+			v->sweep_step = exp2f(v->sweep_rate * MIXER_CONTROL);
+			v->sweep_left = (int)((float)v->sweep_left * scale);
+		}
+		osc_set_freq(&v->osc, v->freq, sample_rate);
+	}
+}
+
+mixer_voice_t mixer_trigger(mixer_t *m, const mixer_sound_t *sound, int offset, float sample_rate) {
+	mixer_follow_rate(m, sample_rate);
+	const mixer_voice_t id = mixer_next_id(m);
+	mixer_voice_state_t *v = mixer_start(m, &(mixer_cmd_t){.type = MIXER_CMD_PLAY, .voice = id, .sound = *sound}, sample_rate);
+	if (!v) {
+		return 0;
+	}
+	v->delay = offset;
+	return id;
+}
+
+void mixer_release_at(mixer_t *m, mixer_voice_t voice, int offset) {
+	mixer_voice_state_t *v = mixer_find(m, voice);
+	if (v) {
+		v->release_in = offset;
+	}
+}
+
+static void mixer_apply(mixer_t *m, const mixer_cmd_t *cmd, float sample_rate) {
+	mixer_voice_state_t *v;
+	switch (cmd->type) {
+	case MIXER_CMD_PLAY:
+		if (!mixer_start(m, cmd, sample_rate)) {
+			// mixer_play() already handed out the handle
+			mpsc_push(&m->lost, &cmd->voice);
+		}
+		break;
+	case MIXER_CMD_STOP:
+		if ((v = mixer_find(m, cmd->voice))) {
+			mixer_release(v);
+		}
+		break;
+	case MIXER_CMD_SET:
+		if ((v = mixer_find(m, cmd->voice))) {
+			v->gain = cmd->gain;
+			mixer_pan(v, cmd->pan);
+		}
+		break;
+	case MIXER_CMD_BUS_GAIN:
+		m->bus_gain = cmd->gain;
+		break;
+	}
+}
+
+// Left/right gain and air absorption of every emitter in the scene, a few
+// lanes at a time. Lanes past count compute garbage that is never read.
+static int mixer_spatialize(const mixer_scene_t *scene, float *left, float *right, float *air) {
+	const vf_t lx = vf_set1(scene->listener_position.X);
+	const vf_t ly = vf_set1(scene->listener_position.Y);
+	const vf_t lz = vf_set1(scene->listener_position.Z);
+	const vf_t rx = vf_set1(scene->listener_right.X);
+	const vf_t ry = vf_set1(scene->listener_right.Y);
+	const vf_t rz = vf_set1(scene->listener_right.Z);
+	const vf_t zero = vf_set1(0.0f);
+	const vf_t one = vf_set1(1.0f);
+	const vf_t half = vf_set1(0.5f);
+	const vf_t reference = vf_set1(MIXER_REFERENCE_DISTANCE);
+	const vf_t air_per_unit = vf_set1(MIXER_AIR_PER_UNIT);
+	const vf_t air_max = vf_set1(MIXER_AIR_MAX);
+	const vf_t tiny = vf_set1(1e-6f);
+	int audible = 0;
+	for (int i = 0; i < scene->count; i += SIMD_WIDTH) {
+		const vf_t dx = vf_sub(vf_load(scene->x + i), lx);
+		const vf_t dy = vf_sub(vf_load(scene->y + i), ly);
+		const vf_t dz = vf_sub(vf_load(scene->z + i), lz);
+		const vf_t distance = vf_sqrt(vf_add(vf_add(vf_mul(dx, dx), vf_mul(dy, dy)), vf_mul(dz, dz)));
+
+		// Inverse distance past the reference, faded out linearly towards
+		// the radius so far emitters end up exactly silent
+		const vf_t rolloff = vf_div(reference, vf_max(distance, reference));
+		const vf_t fade = vf_max(zero, vf_sub(one, vf_div(distance, vf_max(vf_load(scene->radius + i), tiny))));
+		const vf_t gain = vf_mul(vf_mul(rolloff, fade), vf_load(scene->gain + i));
+
+		// Sideways component of the direction, -1 left to 1 right. Equal power
+		// as sqrt((1 -+ side) / 2) needs no trigonometry.
+		const vf_t side = vf_div(vf_add(vf_add(vf_mul(dx, rx), vf_mul(dy, ry)), vf_mul(dz, rz)), vf_max(distance, tiny));
+		const vf_t l = vf_sqrt(vf_max(zero, vf_mul(vf_sub(one, side), half)));
+		const vf_t r = vf_sqrt(vf_max(zero, vf_mul(vf_add(one, side), half)));
+		vf_store(left + i, vf_mul(gain, l));
+		vf_store(right + i, vf_mul(gain, r));
+		vf_store(air + i, vf_min(vf_mul(distance, air_per_unit), air_max));
+	}
+	for (int i = 0; i < scene->count; i++) {
+		audible += left[i] + right[i] > 0.0f;
+	}
+	return audible;
+}
+
+static int mixer_find_emitter(const mixer_scene_t *scene, const mixer_voice_state_t *v) {
+	if (v->emitter < scene->count && scene->voice[v->emitter] == v->id) {
+		return v->emitter;
+	}
+	for (int i = 0; i < scene->count; i++) {
+		if (scene->voice[i] == v->id) {
+			return i;
+		}
+	}
+	return -1;
+}
+
+// Advances the envelope by n samples
+static void mixer_envelope(mixer_voice_state_t *v, int n) {
+	switch (v->stage) {
+	case MIXER_STAGE_ATTACK:
+		v->level += v->attack_rate * (float)n;
+		if (v->level >= 1.0f) {
+			v->level = 1.0f;
+			v->stage = MIXER_STAGE_DECAY;
+		}
+		break;
+	case MIXER_STAGE_DECAY:
+		v->level -= v->decay_rate * (float)n;
+		if (v->level <= v->sustain) {
+			v->level = v->sustain;
+			v->stage = MIXER_STAGE_SUSTAIN;
+		}
+		break;
+	case MIXER_STAGE_SUSTAIN:
+		if (v->level <= 0.0f) {
+			v->stage = MIXER_STAGE_OFF;
+		} else if (v->hold_left >= 0 && (v->hold_left -= n) <= 0) {
+			mixer_release(v);
+		}
+		break;
+	case MIXER_STAGE_RELEASE:
+		v->level -= v->release_rate * (float)n;
+		if (v->level <= 0.0f) {
+			v->level = 0.0f;
+			v->stage = MIXER_STAGE_OFF;
+		}
+		break;
+	case MIXER_STAGE_OFF:
+		break;
+	}
+}
+
+static void mixer_voice_render(mixer_voice_state_t *v, float *left, float *right, int n, float bus_gain, float sample_rate) {
+	_Alignas(DSP_ALIGN) float wave[MIXER_CONTROL];
+	int done = 0;
+	if (v->delay > 0) {
+		done = v->delay < n ? v->delay : n;
+		v->delay -= done;
+		if (v->release_in > 0) {
+			v->release_in = v->release_in > done ? v->release_in - done : 0;
+		}
+	}
+	while (done < n && v->stage != MIXER_STAGE_OFF) {
+		// Control periods end early on a scheduled release
+		if (v->release_in == 0) {
+			mixer_release(v);
+			v->release_in = -1;
+		}
+		int k = n - done < MIXER_CONTROL ? n - done : MIXER_CONTROL;
+		if (v->release_in > 0 && v->release_in < k) {
+			k = v->release_in;
+		}
+		if (v->release_in > 0) {
+			v->release_in -= k;
+		}
+		if (v->samples) {
+			const int left_over = v->num_samples - v->position;
+			const int count = k < left_over ? k : left_over;
+			memcpy(wave, v->samples + v->position, sizeof(float) * (size_t)count);
+			memset(wave + count, 0, sizeof(float) * (size_t)(k - count));
+			v->position += count;
+		} else if (v->noise < 1.0f) {
+			osc_process(&v->osc, wave, k);
+		}
+		if (v->noise > 0.0f) {
+			const float tone = 1.0f - v->noise;
+			for (int i = 0; i < k; i++) {
+				uint32_t x = v->noise_state;
+				x ^= x << 13;
+				x ^= x >> 17;
+				x ^= x << 5;
+				v->noise_state = x;
+				const float white = (float)(int32_t)x * (1.0f / 2147483648.0f);
+				wave[i] = (tone > 0.0f ? wave[i] * tone : 0.0f) + white * v->noise;
+			}
+		}
+		if (v->air > 0.0f) {
+			// One pole lowpass, duller with distance
+			const float a = v->air;
+			float y = v->air_state;
+			for (int i = 0; i < k; i++) {
+				y = wave[i] + (y - wave[i]) * a;
+				wave[i] = y;
+			}
+			v->air_state = y;
+		}
+
+		mixer_envelope(v, k);
+		const float gain = v->level * v->gain * bus_gain;
+		const float l = gain * v->pan_left;
+		const float r = gain * v->pan_right;
+		dsp_mix_ramp(left + done, wave, v->left, l, k);
+		dsp_mix_ramp(right + done, wave, v->right, r, k);
+		v->left = l;
+		v->right = r;
+		if (v->samples && v->position == v->num_samples) {
+			v->stage = MIXER_STAGE_OFF;
+		}
+
+		if (v->sweep_left > 0) {
+			v->freq *= k == MIXER_CONTROL ? v->sweep_step : exp2f(v->sweep_rate * (float)k);
+			v->sweep_left -= k;
+			osc_set_freq(&v->osc, v->freq, sample_rate);
+		}
+		done += k;
+	}
+}
+
+int mixer_sound_frames(const mixer_sound_t *sound, float sample_rate) {
+	if (sound->samples) {
+		return sound->num_samples;
+	}
+	const float sustain = sound->sustain < 0.0f ? 0.0f : sound->sustain > 1.0f ? 1.0f : sound->sustain;
+	if (sound->hold < 0.0f && sustain > 0.0f) {
+		return -1;
+	}
+	float seconds = sound->attack + sound->decay;
+	if (sustain > 0.0f) {
+		seconds += sound->hold + sound->release;
+	}
+	// The envelope moves on every MIXER_CONTROL samples, give it a few
+	return (int)ceilf(seconds * sample_rate) + 4 * MIXER_CONTROL;
+}
+
+int mixer_render_sound(const mixer_sound_t *sound, uint32_t seed, float *out, int max_frames, float sample_rate) {
+	mixer_voice_state_t v;
+	mixer_voice_init(&v, seed, sound, sample_rate);
+	v.pan_left = 1.0f;
+	v.pan_right = 0.0f;
+	v.gain = 1.0f;
+	v.spatial = false;
+	_Alignas(DSP_ALIGN) float unused[MIXER_CONTROL] = {0};
+	int done = 0;
+	while (done < max_frames && v.stage != MIXER_STAGE_OFF) {
+		const int k = max_frames - done < MIXER_CONTROL ? max_frames - done : MIXER_CONTROL;
+		memset(out + done, 0, sizeof(float) * (size_t)k);
+		mixer_voice_render(&v, out + done, unused, k, 1.0f, sample_rate);
+		done += k;
+	}
+	return done;
+}
+
+void mixer_render(mixer_t *m, float *left, float *right, int n, float sample_rate) {
+	PROF_ZONE_BEGIN(mixer);
+	mixer_follow_rate(m, sample_rate);
+	mixer_cmd_t cmd;
+	for (int c = 0; c < MIXER_COMMANDS_PER_BLOCK && mpsc_pop(&m->queue, &cmd); c++) {
+		mixer_apply(m, &cmd, sample_rate);
+	}
+
+	// Spatial voices take pan and gain from their emitter; one without an
+	// emitter in the scene stays silent until it shows up
+	const mixer_scene_t *scene = sim_buffer_read(&m->scene_buffer);
+	bool spatial = false;
+	for (int i = 0; i < MIXER_VOICES && !spatial; i++) {
+		spatial = m->voices[i].stage != MIXER_STAGE_OFF && m->voices[i].spatial;
+	}
+	if (spatial) {
+		_Alignas(DSP_ALIGN) float emitter_left[MIXER_EMITTERS];
+		_Alignas(DSP_ALIGN) float emitter_right[MIXER_EMITTERS];
+		_Alignas(DSP_ALIGN) float emitter_air[MIXER_EMITTERS];
+		PROF_ZONE_BEGIN(spatialize);
+		const int audible = mixer_spatialize(scene, emitter_left, emitter_right, emitter_air);
+		PROF_ZONE_END(spatialize);
+		atomic_store_explicit(&m->audible_emitters, audible, memory_order_relaxed);
+		for (int i = 0; i < MIXER_VOICES; i++) {
+			mixer_voice_state_t *v = &m->voices[i];
+			if (v->stage == MIXER_STAGE_OFF || !v->spatial) {
+				continue;
+			}
+			const int e = mixer_find_emitter(scene, v);
+			v->emitter = e < 0 ? 0 : e;
+			v->pan_left = e < 0 ? 0.0f : emitter_left[e];
+			v->pan_right = e < 0 ? 0.0f : emitter_right[e];
+			v->air = e < 0 ? 0.0f : emitter_air[e];
+		}
+	}
+
+	int active = 0;
+	for (int i = 0; i < MIXER_VOICES; i++) {
+		mixer_voice_state_t *v = &m->voices[i];
+		if (v->stage != MIXER_STAGE_OFF) {
+			mixer_voice_render(v, left, right, n, m->bus_gain, sample_rate);
+			active++;
+			if (v->stage == MIXER_STAGE_OFF) {
+				mixer_release_samples(v->users);
+				v->users = NULL;
+			}
+		}
+	}
+	atomic_store_explicit(&m->active, active, memory_order_relaxed);
+	PROF_ZONE_END(mixer);
+}
+
+#ifdef ENABLE_IMGUI
+void mixer_ui(mixer_t *m) {
+	if (igSliderFloat("sfx bus", &m->ui_bus_gain, 0, 2, "%f", ImGuiSliderFlags_None)) {
+		mixer_set_bus_gain(m, m->ui_bus_gain);
+	}
+	igText("Voices: %d / %d, audible emitters: %d", atomic_load_explicit(&m->active, memory_order_relaxed), MIXER_VOICES,
+		atomic_load_explicit(&m->audible_emitters, memory_order_relaxed));
+	igText("Stolen: %u, outranked: %u, dropped commands: %u",
+		(unsigned)atomic_load_explicit(&m->stolen, memory_order_relaxed),
+		(unsigned)atomic_load_explicit(&m->rejected, memory_order_relaxed),
+		(unsigned)atomic_load_explicit(&m->queue.dropped, memory_order_relaxed));
+}
+#endif
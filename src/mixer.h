@@ -0,0 +1,233 @@
+#ifndef TOWER4_MIXER_H
+#define TOWER4_MIXER_H
+
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "HandmadeMath.h"
+#include "dsp.h"
+#include "mpsc.h"
+#include "osc.h"
+#include "sim.h"
+
+// Polyphonic sound effect voices, mixed on the audio thread.
+//
+// Any thread triggers sounds with mixer_play() and friends, which only push a
+// command into a bounded lock-free queue (see mpsc.h) and never wait. The
+// audio thread applies at most MIXER_COMMANDS_PER_BLOCK commands per block
+// and renders at most MIXER_VOICES voices, so the cost of a block has a hard
+// upper bound. Everything lives inside mixer_t, nothing is allocated after
+// mixer_init().
+//
+// When every voice is busy a new sound steals the least important one:
+// lower priority first, then voices already releasing, then the quietest.
+// A sound with lower priority than every playing voice is dropped. Handles
+// of stolen and dropped sounds are reported back through mixer_next_lost(),
+// so whoever keeps a looping sound's handle can forget it.
+//
+// Envelopes, pitch sweeps and gain/pan changes are evaluated every
+// MIXER_CONTROL samples and ramped linearly in between. Code running on the
+// audio thread (the music sequencer, see tracker.h) can also start and
+// release voices at an exact sample of the next block.
+//
+// Voices count time in samples. When the rate passed to mixer_render() or
+// mixer_trigger() changes (a new device, the synth's internal rate), playing
+// voices are rescaled to keep their pitch and envelope timing; pre-rendered
+// samples can't follow and finish at the old rate.
+//
+// Spatial sounds follow an emitter in the world. The simulation publishes
+// the listener and every emitter once per tick as a mixer_scene_t; once per
+// block the audio thread computes distance attenuation, equal power panning
+// and air absorption for all emitters in one SIMD pass over the scene's
+// columns, and each spatial voice picks up the result of its emitter.
+
+#define MIXER_VOICES 32
+/// Pending commands, power of two
+#define MIXER_QUEUE 256
+#define MIXER_COMMANDS_PER_BLOCK 64
+/// Lost handles waiting for mixer_next_lost(), power of two
+#define MIXER_LOST 64
+/// Samples between envelope and parameter updates
+#define MIXER_CONTROL 32
+/// Emitters per scene, multiple of SIMD_WIDTH
+#define MIXER_EMITTERS 256
+/// Distance up to which emitters play at full volume
+#define MIXER_REFERENCE_DISTANCE 1.0f
+/// Air absorption lowpass coefficient per unit of distance, and its limit
+#define MIXER_AIR_PER_UNIT 0.02f
+#define MIXER_AIR_MAX 0.9f
+
+/// Handle of a playing sound, 0 is never used
+typedef uint32_t mixer_voice_t;
+
+typedef struct mixer_sound_t {
+	osc_wave_t wave;
+	float freq; /// Hz
+	float freq_end; /// swept to exponentially over `sweep` seconds, 0 keeps freq
+	float sweep;
+	float noise; /// 0 pure tone to 1 white noise
+	float attack; /// seconds
+	float decay;
+	float sustain; /// level
+	float hold; /// seconds at sustain before releasing, negative waits for mixer_stop()
+	float release;
+	float gain;
+	float pan; /// -1 left to 1 right
+	int priority; /// higher steals lower
+	bool spatial; /// pan and distance come from the emitter playing this voice
+
+	// Pre-rendered patch (see sfx_cache.h), played at gain and pan instead of
+	// synthesizing. users is decremented once the voice stops reading it.
+	const float *samples;
+	int num_samples;
+	atomic_int *users;
+} mixer_sound_t;
+
+/// Simulation -> audio thread, see mixer_scene_begin()
+typedef struct mixer_scene_t {
+	hmm_vec3 listener_position;
+	hmm_vec3 listener_right; /// unit length
+	int count;
+	_Alignas(DSP_ALIGN) float x[MIXER_EMITTERS];
+	_Alignas(DSP_ALIGN) float y[MIXER_EMITTERS];
+	_Alignas(DSP_ALIGN) float z[MIXER_EMITTERS];
+	_Alignas(DSP_ALIGN) float gain[MIXER_EMITTERS];
+	_Alignas(DSP_ALIGN) float radius[MIXER_EMITTERS]; /// silent from here on
+	mixer_voice_t voice[MIXER_EMITTERS];
+} mixer_scene_t;
+
+typedef enum mixer_cmd_type_t {
+	MIXER_CMD_PLAY,
+	MIXER_CMD_STOP,
+	MIXER_CMD_SET,
+	MIXER_CMD_BUS_GAIN,
+} mixer_cmd_type_t;
+
+typedef struct mixer_cmd_t {
+	mixer_cmd_type_t type;
+	mixer_voice_t voice;
+	float gain;
+	float pan;
+	mixer_sound_t sound; /// MIXER_CMD_PLAY only
+} mixer_cmd_t;
+
+typedef enum mixer_stage_t {
+	MIXER_STAGE_OFF,
+	MIXER_STAGE_ATTACK,
+	MIXER_STAGE_DECAY,
+	MIXER_STAGE_SUSTAIN,
+	MIXER_STAGE_RELEASE,
+} mixer_stage_t;
+
+typedef struct mixer_voice_state_t {
+	mixer_voice_t id;
+	mixer_stage_t stage;
+	int priority;
+	osc_t osc;
+	float freq;
+	float sweep_step; /// frequency factor per full control period
+	float sweep_rate; /// log2 of the frequency factor per sample
+	int sweep_left; /// samples
+	float noise;
+	uint32_t noise_state;
+
+	float level; /// envelope
+	float attack_rate; /// level per sample
+	float decay_rate;
+	float sustain;
+	int hold_left; /// samples, negative until stopped
+	float release_time; /// samples, at least one
+	float release_rate;
+
+	float gain;
+	float pan_left;
+	float pan_right;
+	float left; /// gain applied at the end of the last control period
+	float right;
+
+	const float *samples; /// instead of the oscillator, envelope included
+	int num_samples;
+	int position;
+	atomic_int *users;
+
+	int delay; /// samples of silence before it starts
+	int release_in; /// samples until released, negative never
+
+	bool spatial;
+	int emitter; /// scene index last time, checked first
+	float air; /// absorption lowpass coefficient
+	float air_state;
+} mixer_voice_state_t;
+
+typedef struct mixer_t {
+	// Main thread
+	float ui_bus_gain; /// edited by mixer_ui()
+
+	// Any thread -> audio thread
+	mpsc_t queue;
+	_Alignas(64) atomic_uint_least32_t next_id;
+
+	// Audio thread
+	_Alignas(64) float bus_gain;
+	float sample_rate; /// voices were set up for, 0 before the first block
+	mixer_voice_state_t voices[MIXER_VOICES];
+
+	// Simulation -> audio thread
+	sim_buffer_t scene_buffer;
+	mixer_scene_t scene_slots[3];
+
+	// Audio thread -> UI
+	_Alignas(64) atomic_int active;
+	atomic_int audible_emitters;
+	atomic_uint_least32_t stolen;
+	atomic_uint_least32_t rejected; /// sounds outranked by every voice
+
+	// Audio thread -> simulation
+	mpsc_t lost;
+
+	_Alignas(8) uint8_t queue_memory[MPSC_MEMORY_SIZE(MIXER_QUEUE, sizeof(mixer_cmd_t))];
+	_Alignas(8) uint8_t lost_memory[MPSC_MEMORY_SIZE(MIXER_LOST, sizeof(mixer_voice_t))];
+} mixer_t;
+
+void mixer_init(mixer_t *m);
+
+/// Any thread: starts a sound, the handle stays valid until it ends. Returns
+/// 0 when the command queue is full and the sound was dropped.
+mixer_voice_t mixer_play(mixer_t *m, const mixer_sound_t *sound);
+/// Any thread: releases the sound.
+void mixer_stop(mixer_t *m, mixer_voice_t voice);
+/// Any thread: changes gain and pan of a playing sound.
+void mixer_set(mixer_t *m, mixer_voice_t voice, float gain, float pan);
+void mixer_set_bus_gain(mixer_t *m, float gain);
+/// One thread only (the simulation): the next handle whose sound was stolen
+/// or dropped before it ended on its own, 0 when there are none left.
+mixer_voice_t mixer_next_lost(mixer_t *m);
+
+/// One thread only (the simulation): starts a new scene, fill in the
+/// listener and add emitters, then publish.
+mixer_scene_t *mixer_scene_begin(mixer_t *m, hmm_vec3 listener_position, hmm_vec3 listener_right);
+/// Returns false when the scene is full.
+bool mixer_scene_add(mixer_scene_t *scene, hmm_vec3 position, float gain, float radius, mixer_voice_t voice);
+void mixer_scene_publish(mixer_t *m);
+
+/// Samples until the sound ends by itself, -1 if it waits for mixer_stop().
+int mixer_sound_frames(const mixer_sound_t *sound, float sample_rate);
+/// Any thread: renders a sound dry (unit gain, no pan) into out, the noise
+/// seeded by seed. Returns the frames written, at most max_frames.
+int mixer_render_sound(const mixer_sound_t *sound, uint32_t seed, float *out, int max_frames, float sample_rate);
+
+/// Audio thread, before mixer_render(): starts a sound `offset` samples into
+/// the next block. Returns 0 when every voice outranks it.
+mixer_voice_t mixer_trigger(mixer_t *m, const mixer_sound_t *sound, int offset, float sample_rate);
+/// Audio thread, before mixer_render(): releases a sound `offset` samples
+/// into the next block.
+void mixer_release_at(mixer_t *m, mixer_voice_t voice, int offset);
+/// Audio thread: applies queued commands and adds every voice to left/right.
+void mixer_render(mixer_t *m, float *left, float *right, int n, float sample_rate);
+
+#ifdef ENABLE_IMGUI
+void mixer_ui(mixer_t *m);
+#endif
+
+#endif
@@ -0,0 +1,57 @@
+#include "mpsc.h"
+
+#include <assert.h>
+#include <string.h>
+
+static atomic_uint_least32_t *mpsc_seq(mpsc_t *q, uint32_t pos) {
+	return (atomic_uint_least32_t*)(q->cells + (size_t)(pos & q->mask) * q->stride);
+}
+
+void mpsc_init(mpsc_t *q, void *memory, uint32_t capacity, uint32_t elem_size) {
+	assert(capacity > 0 && (capacity & (capacity - 1)) == 0);
+	assert(((uintptr_t)memory & 7) == 0);
+	q->cells = memory;
+	q->stride = (uint32_t)MPSC_MEMORY_SIZE(1, elem_size);
+	q->elem_size = elem_size;
+	q->mask = capacity - 1;
+	for (uint32_t i = 0; i < capacity; i++) {
+		atomic_init(mpsc_seq(q, i), i);
+	}
+	atomic_init(&q->enqueue, 0);
+	atomic_init(&q->dropped, 0);
+	q->dequeue = 0;
+}
+
+bool mpsc_push(mpsc_t *q, const void *elem) {
+	uint32_t pos = atomic_load_explicit(&q->enqueue, memory_order_relaxed);
+	atomic_uint_least32_t *seq;
+	for (;;) {
+		seq = mpsc_seq(q, pos);
+		const int32_t diff = (int32_t)(atomic_load_explicit(seq, memory_order_acquire) - pos);
+		if (diff == 0) {
+			if (atomic_compare_exchange_weak_explicit(&q->enqueue, &pos, pos + 1, memory_order_relaxed, memory_order_relaxed)) {
+				break;
+			}
+		} else if (diff < 0) {
+			atomic_fetch_add_explicit(&q->dropped, 1, memory_order_relaxed);
+			return false;
+		} else {
+			pos = atomic_load_explicit(&q->enqueue, memory_order_relaxed);
+		}
+	}
+	memcpy((uint8_t*)seq + MPSC_CELL_HEADER, elem, q->elem_size);
+	atomic_store_explicit(seq, pos + 1, memory_order_release);
+	return true;
+}
+
+bool mpsc_pop(mpsc_t *q, void *elem) {
+	const uint32_t pos = q->dequeue;
+	atomic_uint_least32_t *seq = mpsc_seq(q, pos);
+	if ((int32_t)(atomic_load_explicit(seq, memory_order_acquire) - (pos + 1)) < 0) {
+		return false;
+	}
+	memcpy(elem, (uint8_t*)seq + MPSC_CELL_HEADER, q->elem_size);
+	atomic_store_explicit(seq, pos + q->mask + 1, memory_order_release);
+	q->dequeue = pos + 1;
+	return true;
+}
@@ -0,0 +1,40 @@
+#ifndef TOWER4_MPSC_H
+#define TOWER4_MPSC_H
+
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// Bounded lock-free multi producer / single consumer queue of fixed size
+// elements, after Dmitry Vyukov's bounded queue.
+//
+// Every cell carries a sequence number telling producers and the consumer
+// whose turn it is, so a producer claims a cell with one compare-and-swap and
+// never waits for another one to finish writing. Pushing into a full queue
+// fails and is counted instead of waiting, so it is safe to call from the
+// audio thread's producers at any rate.
+
+#define MPSC_CELL_HEADER 8
+/// Bytes of memory a queue of capacity elements of elem_size bytes needs
+#define MPSC_MEMORY_SIZE(capacity, elem_size) ((capacity) * ((MPSC_CELL_HEADER + (elem_size) + 7) & ~(size_t)7))
+
+typedef struct mpsc_t {
+	uint8_t *cells;
+	uint32_t stride;
+	uint32_t elem_size;
+	uint32_t mask;
+
+	_Alignas(64) atomic_uint_least32_t enqueue; /// producers
+	atomic_uint_least32_t dropped; /// pushes that found the queue full
+	_Alignas(64) uint32_t dequeue; /// consumer only
+} mpsc_t;
+
+/// capacity must be a power of two, memory MPSC_MEMORY_SIZE() bytes aligned to 8
+void mpsc_init(mpsc_t *q, void *memory, uint32_t capacity, uint32_t elem_size);
+/// Any thread: copies the element in, false when full.
+bool mpsc_push(mpsc_t *q, const void *elem);
+/// Consumer: copies the oldest element out, false when empty.
+bool mpsc_pop(mpsc_t *q, void *elem);
+
+#endif
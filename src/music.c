@@ -0,0 +1,118 @@
+#include "music.h"
+
+#include "osc.h"
+#include "tracker.h"
+
+// Cells, see the packing in tracker.h
+#define ___ 0x80
+#define OFF 0x81, TRACKER_NOTE_OFF
+#define N(note, instrument) 0x83, (note), (instrument)
+#define NV(note, instrument, volume) (note), (instrument), (volume)
+
+#define A1 TRACKER_NOTE(1, 9)
+#define F1 TRACKER_NOTE(1, 5)
+#define G1 TRACKER_NOTE(1, 7)
+#define E2 TRACKER_NOTE(2, 4)
+#define A2 TRACKER_NOTE(2, 9)
+#define C3 TRACKER_NOTE(3, 0)
+#define G4 TRACKER_NOTE(4, 7)
+#define A4 TRACKER_NOTE(4, 9)
+#define B4 TRACKER_NOTE(4, 11)
+#define C5 TRACKER_NOTE(5, 0)
+#define D5 TRACKER_NOTE(5, 2)
+#define E5 TRACKER_NOTE(5, 4)
+#define C7 TRACKER_NOTE(7, 0)
+
+#define KICK 1
+#define SNARE 2
+#define HAT 3
+#define BASS 4
+#define LEAD 5
+
+// Four channels: kick, snare and hats, bass, lead. One bar per pattern.
+const uint8_t music_theme[] = {
+	'T', '4', 'T', 'K', 1,
+	112, 4, 4, 16, 5, 4, 6,
+
+	// wave, noise, attack, decay, sustain, release, gain, pan, sweep, sweep time
+	OSC_SINE, 0, 0, 15, 0, 5, 150, 0, (uint8_t)-24, 8,
+	OSC_TRIANGLE, 200, 0, 12, 0, 8, 90, 0, (uint8_t)-12, 10,
+	OSC_SQUARE, 255, 0, 4, 0, 3, 40, 30, 0, 0,
+	OSC_SAW, 0, 1, 20, 150, 8, 90, 0, 0, 0,
+	OSC_SQUARE, 0, 2, 30, 120, 20, 50, (uint8_t)-20, 0, 0,
+
+	0, 0, 1, 2, 1, 3,
+
+	// 0: A minor groove
+	N(C3, KICK), ___, N(A1, BASS), ___,
+	___, ___, ___, ___,
+	___, NV(C7, HAT, 24), NV(A2, BASS, 40), ___,
+	___, ___, OFF, ___,
+	N(C3, KICK), N(C5, SNARE), N(A1, BASS), ___,
+	___, ___, ___, ___,
+	___, NV(C7, HAT, 24), N(E2, BASS), ___,
+	___, ___, ___, ___,
+	N(C3, KICK), NV(C7, HAT, 40), N(A1, BASS), ___,
+	___, ___, ___, ___,
+	N(C3, KICK), NV(C7, HAT, 24), NV(A2, BASS, 40), ___,
+	___, ___, OFF, ___,
+	N(C3, KICK), N(C5, SNARE), N(G1, BASS), ___,
+	___, ___, ___, ___,
+	___, NV(C7, HAT, 24), N(A1, BASS), ___,
+	___, NV(C7, HAT, 16), ___, ___,
+
+	// 1: lead over the groove
+	N(C3, KICK), ___, N(A1, BASS), N(A4, LEAD),
+	___, ___, ___, ___,
+	___, NV(C7, HAT, 24), NV(A2, BASS, 40), N(C5, LEAD),
+	___, ___, OFF, ___,
+	N(C3, KICK), N(C5, SNARE), N(A1, BASS), N(E5, LEAD),
+	___, ___, ___, ___,
+	___, NV(C7, HAT, 24), N(E2, BASS), ___,
+	___, ___, ___, OFF,
+	N(C3, KICK), NV(C7, HAT, 40), N(A1, BASS), N(D5, LEAD),
+	___, ___, ___, ___,
+	N(C3, KICK), NV(C7, HAT, 24), NV(A2, BASS, 40), N(C5, LEAD),
+	___, ___, OFF, ___,
+	N(C3, KICK), N(C5, SNARE), N(G1, BASS), N(B4, LEAD),
+	___, ___, ___, ___,
+	___, NV(C7, HAT, 24), N(A1, BASS), N(G4, LEAD),
+	___, NV(C7, HAT, 16), ___, OFF,
+
+	// 2: down to F
+	N(C3, KICK), ___, N(F1, BASS), N(A4, LEAD),
+	___, ___, ___, ___,
+	___, NV(C7, HAT, 24), ___, ___,
+	___, ___, OFF, ___,
+	N(C3, KICK), N(C5, SNARE), N(F1, BASS), N(C5, LEAD),
+	___, ___, ___, ___,
+	___, NV(C7, HAT, 24), ___, N(A4, LEAD),
+	___, ___, ___, ___,
+	N(C3, KICK), NV(C7, HAT, 40), N(G1, BASS), N(B4, LEAD),
+	___, ___, ___, ___,
+	N(C3, KICK), NV(C7, HAT, 24), ___, N(D5, LEAD),
+	___, ___, OFF, ___,
+	N(C3, KICK), N(C5, SNARE), N(G1, BASS), N(B4, LEAD),
+	___, ___, ___, ___,
+	___, NV(C7, HAT, 24), ___, N(G4, LEAD),
+	___, NV(C7, HAT, 16), ___, OFF,
+
+	// 3: turnaround on E
+	N(C3, KICK), ___, N(F1, BASS), N(A4, LEAD),
+	___, ___, ___, ___,
+	___, NV(C7, HAT, 24), ___, N(C5, LEAD),
+	___, ___, OFF, ___,
+	N(C3, KICK), N(C5, SNARE), N(G1, BASS), N(D5, LEAD),
+	___, ___, ___, ___,
+	___, NV(C7, HAT, 24), ___, N(E5, LEAD),
+	___, ___, ___, ___,
+	N(C3, KICK), NV(C7, HAT, 40), N(E2, BASS), N(E5, LEAD),
+	___, N(C5, SNARE), ___, ___,
+	N(C3, KICK), N(C5, SNARE), ___, N(D5, LEAD),
+	___, N(C5, SNARE), OFF, ___,
+	N(C3, KICK), N(C5, SNARE), N(E2, BASS), N(B4, LEAD),
+	___, N(C5, SNARE), ___, ___,
+	N(C3, KICK), N(C5, SNARE), ___, N(G4, LEAD),
+	N(C3, KICK), N(C5, SNARE), OFF, OFF,
+};
+const size_t music_theme_size = sizeof(music_theme);
@@ -0,0 +1,12 @@
+#ifndef TOWER4_MUSIC_H
+#define TOWER4_MUSIC_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+// Songs in the tracker's binary format (see tracker.h), compiled in.
+
+extern const uint8_t music_theme[];
+extern const size_t music_theme_size;
+
+#endif
@@ -0,0 +1,211 @@
+#include "osc.h"
+
+#include <math.h>
+#include <stdatomic.h>
+
+#include "simd.h"
+#include "thread.h"
+
+#define OSC_MASK (OSC_TABLE_SIZE - 1)
+#define OSC_FRAC_BITS (32 - OSC_TABLE_BITS)
+#define OSC_MAX_HARMONICS (OSC_TABLE_SIZE / 2)
+
+// One guard sample before and two after every table so cubic interpolation
+// never wraps; tables point at element 1.
+static float osc_tables[OSC_WAVE_NUM][OSC_BANDS][OSC_TABLE_SIZE + 3];
+enum { OSC_TABLES_EMPTY, OSC_TABLES_BUILDING, OSC_TABLES_READY };
+static atomic_int osc_tables_state;
+
+static const char *osc_wave_names[OSC_WAVE_NUM] = {
+	[OSC_SINE] = "sine",
+	[OSC_SAW] = "saw",
+	[OSC_SQUARE] = "square",
+	[OSC_TRIANGLE] = "triangle",
+};
+
+// Fourier series amplitude of harmonic h
+static double osc_harmonic(osc_wave_t wave, int h) {
+	switch (wave) {
+	case OSC_SINE:
+		return h == 1 ? 1.0 : 0.0;
+	case OSC_SAW:
+		return (h % 2 ? 2.0 : -2.0) / (M_PI * h);
+	case OSC_SQUARE:
+		return h % 2 ? 4.0 / (M_PI * h) : 0.0;
+	case OSC_TRIANGLE:
+		return h % 2 ? ((h / 2) % 2 ? -8.0 : 8.0) / (M_PI * M_PI * h * h) : 0.0;
+	default:
+		return 0.0;
+	}
+}
+
+static int osc_band_harmonics(int band) {
+	return OSC_MAX_HARMONICS >> band;
+}
+
+// Richest band whose top harmonic stays below Nyquist at step cycles per sample
+static int osc_band(double step) {
+	int band = 0;
+	while (band < OSC_BANDS - 1 && osc_band_harmonics(band) * step > 0.5) {
+		band++;
+	}
+	return band;
+}
+
+void osc_tables_init(void) {
+	int state = OSC_TABLES_EMPTY;
+	if (!atomic_compare_exchange_strong_explicit(&osc_tables_state, &state, OSC_TABLES_BUILDING,
+			memory_order_acquire, memory_order_acquire)) {
+		// Someone else builds them, tables are only usable once ready
+		while (state != OSC_TABLES_READY) {
+			thread_yield();
+			state = atomic_load_explicit(&osc_tables_state, memory_order_acquire);
+		}
+		return;
+	}
+
+	// sin(2 pi h i / N) is sine[h * i mod N] for whole harmonics, so the
+	// additive synthesis below needs no further sin() calls
+	static double sine[OSC_TABLE_SIZE];
+	static double acc[OSC_TABLE_SIZE];
+	for (int i = 0; i < OSC_TABLE_SIZE; i++) {
+		sine[i] = sin(2.0 * M_PI * i / OSC_TABLE_SIZE);
+	}
+
+	for (int w = 0; w < OSC_WAVE_NUM; w++) {
+		for (int i = 0; i < OSC_TABLE_SIZE; i++) {
+			acc[i] = 0.0;
+		}
+		// From the band with the fewest harmonics up, each band adds the
+		// harmonics the previous one lacked
+		int harmonics = 0;
+		for (int band = OSC_BANDS - 1; band >= 0; band--) {
+			for (int h = harmonics + 1; h <= osc_band_harmonics(band); h++) {
+				const double a = osc_harmonic((osc_wave_t)w, h);
+				if (a == 0.0) {
+					continue;
+				}
+				for (int i = 0; i < OSC_TABLE_SIZE; i++) {
+					acc[i] += a * sine[(h * i) & OSC_MASK];
+				}
+			}
+			harmonics = osc_band_harmonics(band);
+
+			float *t = osc_tables[w][band];
+			for (int i = 0; i < OSC_TABLE_SIZE; i++) {
+				t[i + 1] = (float)acc[i];
+			}
+			t[0] = t[OSC_TABLE_SIZE];
+			t[OSC_TABLE_SIZE + 1] = t[1];
+			t[OSC_TABLE_SIZE + 2] = t[2];
+		}
+	}
+	atomic_store_explicit(&osc_tables_state, OSC_TABLES_READY, memory_order_release);
+}
+
+const char *osc_wave_name(osc_wave_t wave) {
+	return wave < OSC_WAVE_NUM ? osc_wave_names[wave] : "?";
+}
+
+void osc_init(osc_t *o, osc_wave_t wave, osc_interp_t interp) {
+	*o = (osc_t){
+		.wave = wave,
+		.interp = interp,
+		.table = osc_tables[wave][0] + 1,
+	};
+}
+
+void osc_set_freq(osc_t *o, float freq, float sample_rate) {
+	const double cycles = (double)freq / (double)sample_rate;
+	o->inc = (uint32_t)(int64_t)(cycles * 4294967296.0);
+
+	o->table = osc_tables[o->wave][osc_band(fabs(cycles))] + 1;
+}
+
+static inline float osc_linear(const float *t, uint32_t index, float frac) {
+	return t[index] + (t[index + 1] - t[index]) * frac;
+}
+
+static inline float osc_cubic(const float *t, uint32_t index, float frac) {
+	const float ym1 = t[(int)index - 1];
+	const float y0 = t[index];
+	const float y1 = t[index + 1];
+	const float y2 = t[index + 2];
+	const float c1 = 0.5f * (y1 - ym1);
+	const float c2 = ym1 - 2.5f * y0 + 2.0f * y1 - 0.5f * y2;
+	const float c3 = 0.5f * (y2 - ym1) + 1.5f * (y0 - y1);
+	return ((c3 * frac + c2) * frac + c1) * frac + y0;
+}
+
+void osc_process(osc_t *o, float *out, int n) {
+	const float *t = o->table;
+	const float frac_scale = 1.0f / (float)(1u << OSC_FRAC_BITS);
+	const uint32_t frac_mask = (1u << OSC_FRAC_BITS) - 1;
+	uint32_t phase = o->phase;
+	const uint32_t inc = o->inc;
+
+	// Lanes run SIMD_WIDTH consecutive phases; the interpolation mode is fixed
+	// per block so the loops stay tight
+	const vi_t vmask = vi_set1((int32_t)frac_mask);
+	const vf_t vscale = vf_set1(frac_scale);
+	const vi_t vstep = vi_set1((int32_t)(inc * SIMD_WIDTH));
+	vi_t vphase = vi_ramp(phase, inc);
+	int i = 0;
+	if (o->interp == OSC_CUBIC) {
+		for (; i + SIMD_WIDTH <= n; i += SIMD_WIDTH) {
+			const vi_t index = vi_srl(vphase, OSC_FRAC_BITS);
+			const vf_t frac = vf_mul(vi_to_vf(vi_and(vphase, vmask)), vscale);
+			const vf_t ym1 = vf_gather(t - 1, index);
+			const vf_t y0 = vf_gather(t, index);
+			const vf_t y1 = vf_gather(t + 1, index);
+			const vf_t y2 = vf_gather(t + 2, index);
+			const vf_t c1 = vf_mul(vf_set1(0.5f), vf_sub(y1, ym1));
+			const vf_t c2 = vf_sub(vf_add(ym1, vf_mul(vf_set1(2.0f), y1)), vf_add(vf_mul(vf_set1(2.5f), y0), vf_mul(vf_set1(0.5f), y2)));
+			const vf_t c3 = vf_add(vf_mul(vf_set1(0.5f), vf_sub(y2, ym1)), vf_mul(vf_set1(1.5f), vf_sub(y0, y1)));
+			vf_store(out + i, vf_add(vf_mul(vf_add(vf_mul(vf_add(vf_mul(c3, frac), c2), frac), c1), frac), y0));
+			vphase = vi_add(vphase, vstep);
+		}
+		phase += inc * (uint32_t)i;
+		for (; i < n; i++) {
+			out[i] = osc_cubic(t, phase >> OSC_FRAC_BITS, (float)(phase & frac_mask) * frac_scale);
+			phase += inc;
+		}
+	} else {
+		for (; i + SIMD_WIDTH <= n; i += SIMD_WIDTH) {
+			const vi_t index = vi_srl(vphase, OSC_FRAC_BITS);
+			const vf_t frac = vf_mul(vi_to_vf(vi_and(vphase, vmask)), vscale);
+			const vf_t a = vf_gather(t, index);
+			const vf_t b = vf_gather(t + 1, index);
+			vf_store(out + i, vf_add(a, vf_mul(vf_sub(b, a), frac)));
+			vphase = vi_add(vphase, vstep);
+		}
+		phase += inc * (uint32_t)i;
+		for (; i < n; i++) {
+			out[i] = osc_linear(t, phase >> OSC_FRAC_BITS, (float)(phase & frac_mask) * frac_scale);
+			phase += inc;
+		}
+	}
+	o->phase = phase;
+}
+
+void osc_lookup(osc_wave_t wave, const float *phase, float *out, int n, float step) {
+	const float *t = osc_tables[wave][osc_band(fabs((double)step))] + 1;
+	const vf_t size = vf_set1((float)OSC_TABLE_SIZE);
+	const vi_t mask = vi_set1(OSC_MASK);
+	int i = 0;
+	for (; i + SIMD_WIDTH <= n; i += SIMD_WIDTH) {
+		const vf_t p = vf_load(phase + i);
+		const vf_t x = vf_mul(vf_sub(p, vf_floor(p)), size);
+		const vi_t whole = vf_to_vi(x);
+		const vf_t frac = vf_sub(x, vi_to_vf(whole));
+		const vi_t index = vi_and(whole, mask);
+		const vf_t a = vf_gather(t, index);
+		const vf_t b = vf_gather(t + 1, index);
+		vf_store(out + i, vf_add(a, vf_mul(vf_sub(b, a), frac)));
+	}
+	for (; i < n; i++) {
+		const float x = (phase[i] - floorf(phase[i])) * (float)OSC_TABLE_SIZE;
+		const int index = (int)x;
+		out[i] = osc_linear(t, (uint32_t)index & OSC_MASK, x - (float)index);
+	}
+}
@@ -0,0 +1,56 @@
+#ifndef TOWER4_OSC_H
+#define TOWER4_OSC_H
+
+#include <stdint.h>
+
+// Band-limited wavetable oscillators.
+//
+// Every waveform is stored as OSC_BANDS single cycle tables, band k holding
+// only the first OSC_TABLE_SIZE / 2 >> k harmonics. osc_set_freq() picks the
+// richest band whose highest harmonic stays below Nyquist, so saw, square
+// and triangle don't alias at any pitch. Phase is a 32 bit fixed point
+// accumulator that wraps by itself; its top OSC_TABLE_BITS bits index the
+// table and the rest is the interpolation fraction.
+//
+// The tables are built once by osc_tables_init() and shared read-only.
+
+#define OSC_TABLE_BITS 11
+#define OSC_TABLE_SIZE (1 << OSC_TABLE_BITS)
+#define OSC_BANDS OSC_TABLE_BITS
+
+typedef enum osc_wave_t {
+	OSC_SINE,
+	OSC_SAW,
+	OSC_SQUARE,
+	OSC_TRIANGLE,
+	OSC_WAVE_NUM,
+} osc_wave_t;
+
+typedef enum osc_interp_t {
+	OSC_LINEAR,
+	OSC_CUBIC, /// 4 point Hermite, for low pitches where linear sounds dull
+} osc_interp_t;
+
+typedef struct osc_t {
+	uint32_t phase;
+	uint32_t inc; /// phase increment per sample
+	osc_wave_t wave;
+	osc_interp_t interp;
+	const float *table; /// band for the current frequency
+} osc_t;
+
+/// Builds all tables before any oscillator runs. Safe to call from several
+/// threads, later calls wait for the first one to finish.
+void osc_tables_init(void);
+const char *osc_wave_name(osc_wave_t wave);
+
+void osc_init(osc_t *o, osc_wave_t wave, osc_interp_t interp);
+void osc_set_freq(osc_t *o, float freq, float sample_rate);
+/// Writes n samples at the current frequency.
+void osc_process(osc_t *o, float *out, int n);
+/// Phase modulation: out[i] = wave(phase[i]), phase in cycles, any range.
+/// step is the largest phase change per sample in cycles and picks the band
+/// like osc_set_freq(). Linear interpolation.
+void osc_lookup(osc_wave_t wave, const float *phase, float *out, int n, float step);
+
+#endif
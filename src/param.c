@@ -0,0 +1,162 @@
+#include "param.h"
+
+#include <assert.h>
+#include <math.h>
+#include <string.h>
+
+void param_bank_init(param_bank_t *b, const float *initial, int count, int sample_rate) {
+	assert(count <= PARAM_MAX);
+	memset(b, 0, sizeof(*b));
+	mpsc_init(&b->queue, b->queue_memory, PARAM_QUEUE, sizeof(param_event_t));
+	atomic_init(&b->now, 0);
+	atomic_init(&b->sample_rate, sample_rate);
+	atomic_init(&b->dropped, 0);
+	b->count = count;
+	for (int i = 0; i < count; i++) {
+		b->params[i] = (param_t){.value = initial[i], .target = initial[i]};
+	}
+}
+
+uint64_t param_bank_now(param_bank_t *b) {
+	return atomic_load_explicit(&b->now, memory_order_relaxed);
+}
+
+int param_bank_rate(param_bank_t *b) {
+	return atomic_load_explicit(&b->sample_rate, memory_order_relaxed);
+}
+
+bool param_schedule(param_bank_t *b, int id, uint64_t time, float value, uint32_t ramp, param_curve_t curve) {
+	assert(id >= 0 && id < PARAM_MAX);
+	return mpsc_push(&b->queue, &(param_event_t){
+		.time = time,
+		.ramp = ramp,
+		.id = (uint16_t)id,
+		.curve = (uint8_t)curve,
+		.value = value,
+	});
+}
+
+bool param_set(param_bank_t *b, int id, float value, float ramp_seconds) {
+	const double frames = (double)ramp_seconds * param_bank_rate(b);
+	return param_schedule(b, id, 0, value, frames > 0.0 ? (uint32_t)frames : 0, PARAM_LINEAR);
+}
+
+bool param_automate(param_bank_t *b, int id, uint64_t time, const param_point_t *points, int count, param_curve_t curve) {
+	const double rate = param_bank_rate(b);
+	double start = 0.0;
+	bool ok = true;
+	for (int i = 0; i < count; i++) {
+		const double end = points[i].time > start ? points[i].time : start;
+		ok &= param_schedule(b, id, time + (uint64_t)(start * rate), points[i].value, (uint32_t)((end - start) * rate), curve);
+		start = end;
+	}
+	return ok;
+}
+
+// Keeps the list sorted by time, events for the same frame in arrival order
+static void param_insert(param_bank_t *b, const param_event_t *e) {
+	if (b->num_pending == PARAM_PENDING) {
+		atomic_fetch_add_explicit(&b->dropped, 1, memory_order_relaxed);
+		return;
+	}
+	int i = b->num_pending++;
+	while (i > 0 && b->pending[i - 1].time > e->time) {
+		b->pending[i] = b->pending[i - 1];
+		i--;
+	}
+	b->pending[i] = *e;
+}
+
+void param_bank_begin(param_bank_t *b, int sample_rate) {
+	atomic_store_explicit(&b->sample_rate, sample_rate, memory_order_relaxed);
+	atomic_store_explicit(&b->now, b->frame, memory_order_relaxed);
+	param_event_t e;
+	for (int i = 0; i < PARAM_EVENTS_PER_BLOCK && mpsc_pop(&b->queue, &e); i++) {
+		if (e.id < b->count) {
+			param_insert(b, &e);
+		}
+	}
+}
+
+static void param_ramp(param_t *p, float target, uint32_t ramp, param_curve_t curve) {
+	p->target = target;
+	p->curve = curve;
+	p->remaining = (int)ramp;
+	if (ramp == 0) {
+		p->value = target;
+		p->step = 0.0f;
+	} else if (curve == PARAM_EXPONENTIAL && p->value * target > 0.0f) {
+		p->step = powf(target / p->value, 1.0f / (float)ramp);
+	} else if (curve == PARAM_STEP) {
+		p->step = 0.0f;
+	} else {
+		p->curve = PARAM_LINEAR;
+		p->step = (target - p->value) / (float)ramp;
+	}
+}
+
+int param_bank_next(param_bank_t *b, int max) {
+	int applied = 0;
+	while (applied < b->num_pending && b->pending[applied].time <= b->frame) {
+		const param_event_t *e = &b->pending[applied++];
+		param_ramp(&b->params[e->id], e->value, e->ramp, (param_curve_t)e->curve);
+	}
+	if (applied > 0) {
+		b->num_pending -= applied;
+		memmove(b->pending, b->pending + applied, sizeof(param_event_t) * (size_t)b->num_pending);
+	}
+	int n = max;
+	if (b->num_pending > 0 && b->pending[0].time - b->frame < (uint64_t)max) {
+		n = (int)(b->pending[0].time - b->frame);
+	}
+	b->frame += (uint64_t)n;
+	return n;
+}
+
+void param_render(param_t *p, float *out, int n) {
+	int i = 0;
+	if (p->remaining > 0) {
+		const int count = n < p->remaining ? n : p->remaining;
+		float value = p->value;
+		if (p->curve == PARAM_LINEAR) {
+			for (; i < count; i++) {
+				value += p->step;
+				out[i] = value;
+			}
+		} else if (p->curve == PARAM_EXPONENTIAL) {
+			for (; i < count; i++) {
+				value *= p->step;
+				out[i] = value;
+			}
+		} else {
+			for (; i < count; i++) {
+				out[i] = value;
+			}
+		}
+		p->remaining -= count;
+		// Land exactly, whatever rounding did on the way
+		p->value = p->remaining == 0 ? p->target : value;
+		if (p->remaining == 0) {
+			out[i - 1] = p->target;
+		}
+	}
+	for (; i < n; i++) {
+		out[i] = p->value;
+	}
+}
+
+float param_advance(param_t *p, int n) {
+	if (p->remaining > 0) {
+		const int count = n < p->remaining ? n : p->remaining;
+		if (p->curve == PARAM_LINEAR) {
+			p->value += p->step * (float)count;
+		} else if (p->curve == PARAM_EXPONENTIAL) {
+			p->value *= powf(p->step, (float)count);
+		}
+		p->remaining -= count;
+		if (p->remaining == 0) {
+			p->value = p->target;
+		}
+	}
+	return p->value;
+}
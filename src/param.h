@@ -0,0 +1,108 @@
+#ifndef TOWER4_PARAM_H
+#define TOWER4_PARAM_H
+
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "mpsc.h"
+
+// Smoothed, automatable parameters for the audio thread.
+//
+// A param_bank_t holds up to PARAM_MAX parameters of one audio processor.
+// Any thread changes them by scheduling events: at an audio frame (or as soon
+// as possible), ramp to a value over some frames, linearly or exponentially.
+// Events go through a lock-free queue (see mpsc.h) into a time sorted list
+// on the audio thread, which splits its blocks at event times so every ramp
+// starts on its exact frame. Automation curves are just runs of events, so
+// the sequencer and gameplay can schedule them ahead of time.
+//
+// Usage on the audio thread, every parameter must be rendered or advanced
+// for every segment:
+//   param_bank_begin(&bank, sample_rate);
+//   for (int done = 0; done < n;) {
+//       const int k = param_bank_next(&bank, n - done);
+//       param_render(&bank.params[GAIN], gain + done, k);
+//       param_advance(&bank.params[SIZE], k);
+//       done += k;
+//   }
+
+#define PARAM_MAX 16
+/// Events waiting for their time on the audio thread
+#define PARAM_PENDING 256
+/// Events in flight between threads, power of two
+#define PARAM_QUEUE 256
+/// Events moved from the queue per block, bounds the cost of a flood
+#define PARAM_EVENTS_PER_BLOCK 128
+
+typedef enum param_curve_t {
+	PARAM_LINEAR,
+	PARAM_EXPONENTIAL, /// constant ratio per sample, linear when crossing zero
+	PARAM_STEP, /// jumps at the end of the ramp
+} param_curve_t;
+
+typedef struct param_t {
+	float value;
+	float target;
+	float step; /// added, or multiplied for exponential ramps
+	int remaining; /// samples until target
+	param_curve_t curve;
+} param_t;
+
+typedef struct param_event_t {
+	uint64_t time; /// audio frame, anything in the past means now
+	uint32_t ramp; /// frames to reach value
+	uint16_t id;
+	uint8_t curve;
+	float value;
+} param_event_t;
+
+typedef struct param_point_t {
+	double time; /// seconds from the start of the curve
+	float value;
+} param_point_t;
+
+typedef struct param_bank_t {
+	// Any thread -> audio thread
+	mpsc_t queue;
+	_Alignas(64) atomic_uint_least64_t now; /// frame at the start of the current block
+	atomic_int sample_rate;
+
+	// Audio thread
+	_Alignas(64) param_t params[PARAM_MAX];
+	int count;
+	uint64_t frame; /// of the next sample to render
+	int num_pending;
+	param_event_t pending[PARAM_PENDING]; /// sorted by time
+	atomic_uint_least32_t dropped; /// events that found the pending list full
+
+	_Alignas(8) uint8_t queue_memory[MPSC_MEMORY_SIZE(PARAM_QUEUE, sizeof(param_event_t))];
+} param_bank_t;
+
+/// initial holds count values
+void param_bank_init(param_bank_t *b, const float *initial, int count, int sample_rate);
+
+/// Any thread: audio frame being rendered about now, to schedule against
+uint64_t param_bank_now(param_bank_t *b);
+/// Any thread: frames per second
+int param_bank_rate(param_bank_t *b);
+/// Any thread: schedules one ramp, returns false when the queue is full.
+bool param_schedule(param_bank_t *b, int id, uint64_t time, float value, uint32_t ramp, param_curve_t curve);
+/// Any thread: ramps to value starting now, the usual way to follow a UI control.
+bool param_set(param_bank_t *b, int id, float value, float ramp_seconds);
+/// Any thread: schedules a curve through points, starting at frame time.
+/// The first point is ramped to from wherever the parameter is.
+bool param_automate(param_bank_t *b, int id, uint64_t time, const param_point_t *points, int count, param_curve_t curve);
+
+/// Audio thread: takes new events off the queue, call once per block.
+void param_bank_begin(param_bank_t *b, int sample_rate);
+/// Audio thread: applies due events, returns how many samples up to max to
+/// render before the next one and moves the clock past them.
+int param_bank_next(param_bank_t *b, int max);
+/// Audio thread: n samples of the parameter, advancing it.
+void param_render(param_t *p, float *out, int n);
+/// Audio thread: advances without writing samples, returns the value after
+/// n samples. For control rate parameters read once per block.
+float param_advance(param_t *p, int n);
+
+#endif
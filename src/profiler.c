@@ -0,0 +1,461 @@
+#include "profiler.h"
+
+#include <stdatomic.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "sokol_time.h"
+
+#ifdef ENABLE_IMGUI
+#define CIMGUI_DEFINE_ENUMS_AND_STRUCTS
+#include "cimgui.h"
+#endif
+
+#if defined(__linux__) && !defined(__EMSCRIPTEN__)
+#define PROF_PERF_EVENTS
+#include <errno.h>
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+typedef struct prof_zone_t {
+	const char *name;
+
+	// Written by any thread, drained by prof_frame_end()
+	_Atomic uint64_t calls;
+	_Atomic uint64_t ticks;
+	_Atomic uint64_t max_ticks;
+	_Atomic uint64_t counters[PROF_COUNTER_NUM];
+
+	// Only touched by the thread calling prof_frame_end()
+	prof_stats_t frame;
+	prof_stats_t total;
+} prof_zone_t;
+
+typedef struct prof_scope_t {
+	int zone;
+	bool counted; /// counters were read at begin
+	uint64_t start_ticks;
+	uint64_t start_counters[PROF_COUNTER_NUM];
+} prof_scope_t;
+
+typedef struct prof_thread_t {
+	bool counters_tried;
+	int leader_fd;
+	int fds[PROF_COUNTER_NUM];
+	int slot[PROF_COUNTER_NUM]; /// position in the group read, -1 if missing
+	uint32_t available;
+
+	prof_scope_t stack[PROF_MAX_DEPTH];
+	int depth;
+} prof_thread_t;
+
+static struct {
+	prof_zone_t zones[PROF_MAX_ZONES];
+	_Atomic int num_zones;
+	atomic_flag register_lock;
+
+	atomic_bool counters_enabled;
+	_Atomic(const char *) counters_error; /// first reason any thread couldn't open its counters
+} prof = { .register_lock = ATOMIC_FLAG_INIT };
+
+static _Thread_local prof_thread_t prof_tls;
+
+static const char *prof_counter_names[PROF_COUNTER_NUM] = {
+	[PROF_COUNTER_CYCLES] = "cycles",
+	[PROF_COUNTER_INSTRUCTIONS] = "instructions",
+	[PROF_COUNTER_L1D_MISSES] = "L1d misses",
+	[PROF_COUNTER_LLC_MISSES] = "LLC misses",
+	[PROF_COUNTER_BRANCH_MISSES] = "branch misses",
+};
+
+// Any thread may fail to open its counters, the first reason sticks. The
+// reasons are string literals, so there is nothing else to publish.
+static void prof_counters_failed(const char *reason) {
+	const char *expected = NULL;
+	atomic_compare_exchange_strong_explicit(&prof.counters_error, &expected, reason, memory_order_relaxed, memory_order_relaxed);
+}
+
+#ifdef PROF_PERF_EVENTS
+static int perf_open(uint32_t type, uint64_t config, int group_fd) {
+	struct perf_event_attr attr;
+	memset(&attr, 0, sizeof(attr));
+	attr.size = sizeof(attr);
+	attr.type = type;
+	attr.config = config;
+	attr.disabled = group_fd < 0;
+	attr.exclude_kernel = 1;
+	attr.exclude_hv = 1;
+	attr.read_format = PERF_FORMAT_GROUP | PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+	// pid = 0, cpu = -1: count the calling thread on any cpu
+	return (int)syscall(__NR_perf_event_open, &attr, 0, -1, group_fd, 0);
+}
+
+static void prof_open_counters(prof_thread_t *t) {
+	static const struct {
+		uint32_t type;
+		uint64_t config;
+	} events[PROF_COUNTER_NUM] = {
+		[PROF_COUNTER_CYCLES] = { PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES },
+		[PROF_COUNTER_INSTRUCTIONS] = { PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS },
+		[PROF_COUNTER_L1D_MISSES] = { PERF_TYPE_HW_CACHE, PERF_COUNT_HW_CACHE_L1D
+			| (PERF_COUNT_HW_CACHE_OP_READ << 8) | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16) },
+		[PROF_COUNTER_LLC_MISSES] = { PERF_TYPE_HW_CACHE, PERF_COUNT_HW_CACHE_LL
+			| (PERF_COUNT_HW_CACHE_OP_READ << 8) | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16) },
+		[PROF_COUNTER_BRANCH_MISSES] = { PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES },
+	};
+
+	t->counters_tried = true;
+	t->leader_fd = -1;
+	int num_open = 0;
+	for (int i = 0; i < PROF_COUNTER_NUM; i++) {
+		// Whichever event opens first becomes the group leader, so a missing
+		// cycle counter doesn't take the cache counters down with it.
+		t->fds[i] = perf_open(events[i].type, events[i].config, t->leader_fd);
+		t->slot[i] = -1;
+		if (t->fds[i] < 0) {
+			prof_counters_failed(errno == EACCES || errno == EPERM
+				? "perf_event_open not permitted (see /proc/sys/kernel/perf_event_paranoid)"
+				: "perf_event_open: counter not supported");
+			continue;
+		}
+		if (t->leader_fd < 0) {
+			t->leader_fd = t->fds[i];
+		}
+		t->slot[i] = num_open++;
+		t->available |= 1u << i;
+	}
+
+	if (t->leader_fd >= 0) {
+		ioctl(t->leader_fd, PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+		ioctl(t->leader_fd, PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+	}
+}
+
+static void prof_close_counters(prof_thread_t *t) {
+	if (!t->counters_tried) {
+		return;
+	}
+	for (int i = 0; i < PROF_COUNTER_NUM; i++) {
+		if (t->fds[i] >= 0) {
+			close(t->fds[i]);
+		}
+	}
+	t->counters_tried = false;
+	t->leader_fd = -1;
+	t->available = 0;
+}
+
+static void prof_read_counters(prof_thread_t *t, uint64_t out[PROF_COUNTER_NUM]) {
+	// nr, time_enabled, time_running, values[nr]
+	uint64_t buf[3 + PROF_COUNTER_NUM];
+	if (t->leader_fd < 0 || read(t->leader_fd, buf, sizeof(buf)) < (ssize_t)(3 * sizeof(uint64_t))) {
+		memset(out, 0, sizeof(uint64_t) * PROF_COUNTER_NUM);
+		return;
+	}
+
+	const uint64_t enabled = buf[1];
+	const uint64_t running = buf[2];
+	for (int i = 0; i < PROF_COUNTER_NUM; i++) {
+		uint64_t value = 0;
+		if (t->slot[i] >= 0 && (uint64_t)t->slot[i] < buf[0]) {
+			value = buf[3 + t->slot[i]];
+			// Scale up if the kernel had to multiplex the group
+			if (running > 0 && running < enabled) {
+				value = (uint64_t)((double)value * (double)enabled / (double)running);
+			}
+		}
+		out[i] = value;
+	}
+}
+#else
+static void prof_open_counters(prof_thread_t *t) {
+	t->counters_tried = true;
+	t->leader_fd = -1;
+	prof_counters_failed("hardware counters are only supported on Linux");
+}
+
+static void prof_close_counters(prof_thread_t *t) {
+	t->counters_tried = false;
+}
+
+static void prof_read_counters(prof_thread_t *t, uint64_t out[PROF_COUNTER_NUM]) {
+	(void)t;
+	memset(out, 0, sizeof(uint64_t) * PROF_COUNTER_NUM);
+}
+#endif
+
+void prof_init(bool counters) {
+	const char *env = getenv("TOWER4_PERF_COUNTERS");
+	if (env && env[0] != '\0' && env[0] != '0') {
+		counters = true;
+	}
+	prof_set_counters_enabled(counters);
+}
+
+void prof_shutdown(void) {
+	prof_close_counters(&prof_tls);
+}
+
+int prof_register(const char *name) {
+	while (atomic_flag_test_and_set_explicit(&prof.register_lock, memory_order_acquire)) {
+	}
+
+	const int n = atomic_load_explicit(&prof.num_zones, memory_order_relaxed);
+	int zone = -1;
+	for (int i = 0; i < n; i++) {
+		if (strcmp(prof.zones[i].name, name) == 0) {
+			zone = i;
+			break;
+		}
+	}
+	if (zone < 0 && n < PROF_MAX_ZONES) {
+		zone = n;
+		prof.zones[zone].name = name;
+		atomic_store_explicit(&prof.num_zones, n + 1, memory_order_release);
+	}
+
+	atomic_flag_clear_explicit(&prof.register_lock, memory_order_release);
+	// Out of zones: all further zones are dropped rather than aliased
+	return zone;
+}
+
+int prof_begin_lazy(atomic_int *zone, const char *name) {
+	int id = atomic_load_explicit(zone, memory_order_acquire);
+	if (id == PROF_ZONE_UNREGISTERED) {
+		// Racing threads register the same name and get the same id, the
+		// exchange only decides who publishes it
+		int expected = PROF_ZONE_UNREGISTERED;
+		id = prof_register(name);
+		if (!atomic_compare_exchange_strong_explicit(zone, &expected, id, memory_order_acq_rel, memory_order_acquire)) {
+			id = expected;
+		}
+	}
+	prof_begin(id);
+	return id;
+}
+
+void prof_begin(int zone) {
+	prof_thread_t *t = &prof_tls;
+	if (zone < 0 || t->depth >= PROF_MAX_DEPTH) {
+		t->depth++;
+		return;
+	}
+
+	prof_scope_t *scope = &t->stack[t->depth++];
+	scope->zone = zone;
+	scope->counted = false;
+	if (atomic_load_explicit(&prof.counters_enabled, memory_order_relaxed)) {
+		if (!t->counters_tried) {
+			prof_open_counters(t);
+		}
+		if (t->available) {
+			prof_read_counters(t, scope->start_counters);
+			scope->counted = true;
+		}
+	}
+	// Read time last so the counter syscall isn't part of the measurement
+	scope->start_ticks = stm_now();
+}
+
+void prof_end(int zone) {
+	const uint64_t end_ticks = stm_now();
+	prof_thread_t *t = &prof_tls;
+	if (t->depth <= 0) {
+		return;
+	}
+	t->depth--;
+	if (zone < 0 || t->depth >= PROF_MAX_DEPTH) {
+		return;
+	}
+
+	const prof_scope_t *scope = &t->stack[t->depth];
+	if (scope->zone != zone) {
+		// Mismatched begin/end, drop the sample instead of corrupting stats
+		return;
+	}
+
+	prof_zone_t *z = &prof.zones[zone];
+	const uint64_t ticks = end_ticks - scope->start_ticks;
+	atomic_fetch_add_explicit(&z->calls, 1, memory_order_relaxed);
+	atomic_fetch_add_explicit(&z->ticks, ticks, memory_order_relaxed);
+	uint64_t max = atomic_load_explicit(&z->max_ticks, memory_order_relaxed);
+	while (ticks > max && !atomic_compare_exchange_weak_explicit(&z->max_ticks, &max, ticks,
+				memory_order_relaxed, memory_order_relaxed)) {
+	}
+
+	if (scope->counted && atomic_load_explicit(&prof.counters_enabled, memory_order_relaxed)) {
+		uint64_t end_counters[PROF_COUNTER_NUM];
+		prof_read_counters(t, end_counters);
+		for (int i = 0; i < PROF_COUNTER_NUM; i++) {
+			if (end_counters[i] > scope->start_counters[i]) {
+				atomic_fetch_add_explicit(&z->counters[i], end_counters[i] - scope->start_counters[i],
+						memory_order_relaxed);
+			}
+		}
+	}
+}
+
+void prof_frame_end(void) {
+	const int n = atomic_load_explicit(&prof.num_zones, memory_order_acquire);
+	for (int i = 0; i < n; i++) {
+		prof_zone_t *z = &prof.zones[i];
+		prof_stats_t frame = {
+			.calls = atomic_exchange_explicit(&z->calls, 0, memory_order_relaxed),
+			.ticks = atomic_exchange_explicit(&z->ticks, 0, memory_order_relaxed),
+			.max_ticks = atomic_exchange_explicit(&z->max_ticks, 0, memory_order_relaxed),
+		};
+		for (int c = 0; c < PROF_COUNTER_NUM; c++) {
+			frame.counters[c] = atomic_exchange_explicit(&z->counters[c], 0, memory_order_relaxed);
+			z->total.counters[c] += frame.counters[c];
+		}
+		z->frame = frame;
+		z->total.calls += frame.calls;
+		z->total.ticks += frame.ticks;
+		if (frame.max_ticks > z->total.max_ticks) {
+			z->total.max_ticks = frame.max_ticks;
+		}
+	}
+}
+
+void prof_reset(void) {
+	prof_frame_end();
+	const int n = atomic_load_explicit(&prof.num_zones, memory_order_acquire);
+	for (int i = 0; i < n; i++) {
+		memset(&prof.zones[i].frame, 0, sizeof(prof_stats_t));
+		memset(&prof.zones[i].total, 0, sizeof(prof_stats_t));
+	}
+}
+
+void prof_set_counters_enabled(bool enabled) {
+	atomic_store_explicit(&prof.counters_enabled, enabled, memory_order_relaxed);
+	if (enabled && !prof_tls.counters_tried) {
+		prof_open_counters(&prof_tls);
+	}
+}
+
+bool prof_counters_enabled(void) {
+	return atomic_load_explicit(&prof.counters_enabled, memory_order_relaxed);
+}
+
+uint32_t prof_counters_available(void) {
+	return prof_tls.available;
+}
+
+const char *prof_counters_error(void) {
+	return prof_tls.available ? NULL : atomic_load_explicit(&prof.counters_error, memory_order_relaxed);
+}
+
+const char *prof_counter_name(prof_counter_t counter) {
+	return counter < PROF_COUNTER_NUM ? prof_counter_names[counter] : "?";
+}
+
+int prof_zone_count(void) {
+	return atomic_load_explicit(&prof.num_zones, memory_order_acquire);
+}
+
+const char *prof_zone_name(int zone) {
+	return prof.zones[zone].name;
+}
+
+prof_stats_t prof_zone_frame(int zone) {
+	return prof.zones[zone].frame;
+}
+
+prof_stats_t prof_zone_total(int zone) {
+	return prof.zones[zone].total;
+}
+
+static double per_call(double value, uint64_t calls) {
+	return calls ? value / (double)calls : 0.0;
+}
+
+void prof_report(FILE *out) {
+	prof_frame_end();
+
+	const bool counters = prof_counters_enabled() && prof_counters_available();
+	fprintf(out, "%-24s %10s %12s %12s %12s", "zone", "calls", "total ms", "avg us", "max us");
+	if (counters) {
+		fprintf(out, " %8s %12s %12s %12s", "IPC", "L1d miss/c", "LLC miss/c", "br miss/c");
+	}
+	fprintf(out, "\n");
+
+	const int n = prof_zone_count();
+	for (int i = 0; i < n; i++) {
+		const prof_stats_t s = prof.zones[i].total;
+		if (s.calls == 0) {
+			continue;
+		}
+		fprintf(out, "%-24s %10llu %12.3f %12.3f %12.3f", prof.zones[i].name,
+				(unsigned long long)s.calls, stm_ms(s.ticks),
+				per_call(stm_us(s.ticks), s.calls), stm_us(s.max_ticks));
+		if (counters) {
+			fprintf(out, " %8.2f %12.1f %12.1f %12.1f",
+					per_call((double)s.counters[PROF_COUNTER_INSTRUCTIONS], s.counters[PROF_COUNTER_CYCLES]),
+					per_call((double)s.counters[PROF_COUNTER_L1D_MISSES], s.calls),
+					per_call((double)s.counters[PROF_COUNTER_LLC_MISSES], s.calls),
+					per_call((double)s.counters[PROF_COUNTER_BRANCH_MISSES], s.calls));
+		}
+		fprintf(out, "\n");
+	}
+	const char *counters_error = prof_counters_error();
+	if (prof_counters_enabled() && counters_error) {
+		fprintf(out, "hardware counters unavailable: %s\n", counters_error);
+	}
+}
+
+#ifdef ENABLE_IMGUI
+void prof_ui(bool *open) {
+	igBegin("Profiler", open, ImGuiWindowFlags_None);
+
+	bool counters = prof_counters_enabled();
+	if (igCheckbox("Hardware counters", &counters)) {
+		prof_set_counters_enabled(counters);
+	}
+	const char *error = prof_counters_error();
+	if (counters && error) {
+		igTextDisabled("%s", error);
+	}
+	if (igButton("Reset", (ImVec2){0, 0})) {
+		prof_reset();
+	}
+
+	const bool show_counters = counters && prof_counters_available();
+	const int columns = show_counters ? 8 : 4;
+	if (igBeginTable("zones", columns, ImGuiTableFlags_RowBg | ImGuiTableFlags_Borders, (ImVec2){0, 0}, 0)) {
+		igTableSetupColumn("zone", ImGuiTableColumnFlags_None, 0, 0);
+		igTableSetupColumn("calls", ImGuiTableColumnFlags_None, 0, 0);
+		igTableSetupColumn("ms", ImGuiTableColumnFlags_None, 0, 0);
+		igTableSetupColumn("avg ms", ImGuiTableColumnFlags_None, 0, 0);
+		if (show_counters) {
+			igTableSetupColumn("IPC", ImGuiTableColumnFlags_None, 0, 0);
+			igTableSetupColumn("L1d miss", ImGuiTableColumnFlags_None, 0, 0);
+			igTableSetupColumn("LLC miss", ImGuiTableColumnFlags_None, 0, 0);
+			igTableSetupColumn("br miss", ImGuiTableColumnFlags_None, 0, 0);
+		}
+		igTableHeadersRow();
+
+		const int n = prof_zone_count();
+		for (int i = 0; i < n; i++) {
+			const prof_stats_t f = prof.zones[i].frame;
+			const prof_stats_t t = prof.zones[i].total;
+			igTableNextRow(ImGuiTableRowFlags_None, 0);
+			igTableNextColumn(); igText("%s", prof.zones[i].name);
+			igTableNextColumn(); igText("%llu", (unsigned long long)f.calls);
+			igTableNextColumn(); igText("%.3f", stm_ms(f.ticks));
+			igTableNextColumn(); igText("%.3f", per_call(stm_ms(t.ticks), t.calls));
+			if (show_counters) {
+				igTableNextColumn(); igText("%.2f", per_call((double)f.counters[PROF_COUNTER_INSTRUCTIONS], f.counters[PROF_COUNTER_CYCLES]));
+				igTableNextColumn(); igText("%llu", (unsigned long long)f.counters[PROF_COUNTER_L1D_MISSES]);
+				igTableNextColumn(); igText("%llu", (unsigned long long)f.counters[PROF_COUNTER_LLC_MISSES]);
+				igTableNextColumn(); igText("%llu", (unsigned long long)f.counters[PROF_COUNTER_BRANCH_MISSES]);
+			}
+		}
+		igEndTable();
+	}
+
+	igEnd();
+}
+#endif
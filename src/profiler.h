@@ -0,0 +1,89 @@
+#ifndef TOWER4_PROFILER_H
+#define TOWER4_PROFILER_H
+
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+
+// Lightweight zone profiler.
+//
+// Zones measure wall time with sokol_time and, on Linux, optionally hardware
+// counters through perf_event_open. Counters are opened lazily per thread and
+// silently stay at zero when the kernel refuses them (perf_event_paranoid,
+// containers, VMs without a PMU, ...).
+//
+// Usage:
+//   PROF_ZONE_BEGIN(collision);
+//   ...
+//   PROF_ZONE_END(collision);
+//
+// Both must sit in the same block. PROF_ZONE_BEGIN expands to declarations
+// only, so a stray unbraced `if` fails to compile instead of splitting it.
+
+#define PROF_MAX_ZONES 64
+#define PROF_MAX_DEPTH 32
+
+typedef enum prof_counter_t {
+	PROF_COUNTER_CYCLES,
+	PROF_COUNTER_INSTRUCTIONS,
+	PROF_COUNTER_L1D_MISSES,
+	PROF_COUNTER_LLC_MISSES,
+	PROF_COUNTER_BRANCH_MISSES,
+	PROF_COUNTER_NUM,
+} prof_counter_t;
+
+typedef struct prof_stats_t {
+	uint64_t calls;
+	uint64_t ticks; /// sokol_time ticks
+	uint64_t max_ticks; /// longest single call
+	uint64_t counters[PROF_COUNTER_NUM];
+} prof_stats_t;
+
+/// Must be called after stm_setup(). Counters are enabled when requested or
+/// when the TOWER4_PERF_COUNTERS environment variable is set.
+void prof_init(bool counters);
+void prof_shutdown(void);
+
+/// Registers a zone (or returns the existing one with the same name).
+int prof_register(const char *name);
+/// Zone id slot of PROF_ZONE_BEGIN before its first use
+#define PROF_ZONE_UNREGISTERED -2
+/// Registers the zone in *zone on first use, from any thread, and begins
+/// it. Returns the zone id for prof_end().
+int prof_begin_lazy(atomic_int *zone, const char *name);
+void prof_begin(int zone);
+void prof_end(int zone);
+
+/// Publishes the stats gathered since the last call as "last frame".
+void prof_frame_end(void);
+/// Clears the accumulated totals, e.g. before a benchmark run.
+void prof_reset(void);
+
+void prof_set_counters_enabled(bool enabled);
+bool prof_counters_enabled(void);
+/// Bitmask of counters the calling thread could open, 0 if none.
+uint32_t prof_counters_available(void);
+/// Reason the counters are unavailable, NULL if they work.
+const char *prof_counters_error(void);
+const char *prof_counter_name(prof_counter_t counter);
+
+int prof_zone_count(void);
+const char *prof_zone_name(int zone);
+prof_stats_t prof_zone_frame(int zone); /// last completed frame
+prof_stats_t prof_zone_total(int zone); /// since start or last prof_reset()
+
+/// Prints the zone totals as a table, used by benchmark runs.
+void prof_report(FILE *out);
+
+#ifdef ENABLE_IMGUI
+void prof_ui(bool *open);
+#endif
+
+#define PROF_ZONE_BEGIN(name) \
+	static atomic_int prof__zone_##name = PROF_ZONE_UNREGISTERED; \
+	const int prof__zone_id_##name = prof_begin_lazy(&prof__zone_##name, #name)
+
+#define PROF_ZONE_END(name) prof_end(prof__zone_id_##name)
+
+#endif
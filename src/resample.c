@@ -0,0 +1,115 @@
+#include "resample.h"
+
+#include <math.h>
+#include <string.h>
+
+/// Passband edge as a share of the input Nyquist frequency, the Blackman
+/// window's transition band is centered on it
+#define RESAMPLE_CUTOFF 0.9
+#define RESAMPLE_HISTORY (RESAMPLE_TAPS - 1)
+
+static int resample_gcd(int a, int b) {
+	while (b != 0) {
+		const int t = a % b;
+		a = b;
+		b = t;
+	}
+	return a;
+}
+
+bool resample_supported(int in_rate, int out_rate) {
+	return in_rate > 0 && in_rate <= out_rate && out_rate / resample_gcd(out_rate, in_rate) <= RESAMPLE_MAX_PHASES;
+}
+
+// Lowpass at the input rate, x in input frames from the center
+static double resample_kernel(double x) {
+	const double half = RESAMPLE_TAPS / 2;
+	if (fabs(x) >= half) {
+		return 0.0;
+	}
+	const double sinc = x == 0.0 ? 1.0 : sin(M_PI * RESAMPLE_CUTOFF * x) / (M_PI * RESAMPLE_CUTOFF * x);
+	const double window = 0.42 + 0.5 * cos(M_PI * x / half) + 0.08 * cos(2.0 * M_PI * x / half);
+	return RESAMPLE_CUTOFF * sinc * window;
+}
+
+bool resample_init(resample_t *r, int in_rate, int out_rate, int channels) {
+	if (!resample_supported(in_rate, out_rate) || channels < 1 || channels > RESAMPLE_MAX_CHANNELS) {
+		return false;
+	}
+	const int gcd = resample_gcd(out_rate, in_rate);
+	memset(r->input, 0, sizeof(r->input));
+	r->in_rate = in_rate;
+	r->out_rate = out_rate;
+	r->up = out_rate / gcd;
+	r->down = in_rate / gcd;
+	r->channels = channels;
+	r->phase = 0;
+	r->ahead = 0;
+	for (int p = 0; p < r->up; p++) {
+		// Tap k weighs the input frame k - (TAPS / 2 - 1) - p / up away
+		double sum = 0.0;
+		double taps[RESAMPLE_TAPS];
+		for (int k = 0; k < RESAMPLE_TAPS; k++) {
+			taps[k] = resample_kernel((double)(k - (RESAMPLE_TAPS / 2 - 1)) - (double)p / r->up);
+			sum += taps[k];
+		}
+		// Unit gain at DC for every phase, or the phases beat against each other
+		for (int k = 0; k < RESAMPLE_TAPS; k++) {
+			r->filters[p][k] = (float)(taps[k] / sum);
+		}
+	}
+	return true;
+}
+
+int resample_needed(const resample_t *r, int out_frames) {
+	const int last = (r->phase + (out_frames - 1) * r->down) / r->up + 1;
+	return last > r->ahead ? last - r->ahead : 0;
+}
+
+float *resample_input(resample_t *r, int channel) {
+	return r->input[channel] + RESAMPLE_HISTORY + r->ahead;
+}
+
+static float resample_sum(vf_t v) {
+	_Alignas(SIMD_ALIGN) float lanes[SIMD_WIDTH];
+	vf_store(lanes, v);
+	float sum = 0.0f;
+	for (int i = 0; i < SIMD_WIDTH; i++) {
+		sum += lanes[i];
+	}
+	return sum;
+}
+
+void resample_process(resample_t *r, float *const *out, int out_frames) {
+	const int loaded = RESAMPLE_HISTORY + r->ahead + resample_needed(r, out_frames);
+	// Steps through the input without a division per frame
+	const int step = r->down / r->up;
+	const int step_phase = r->down % r->up;
+	int base = 0;
+	int phase = r->phase;
+	for (int j = 0; j < out_frames; j++) {
+		const float *filter = r->filters[phase];
+		for (int c = 0; c < r->channels; c++) {
+			const float *in = r->input[c] + base;
+			vf_t acc = vf_set1(0.0f);
+			for (int k = 0; k < RESAMPLE_TAPS; k += SIMD_WIDTH) {
+				acc = vf_add(acc, vf_mul(vf_load(in + k), vf_load(filter + k)));
+			}
+			out[c][j] = resample_sum(acc);
+		}
+		base += step;
+		phase += step_phase;
+		if (phase >= r->up) {
+			phase -= r->up;
+			base++;
+		}
+	}
+
+	// Keep what the next outputs still reach back to
+	const int consumed = base;
+	r->phase = phase;
+	for (int c = 0; c < r->channels; c++) {
+		memmove(r->input[c], r->input[c] + consumed, sizeof(float) * (size_t)(loaded - consumed));
+	}
+	r->ahead = loaded - consumed - RESAMPLE_HISTORY;
+}
@@ -0,0 +1,51 @@
+#ifndef TOWER4_RESAMPLE_H
+#define TOWER4_RESAMPLE_H
+
+#include <stdbool.h>
+
+#include "simd.h"
+
+// Polyphase resampler from a lower rate up to the device rate.
+//
+// The ratio is reduced to up / down (48000 / 22050 = 320 / 147): output
+// frame j lies j * down / up input frames in, and its fractional position
+// picks one of `up` windowed sinc filters computed at init. Every output
+// costs one RESAMPLE_TAPS dot product per channel, whatever the ratio.
+//
+// The caller pulls: it renders exactly resample_needed() input frames into
+// resample_input() for every channel, then resample_process() turns them
+// into output frames and keeps the history for the next call. The filter
+// delays the signal by RESAMPLE_TAPS / 2 input frames.
+
+#define RESAMPLE_TAPS 32
+/// Largest reduced `up`, bounds the filter table
+#define RESAMPLE_MAX_PHASES 512
+#define RESAMPLE_MAX_CHANNELS 2
+/// Output frames per resample_process()
+#define RESAMPLE_MAX_FRAMES 256
+
+typedef struct resample_t {
+	int in_rate;
+	int out_rate;
+	int up;
+	int down;
+	int channels;
+	int phase; /// of the next output frame, in 1/up input frames
+	int ahead; /// input frames loaded past the history
+
+	_Alignas(SIMD_ALIGN) float input[RESAMPLE_MAX_CHANNELS][RESAMPLE_TAPS + RESAMPLE_MAX_FRAMES + 1];
+	_Alignas(SIMD_ALIGN) float filters[RESAMPLE_MAX_PHASES][RESAMPLE_TAPS];
+} resample_t;
+
+/// Upsampling only, and the reduced ratio must fit the filter table.
+bool resample_supported(int in_rate, int out_rate);
+/// Computes the filters and clears the history, false if not supported.
+bool resample_init(resample_t *r, int in_rate, int out_rate, int channels);
+/// Input frames to load before producing out_frames (at most RESAMPLE_MAX_FRAMES).
+int resample_needed(const resample_t *r, int out_frames);
+/// Where the needed input frames of a channel go.
+float *resample_input(resample_t *r, int channel);
+/// Writes out_frames to out[channel] from the loaded input.
+void resample_process(resample_t *r, float *const *out, int out_frames);
+
+#endif
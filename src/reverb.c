@@ -0,0 +1,107 @@
+#include "reverb.h"
+
+#include <math.h>
+#include <string.h>
+
+#define REVERB_TUNING_RATE 44100.0f
+#define REVERB_BLOCK 256
+/// Keeps the recursive filters out of denormals once the input goes silent
+#define REVERB_ANTI_DENORMAL 1e-18f
+/// Eight combs with feedback near one add up to a lot of gain
+#define REVERB_INPUT_GAIN 0.03f
+
+static const uint32_t reverb_comb_tuning[REVERB_COMBS] = {1116, 1188, 1277, 1356, 1422, 1491, 1557, 1617};
+static const uint32_t reverb_allpass_tuning[REVERB_ALLPASSES] = {556, 441, 341, 225};
+
+void reverb_init(reverb_t *r, float sample_rate) {
+	memset(r, 0, sizeof(*r));
+	reverb_set(r, &(reverb_params_t){.size = 0.5f, .decay = 1.5f, .damping = 0.3f, .mix = 0.3f}, sample_rate);
+}
+
+static uint32_t reverb_delay(uint32_t tuning, float scale, uint32_t length) {
+	const float delay = (float)tuning * scale;
+	return delay < 1.0f ? 1 : delay > (float)(length - 1) ? length - 1 : (uint32_t)delay;
+}
+
+void reverb_set(reverb_t *r, const reverb_params_t *params, float sample_rate) {
+	const float scale = (0.25f + 1.75f * params->size) * sample_rate / REVERB_TUNING_RATE;
+	const float decay = params->decay > 0.01f ? params->decay : 0.01f;
+	for (int c = 0; c < REVERB_COMBS; c++) {
+		r->comb_delay[c] = reverb_delay(reverb_comb_tuning[c], scale, REVERB_COMB_LENGTH);
+		// -60 dB after decay seconds is decay * sample_rate / delay round trips
+		r->comb_feedback[c] = powf(10.0f, -3.0f * (float)r->comb_delay[c] / (decay * sample_rate));
+	}
+	for (int a = 0; a < REVERB_ALLPASSES; a++) {
+		r->allpass_delay[a] = reverb_delay(reverb_allpass_tuning[a], scale, REVERB_ALLPASS_LENGTH);
+	}
+	r->damping = params->damping;
+	r->wet = params->mix;
+	r->dry = 1.0f - params->mix;
+}
+
+// Line by line over the whole block keeps each line's state in registers
+static void reverb_chunk(reverb_t *r, float *x, int n) {
+	float input[REVERB_BLOCK];
+	float wet[REVERB_BLOCK];
+	for (int i = 0; i < n; i++) {
+		input[i] = x[i] * REVERB_INPUT_GAIN + REVERB_ANTI_DENORMAL;
+		wet[i] = 0.0f;
+	}
+
+	// Four combs per pass: their lowpass feedback chains are independent, so
+	// the CPU overlaps them instead of waiting on one at a time
+	const float damp = r->damping;
+	const uint32_t comb_mask = REVERB_COMB_LENGTH - 1;
+	for (int c = 0; c < REVERB_COMBS; c += 4) {
+		float *l0 = r->comb[c], *l1 = r->comb[c + 1], *l2 = r->comb[c + 2], *l3 = r->comb[c + 3];
+		const uint32_t d0 = r->comb_delay[c], d1 = r->comb_delay[c + 1], d2 = r->comb_delay[c + 2], d3 = r->comb_delay[c + 3];
+		const float g0 = r->comb_feedback[c], g1 = r->comb_feedback[c + 1], g2 = r->comb_feedback[c + 2], g3 = r->comb_feedback[c + 3];
+		float f0 = r->comb_filter[c], f1 = r->comb_filter[c + 1], f2 = r->comb_filter[c + 2], f3 = r->comb_filter[c + 3];
+		uint32_t pos = r->pos;
+		for (int i = 0; i < n; i++) {
+			const float y0 = l0[(pos - d0) & comb_mask];
+			const float y1 = l1[(pos - d1) & comb_mask];
+			const float y2 = l2[(pos - d2) & comb_mask];
+			const float y3 = l3[(pos - d3) & comb_mask];
+			f0 = y0 + (f0 - y0) * damp;
+			f1 = y1 + (f1 - y1) * damp;
+			f2 = y2 + (f2 - y2) * damp;
+			f3 = y3 + (f3 - y3) * damp;
+			const uint32_t w = pos & comb_mask;
+			l0[w] = input[i] + f0 * g0;
+			l1[w] = input[i] + f1 * g1;
+			l2[w] = input[i] + f2 * g2;
+			l3[w] = input[i] + f3 * g3;
+			wet[i] += (y0 + y1) + (y2 + y3);
+			pos++;
+		}
+		r->comb_filter[c] = f0;
+		r->comb_filter[c + 1] = f1;
+		r->comb_filter[c + 2] = f2;
+		r->comb_filter[c + 3] = f3;
+	}
+
+	const uint32_t allpass_mask = REVERB_ALLPASS_LENGTH - 1;
+	for (int a = 0; a < REVERB_ALLPASSES; a++) {
+		float *line = r->allpass[a];
+		const uint32_t delay = r->allpass_delay[a];
+		uint32_t pos = r->pos;
+		for (int i = 0; i < n; i++) {
+			const float y = line[(pos - delay) & allpass_mask];
+			line[pos & allpass_mask] = wet[i] + y * 0.5f;
+			wet[i] = y - wet[i];
+			pos++;
+		}
+	}
+
+	for (int i = 0; i < n; i++) {
+		x[i] = x[i] * r->dry + wet[i] * r->wet;
+	}
+	r->pos += (uint32_t)n;
+}
+
+void reverb_process(reverb_t *r, float *x, int n) {
+	for (int done = 0; done < n; done += REVERB_BLOCK) {
+		reverb_chunk(r, x + done, n - done < REVERB_BLOCK ? n - done : REVERB_BLOCK);
+	}
+}
@@ -0,0 +1,49 @@
+#ifndef TOWER4_REVERB_H
+#define TOWER4_REVERB_H
+
+#include <stdint.h>
+
+// Mono Freeverb style reverb.
+//
+// Eight parallel feedback combs with a one pole lowpass in the loop feed four
+// series allpasses. Every delay line is a power of two long and indexed with
+// a mask from one shared write position, so the cost per sample is fixed and
+// changing size only moves the read taps. Delays are the classic Freeverb
+// tunings scaled by size and sample rate; comb feedback is derived from the
+// delay so the tail falls 60 dB in `decay` seconds at any size or rate.
+
+#define REVERB_COMBS 8 /// multiple of 4
+#define REVERB_ALLPASSES 4
+/// Line lengths, enough for the largest size at 96 kHz
+#define REVERB_COMB_LENGTH 8192
+#define REVERB_ALLPASS_LENGTH 4096
+
+typedef struct reverb_params_t {
+	float size; /// 0 to 1, scales every delay
+	float decay; /// seconds to fall 60 dB
+	float damping; /// 0 to 1, high frequency loss per round trip
+	float mix; /// 0 dry to 1 wet
+} reverb_params_t;
+
+typedef struct reverb_t {
+	uint32_t comb_delay[REVERB_COMBS];
+	float comb_feedback[REVERB_COMBS];
+	float comb_filter[REVERB_COMBS]; /// lowpass state
+	uint32_t allpass_delay[REVERB_ALLPASSES];
+	float damping;
+	float wet;
+	float dry;
+	uint32_t pos; /// write position of every line
+
+	float comb[REVERB_COMBS][REVERB_COMB_LENGTH];
+	float allpass[REVERB_ALLPASSES][REVERB_ALLPASS_LENGTH];
+} reverb_t;
+
+/// Clears the lines and sets defaults.
+void reverb_init(reverb_t *r, float sample_rate);
+/// Cheap enough to call once per audio callback.
+void reverb_set(reverb_t *r, const reverb_params_t *params, float sample_rate);
+/// Processes a mono block in place.
+void reverb_process(reverb_t *r, float *x, int n);
+
+#endif
@@ -0,0 +1,56 @@
+#include "ring.h"
+
+#include <assert.h>
+#include <string.h>
+
+void ring_init(ring_t *r, float *memory, uint32_t capacity) {
+	assert(capacity > 0 && (capacity & (capacity - 1)) == 0);
+	r->data = memory;
+	r->capacity = capacity;
+	r->mask = capacity - 1;
+	atomic_init(&r->write, 0);
+	atomic_init(&r->read, 0);
+	atomic_init(&r->dropped, 0);
+}
+
+// Copies count samples between the ring at position pos and linear memory,
+// in up to two pieces when the range wraps
+static void ring_copy_in(ring_t *r, uint32_t pos, const float *src, uint32_t count) {
+	const uint32_t start = pos & r->mask;
+	const uint32_t first = count < r->capacity - start ? count : r->capacity - start;
+	memcpy(r->data + start, src, sizeof(float) * first);
+	memcpy(r->data, src + first, sizeof(float) * (count - first));
+}
+
+static void ring_copy_out(const ring_t *r, uint32_t pos, float *dst, uint32_t count) {
+	const uint32_t start = pos & r->mask;
+	const uint32_t first = count < r->capacity - start ? count : r->capacity - start;
+	memcpy(dst, r->data + start, sizeof(float) * first);
+	memcpy(dst + first, r->data, sizeof(float) * (count - first));
+}
+
+bool ring_write(ring_t *r, const float *samples, uint32_t count) {
+	const uint32_t write = atomic_load_explicit(&r->write, memory_order_relaxed);
+	const uint32_t read = atomic_load_explicit(&r->read, memory_order_acquire);
+	if (count > r->capacity - (write - read)) {
+		atomic_fetch_add_explicit(&r->dropped, 1, memory_order_relaxed);
+		return false;
+	}
+	ring_copy_in(r, write, samples, count);
+	atomic_store_explicit(&r->write, write + count, memory_order_release);
+	return true;
+}
+
+uint32_t ring_read(ring_t *r, float *out, uint32_t max) {
+	const uint32_t read = atomic_load_explicit(&r->read, memory_order_relaxed);
+	const uint32_t write = atomic_load_explicit(&r->write, memory_order_acquire);
+	const uint32_t available = write - read;
+	const uint32_t count = available < max ? available : max;
+	ring_copy_out(r, read, out, count);
+	atomic_store_explicit(&r->read, read + count, memory_order_release);
+	return count;
+}
+
+uint32_t ring_available(ring_t *r) {
+	return atomic_load_explicit(&r->write, memory_order_acquire) - atomic_load_explicit(&r->read, memory_order_relaxed);
+}
@@ -0,0 +1,40 @@
+#ifndef TOWER4_RING_H
+#define TOWER4_RING_H
+
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdint.h>
+
+// Wait-free single producer / single consumer ring of floats.
+//
+// Read and write positions are free running 32 bit counters on their own
+// cache lines, each written by one side only. The producer publishes samples
+// with a release store of the write position after copying them, the
+// consumer frees space with a release store of the read position after
+// copying them out, so neither side can observe a half written range.
+//
+// Writes are all or nothing: when a block doesn't fit it is dropped and
+// counted instead of waiting for the consumer, so the audio thread never
+// blocks on the UI.
+
+typedef struct ring_t {
+	float *data;
+	uint32_t capacity; /// power of two
+	uint32_t mask;
+
+	_Alignas(64) atomic_uint_least32_t write; /// producer only
+	_Alignas(64) atomic_uint_least32_t read; /// consumer only
+	_Alignas(64) atomic_uint_least32_t dropped; /// blocks that didn't fit
+} ring_t;
+
+/// capacity must be a power of two
+void ring_init(ring_t *r, float *memory, uint32_t capacity);
+
+/// Producer: copies all count samples or none, returns whether it did.
+bool ring_write(ring_t *r, const float *samples, uint32_t count);
+/// Consumer: copies up to max samples out, returns how many.
+uint32_t ring_read(ring_t *r, float *out, uint32_t max);
+/// Consumer: samples ready to read
+uint32_t ring_available(ring_t *r);
+
+#endif
@@ -0,0 +1,260 @@
+#include "sfx_cache.h"
+
+#include <stdio.h>
+#include <string.h>
+
+#ifdef ENABLE_IMGUI
+#define CIMGUI_DEFINE_ENUMS_AND_STRUCTS
+#include "cimgui.h"
+#endif
+
+#include "mem.h"
+
+// Fields that shape the samples, everything else applies at playback
+static void sfx_patch_fields(const mixer_sound_t *s, float *fields) {
+	fields[0] = (float)s->wave;
+	fields[1] = s->freq;
+	fields[2] = s->freq_end;
+	fields[3] = s->sweep;
+	fields[4] = s->noise;
+	fields[5] = s->attack;
+	fields[6] = s->decay;
+	fields[7] = s->sustain;
+	fields[8] = s->hold;
+	fields[9] = s->release;
+}
+
+#define SFX_PATCH_FIELDS 10
+
+static bool sfx_patch_equal(const mixer_sound_t *a, const mixer_sound_t *b) {
+	float fa[SFX_PATCH_FIELDS];
+	float fb[SFX_PATCH_FIELDS];
+	sfx_patch_fields(a, fa);
+	sfx_patch_fields(b, fb);
+	return memcmp(fa, fb, sizeof(fa)) == 0;
+}
+
+// FNV-1a over the patch fields and the sample rate
+static uint64_t sfx_patch_hash(const mixer_sound_t *s, float sample_rate) {
+	float fields[SFX_PATCH_FIELDS + 1];
+	sfx_patch_fields(s, fields);
+	fields[SFX_PATCH_FIELDS] = sample_rate;
+	const uint8_t *bytes = (const uint8_t *)fields;
+	uint64_t hash = 14695981039346656037ull;
+	for (size_t i = 0; i < sizeof(fields); i++) {
+		hash = (hash ^ bytes[i]) * 1099511628211ull;
+	}
+	return hash;
+}
+
+void sfx_cache_init(sfx_cache_t *c, size_t capacity, float sample_rate) {
+	memset(c, 0, sizeof(*c));
+	thread_mutex_init(&c->mutex);
+	c->pool = mem_alloc(MEM_TAG_SFX_CACHE, capacity);
+	c->capacity = c->pool ? capacity : 0;
+	c->sample_rate = sample_rate;
+	atomic_init(&c->jobs.pending, 0);
+	for (int i = 0; i < SFX_CACHE_ENTRIES; i++) {
+		atomic_init(&c->entries[i].state, SFX_ENTRY_EMPTY);
+		atomic_init(&c->entries[i].users, 0);
+	}
+}
+
+void sfx_cache_shutdown(sfx_cache_t *c) {
+	job_wait(&c->jobs);
+	mem_free(c->pool);
+	thread_mutex_destroy(&c->mutex);
+	c->pool = NULL;
+}
+
+static bool sfx_entry_evictable(sfx_entry_t *e) {
+	return atomic_load_explicit(&e->state, memory_order_relaxed) == SFX_ENTRY_READY &&
+		atomic_load_explicit(&e->users, memory_order_acquire) == 0;
+}
+
+static void sfx_cache_drop(sfx_cache_t *c, sfx_entry_t *e) {
+	c->used -= e->bytes;
+	e->bytes = 0;
+	e->key = 0;
+	atomic_store_explicit(&e->state, SFX_ENTRY_EMPTY, memory_order_relaxed);
+}
+
+// Frees the least recently played entry nobody is reading
+static bool sfx_cache_evict(sfx_cache_t *c) {
+	sfx_entry_t *victim = NULL;
+	for (int i = 0; i < SFX_CACHE_ENTRIES; i++) {
+		sfx_entry_t *e = &c->entries[i];
+		if (sfx_entry_evictable(e) && (!victim || e->last_used < victim->last_used)) {
+			victim = e;
+		}
+	}
+	if (!victim) {
+		return false;
+	}
+	sfx_cache_drop(c, victim);
+	c->evictions++;
+	return true;
+}
+
+// First fit between the entries holding memory, at most SFX_CACHE_ENTRIES
+// of them, so a sort per allocation is cheap
+static bool sfx_cache_reserve(sfx_cache_t *c, size_t bytes, size_t *offset) {
+	const sfx_entry_t *taken[SFX_CACHE_ENTRIES];
+	int count = 0;
+	for (int i = 0; i < SFX_CACHE_ENTRIES; i++) {
+		const sfx_entry_t *e = &c->entries[i];
+		if (e->bytes == 0) {
+			continue;
+		}
+		int j = count++;
+		while (j > 0 && taken[j - 1]->offset > e->offset) {
+			taken[j] = taken[j - 1];
+			j--;
+		}
+		taken[j] = e;
+	}
+	size_t start = 0;
+	for (int i = 0; i <= count; i++) {
+		const size_t end = i < count ? taken[i]->offset : c->capacity;
+		if (end - start >= bytes) {
+			*offset = start;
+			return true;
+		}
+		if (i < count) {
+			start = taken[i]->offset + taken[i]->bytes;
+		}
+	}
+	return false;
+}
+
+static void sfx_cache_render(void *arg, int begin, int end) {
+	(void)end;
+	sfx_cache_t *c = arg;
+	sfx_entry_t *e = &c->entries[begin];
+	float *samples = (float *)(c->pool + e->offset);
+	e->num_samples = mixer_render_sound(&e->patch, (uint32_t)e->key, samples, (int)(e->bytes / sizeof(float)), e->sample_rate);
+	atomic_store_explicit(&e->state, SFX_ENTRY_READY, memory_order_release);
+}
+
+static sfx_entry_t *sfx_cache_load_locked(sfx_cache_t *c, const mixer_sound_t *sound) {
+	const int frames = mixer_sound_frames(sound, c->sample_rate);
+	if (sound->samples || frames < 0 || frames > (int)(SFX_CACHE_MAX_SECONDS * c->sample_rate)) {
+		return NULL;
+	}
+	const uint64_t key = sfx_patch_hash(sound, c->sample_rate);
+	sfx_entry_t *slot = NULL;
+	for (int i = 0; i < SFX_CACHE_ENTRIES; i++) {
+		sfx_entry_t *e = &c->entries[i];
+		if (e->bytes > 0 && e->key == key && sfx_patch_equal(&e->patch, sound)) {
+			return e;
+		}
+		if (!slot && e->bytes == 0) {
+			slot = e;
+		}
+	}
+
+	const size_t bytes = ((size_t)frames * sizeof(float) + DSP_ALIGN - 1) & ~(size_t)(DSP_ALIGN - 1);
+	if (bytes > c->capacity) {
+		return NULL;
+	}
+	if (!slot) {
+		if (!sfx_cache_evict(c)) {
+			return NULL;
+		}
+		for (int i = 0; i < SFX_CACHE_ENTRIES && !slot; i++) {
+			slot = c->entries[i].bytes == 0 ? &c->entries[i] : NULL;
+		}
+	}
+	size_t offset = 0;
+	while (!sfx_cache_reserve(c, bytes, &offset)) {
+		if (!sfx_cache_evict(c)) {
+			return NULL;
+		}
+	}
+
+	slot->key = key;
+	slot->patch = *sound;
+	slot->sample_rate = c->sample_rate;
+	slot->offset = offset;
+	slot->bytes = bytes;
+	slot->num_samples = 0;
+	slot->last_used = ++c->clock;
+	atomic_store_explicit(&slot->state, SFX_ENTRY_RENDERING, memory_order_relaxed);
+	c->used += bytes;
+	job_run(&(job_desc_t){.fn = sfx_cache_render, .arg = c, .begin = (int)(slot - c->entries), .end = (int)(slot - c->entries) + 1},
+		1, &c->jobs);
+	return slot;
+}
+
+bool sfx_cache_load(sfx_cache_t *c, const mixer_sound_t *sound) {
+	thread_mutex_lock(&c->mutex);
+	const bool cached = sfx_cache_load_locked(c, sound) != NULL;
+	thread_mutex_unlock(&c->mutex);
+	return cached;
+}
+
+void sfx_cache_set_rate(sfx_cache_t *c, float sample_rate) {
+	thread_mutex_lock(&c->mutex);
+	if (sample_rate == c->sample_rate) {
+		thread_mutex_unlock(&c->mutex);
+		return;
+	}
+	c->sample_rate = sample_rate;
+	// The key includes the rate, so old entries never match again. Free the
+	// idle ones now; those still rendering or playing age out by LRU.
+	mixer_sound_t patches[SFX_CACHE_ENTRIES];
+	int count = 0;
+	for (int i = 0; i < SFX_CACHE_ENTRIES; i++) {
+		sfx_entry_t *e = &c->entries[i];
+		if (e->bytes > 0 && e->sample_rate != sample_rate) {
+			patches[count++] = e->patch;
+			if (sfx_entry_evictable(e)) {
+				sfx_cache_drop(c, e);
+			}
+		}
+	}
+	for (int i = 0; i < count; i++) {
+		sfx_cache_load_locked(c, &patches[i]);
+	}
+	thread_mutex_unlock(&c->mutex);
+}
+
+mixer_voice_t sfx_cache_play(sfx_cache_t *c, mixer_t *m, const mixer_sound_t *sound) {
+	thread_mutex_lock(&c->mutex);
+	sfx_entry_t *e = sfx_cache_load_locked(c, sound);
+	if (e) {
+		e->last_used = ++c->clock;
+	}
+	if (!e || atomic_load_explicit(&e->state, memory_order_acquire) != SFX_ENTRY_READY) {
+		c->misses++;
+		thread_mutex_unlock(&c->mutex);
+		return mixer_play(m, sound);
+	}
+	// Counted before unlocking so it can't be evicted under the voice
+	atomic_fetch_add_explicit(&e->users, 1, memory_order_relaxed);
+	mixer_sound_t cached = *sound;
+	cached.samples = (const float *)(c->pool + e->offset);
+	cached.num_samples = e->num_samples;
+	cached.users = &e->users;
+	c->hits++;
+	thread_mutex_unlock(&c->mutex);
+	return mixer_play(m, &cached);
+}
+
+#ifdef ENABLE_IMGUI
+void sfx_cache_ui(sfx_cache_t *c, bool *open) {
+	igBegin("Sound effects", open, ImGuiWindowFlags_None);
+	thread_mutex_lock(&c->mutex);
+	int entries = 0;
+	for (int i = 0; i < SFX_CACHE_ENTRIES; i++) {
+		entries += c->entries[i].bytes > 0;
+	}
+	char overlay[64];
+	snprintf(overlay, sizeof(overlay), "sfx cache %zu / %zu KiB", c->used / 1024, c->capacity / 1024);
+	igProgressBar(c->capacity ? (float)c->used / (float)c->capacity : 0.0f, (ImVec2){-1, 0}, overlay);
+	igText("Cached: %d, hits: %u, synthesized: %u, evicted: %u", entries, (unsigned)c->hits, (unsigned)c->misses,
+		(unsigned)c->evictions);
+	thread_mutex_unlock(&c->mutex);
+	igEnd();
+}
+#endif
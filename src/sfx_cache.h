@@ -0,0 +1,87 @@
+#ifndef TOWER4_SFX_CACHE_H
+#define TOWER4_SFX_CACHE_H
+
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "job.h"
+#include "mixer.h"
+#include "thread.h"
+
+// Pre-rendered sound effects.
+//
+// Sounds that end by themselves are deterministic patches: the same fields
+// always synthesize the same samples (noise included, seeded from the patch).
+// The cache renders each patch to mono PCM once on a job thread, keyed by a
+// hash of the fields that shape it, and plays it back through the mixer as a
+// plain buffer read; gain, pan, priority and emitters still apply per play.
+//
+// PCM lives in one block of `capacity` bytes allocated at init, so nothing is
+// allocated while the game runs. When a new patch doesn't fit, the least
+// recently played entries that no voice is reading are evicted. Until its
+// PCM is ready, or when it can't get memory, a patch is synthesized as usual.
+//
+// PCM only plays right at the rate it was rendered at. When the mixer's rate
+// changes (a new device, or the synth's internal rate) sfx_cache_set_rate()
+// drops the old PCM and renders every cached patch again at the new rate.
+//
+// The cache is locked, any thread but the audio thread may use it.
+
+#define SFX_CACHE_ENTRIES 64
+/// Longest patch worth caching
+#define SFX_CACHE_MAX_SECONDS 4.0f
+
+typedef enum sfx_entry_state_t {
+	SFX_ENTRY_EMPTY,
+	SFX_ENTRY_RENDERING,
+	SFX_ENTRY_READY,
+} sfx_entry_state_t;
+
+typedef struct sfx_entry_t {
+	uint64_t key;
+	mixer_sound_t patch; /// as loaded, to tell hash collisions apart
+	float sample_rate; /// of the samples
+	size_t offset; /// of the samples in the pool
+	size_t bytes; /// reserved, 0 when empty
+	int num_samples; /// rendered, set before state turns ready
+	atomic_int state;
+	atomic_int users; /// voices reading the samples
+	uint64_t last_used;
+} sfx_entry_t;
+
+typedef struct sfx_cache_t {
+	thread_mutex_t mutex;
+	uint8_t *pool;
+	size_t capacity;
+	size_t used;
+	float sample_rate;
+	uint64_t clock; /// for last_used
+	job_counter_t jobs;
+	sfx_entry_t entries[SFX_CACHE_ENTRIES];
+
+	uint32_t hits; /// played from PCM
+	uint32_t misses; /// synthesized
+	uint32_t evictions;
+} sfx_cache_t;
+
+/// capacity is in bytes, PCM is rendered at sample_rate.
+void sfx_cache_init(sfx_cache_t *c, size_t capacity, float sample_rate);
+/// Waits for rendering jobs, no voice may be playing from the cache.
+void sfx_cache_shutdown(sfx_cache_t *c);
+/// Re-renders everything for a mixer running at sample_rate, nothing
+/// happens when it didn't change.
+void sfx_cache_set_rate(sfx_cache_t *c, float sample_rate);
+
+/// Starts rendering a patch on a job thread unless it is cached or never
+/// ends. Returns false when it can't be cached.
+bool sfx_cache_load(sfx_cache_t *c, const mixer_sound_t *sound);
+/// Plays the sound from its PCM when ready, loads and synthesizes it otherwise.
+mixer_voice_t sfx_cache_play(sfx_cache_t *c, mixer_t *m, const mixer_sound_t *sound);
+
+#ifdef ENABLE_IMGUI
+void sfx_cache_ui(sfx_cache_t *c, bool *open);
+#endif
+
+#endif
@@ -1,4 +1,5 @@
 @ctype mat4 hmm_mat4
+@ctype vec4 hmm_vec4
 
 @vs vs
 uniform vs_params {
@@ -20,11 +21,20 @@ void main() {
 @end
 
 @fs fs
+// Spectrum band levels from 0 to 1, low to high (see spectrum.h)
+uniform fs_params {
+    vec4 bands_low;
+    vec4 bands_high;
+};
+
 in vec4 color;
 out vec4 frag_color;
 
 void main() {
-    frag_color = color;
+    // Bass pulses the brightness, treble tints blue, silence changes nothing
+    float bass = 0.5 * (bands_low.x + bands_low.y);
+    float treble = 0.5 * (bands_high.z + bands_high.w);
+    frag_color = vec4(color.rgb * (1.0 + 0.5 * bass) + vec3(0.0, 0.0, 0.25 * treble), color.a);
     //frag_color = vec4(1.0f, 0.0f, 0.0f, 0.0f);
 }
 @end
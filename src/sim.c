@@ -0,0 +1,129 @@
+#include "sim.h"
+
+#include <string.h>
+
+#include "sokol_time.h"
+
+#include "profiler.h"
+#include "thread.h"
+
+#define SIM_BUFFER_INDEX_MASK 3u
+/// Ticks to catch up before dropping time, e.g. after a debugger break
+#define SIM_MAX_CATCH_UP 5
+
+void sim_buffer_init(sim_buffer_t *b, void *slot0, void *slot1, void *slot2) {
+	memset(b, 0, sizeof(*b));
+	b->slots[0] = slot0;
+	b->slots[1] = slot1;
+	b->slots[2] = slot2;
+	b->front = 0;
+	b->back = 1;
+	atomic_init(&b->shared, 2);
+}
+
+void *sim_buffer_back(sim_buffer_t *b) {
+	return b->slots[b->back];
+}
+
+void sim_buffer_publish(sim_buffer_t *b) {
+	// Release makes the slot contents visible to whoever swaps it out
+	const unsigned prev = atomic_exchange_explicit(&b->shared, b->back | SIM_BUFFER_FRESH, memory_order_acq_rel);
+	b->back = prev & SIM_BUFFER_INDEX_MASK;
+}
+
+const void *sim_buffer_read(sim_buffer_t *b) {
+	if (atomic_load_explicit(&b->shared, memory_order_relaxed) & SIM_BUFFER_FRESH) {
+		const unsigned prev = atomic_exchange_explicit(&b->shared, b->front, memory_order_acq_rel);
+		b->front = prev & SIM_BUFFER_INDEX_MASK;
+	}
+	return b->slots[b->front];
+}
+
+static struct {
+	sim_desc_t desc;
+	uint64_t tick_ticks; /// sokol_time ticks per simulation tick
+	double dt;
+
+	thread_t thread;
+	bool threaded;
+	atomic_bool running;
+	atomic_uint_least64_t ticks;
+
+	double accumulator; /// inline mode only
+} sim;
+
+static void sim_tick(void) {
+	PROF_ZONE_BEGIN(simulation);
+	sim.desc.tick(sim.desc.userdata, sim.dt);
+	PROF_ZONE_END(simulation);
+	atomic_fetch_add_explicit(&sim.ticks, 1, memory_order_relaxed);
+}
+
+static void sim_thread_main(void *arg) {
+	(void)arg;
+	uint64_t next = stm_now();
+	while (atomic_load_explicit(&sim.running, memory_order_acquire)) {
+		const uint64_t now = stm_now();
+		if (now >= next) {
+			sim_tick();
+			next += sim.tick_ticks;
+			if (now > next + SIM_MAX_CATCH_UP * sim.tick_ticks) {
+				next = now;
+			}
+			continue;
+		}
+
+		// Sleep most of the wait away, yield through the last millisecond
+		const double wait_ms = stm_ms(next - now);
+		if (wait_ms > 2.0) {
+			thread_sleep_ms((int)wait_ms - 1);
+		} else {
+			thread_yield();
+		}
+	}
+	prof_shutdown();
+}
+
+void sim_start(const sim_desc_t *desc) {
+	memset(&sim, 0, sizeof(sim));
+	sim.desc = *desc;
+	if (sim.desc.tick_rate <= 0) {
+		sim.desc.tick_rate = 60;
+	}
+	sim.dt = 1.0 / sim.desc.tick_rate;
+	// sokol_time ticks are nanoseconds on every platform
+	sim.tick_ticks = 1000000000ull / (uint64_t)sim.desc.tick_rate;
+
+	atomic_store(&sim.running, true);
+	sim.threaded = thread_start(&sim.thread, sim_thread_main, NULL);
+}
+
+void sim_stop(void) {
+	atomic_store(&sim.running, false);
+	if (sim.threaded) {
+		thread_join(&sim.thread);
+		sim.threaded = false;
+	}
+}
+
+void sim_update(double frame_dt) {
+	if (sim.threaded || !atomic_load_explicit(&sim.running, memory_order_relaxed)) {
+		return;
+	}
+	sim.accumulator += frame_dt;
+	if (sim.accumulator > SIM_MAX_CATCH_UP * sim.dt) {
+		sim.accumulator = SIM_MAX_CATCH_UP * sim.dt;
+	}
+	while (sim.accumulator >= sim.dt) {
+		sim_tick();
+		sim.accumulator -= sim.dt;
+	}
+}
+
+bool sim_threaded(void) {
+	return sim.threaded;
+}
+
+uint64_t sim_tick_count(void) {
+	return atomic_load_explicit(&sim.ticks, memory_order_relaxed);
+}
@@ -0,0 +1,59 @@
+#ifndef TOWER4_SIM_H
+#define TOWER4_SIM_H
+
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdint.h>
+
+// Fixed rate simulation thread and lock-free snapshot handoff.
+//
+// The game ticks on its own thread at a fixed rate while the main thread
+// renders. Data crosses between them through sim_buffer_t, a triple buffer:
+// the writer always has a private slot to fill, the reader always has a
+// private slot to read, and the third slot is swapped in and out with one
+// atomic exchange. Neither side ever waits for the other; the reader simply
+// keeps its current slot when nothing new was published.
+//
+// Without thread support (web builds) sim_update() runs the due ticks
+// inline at the start of the frame instead.
+
+#define SIM_BUFFER_FRESH 4u
+
+typedef struct sim_buffer_t {
+	void *slots[3];
+
+	// Index of the shared slot, SIM_BUFFER_FRESH set while it is unread
+	_Alignas(64) atomic_uint shared;
+	_Alignas(64) unsigned back; /// writer only
+	_Alignas(64) unsigned front; /// reader only
+} sim_buffer_t;
+
+/// The three slots must be the same size. Slot 0 starts as the reader's.
+void sim_buffer_init(sim_buffer_t *b, void *slot0, void *slot1, void *slot2);
+/// Slot the writer may fill, stays valid until sim_buffer_publish().
+void *sim_buffer_back(sim_buffer_t *b);
+void sim_buffer_publish(sim_buffer_t *b);
+/// Latest published slot, or the previous one if nothing new arrived. Stays
+/// valid until the next call.
+const void *sim_buffer_read(sim_buffer_t *b);
+
+typedef void (*sim_tick_fn)(void *userdata, double dt);
+
+typedef struct sim_desc_t {
+	sim_tick_fn tick;
+	void *userdata;
+	int tick_rate; /// ticks per second, 0 picks 60
+} sim_desc_t;
+
+/// Starts ticking on a new thread, falls back to sim_update() if threads are
+/// unavailable. Must be called after stm_setup().
+void sim_start(const sim_desc_t *desc);
+/// Stops and joins the thread, no tick runs after this returns.
+void sim_stop(void);
+/// Called once per frame by the main thread, runs due ticks when inline.
+void sim_update(double frame_dt);
+bool sim_threaded(void);
+/// Ticks run so far
+uint64_t sim_tick_count(void);
+
+#endif
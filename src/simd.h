@@ -0,0 +1,146 @@
+#ifndef TOWER4_SIMD_H
+#define TOWER4_SIMD_H
+
+#include <stdint.h>
+
+// Thin float/int vector wrappers so block kernels are written once.
+//
+// Picks the widest instruction set the compiler targets: AVX2 (ENABLE_AVX2),
+// SSE2 (every x86-64), WASM SIMD (-msimd128, see CMakeLists.txt) or plain
+// scalars of width 1. Loads and stores are unaligned; buffers aligned to
+// SIMD_ALIGN never split a cache line and run at full speed.
+//
+// Kernels loop `for (; i + SIMD_WIDTH <= n; i += SIMD_WIDTH)` and finish the
+// remainder with scalar code.
+
+#define SIMD_ALIGN 32
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#define SIMD_NAME "avx2"
+#define SIMD_WIDTH 8
+typedef __m256 vf_t;
+typedef __m256i vi_t;
+
+static inline vf_t vf_load(const float *p) { return _mm256_loadu_ps(p); }
+static inline void vf_store(float *p, vf_t v) { _mm256_storeu_ps(p, v); }
+static inline vf_t vf_set1(float x) { return _mm256_set1_ps(x); }
+static inline vf_t vf_add(vf_t a, vf_t b) { return _mm256_add_ps(a, b); }
+static inline vf_t vf_sub(vf_t a, vf_t b) { return _mm256_sub_ps(a, b); }
+static inline vf_t vf_mul(vf_t a, vf_t b) { return _mm256_mul_ps(a, b); }
+static inline vf_t vf_div(vf_t a, vf_t b) { return _mm256_div_ps(a, b); }
+static inline vf_t vf_sqrt(vf_t a) { return _mm256_sqrt_ps(a); }
+static inline vf_t vf_min(vf_t a, vf_t b) { return _mm256_min_ps(a, b); }
+static inline vf_t vf_max(vf_t a, vf_t b) { return _mm256_max_ps(a, b); }
+static inline vf_t vf_floor(vf_t a) { return _mm256_floor_ps(a); }
+static inline vi_t vf_to_vi(vf_t a) { return _mm256_cvttps_epi32(a); }
+static inline vf_t vi_to_vf(vi_t a) { return _mm256_cvtepi32_ps(a); }
+static inline vi_t vi_set1(int32_t x) { return _mm256_set1_epi32(x); }
+/// base, base + step, base + 2 * step, ...
+static inline vi_t vi_ramp(uint32_t base, uint32_t step) {
+	return _mm256_setr_epi32((int32_t)base, (int32_t)(base + step), (int32_t)(base + 2 * step), (int32_t)(base + 3 * step),
+		(int32_t)(base + 4 * step), (int32_t)(base + 5 * step), (int32_t)(base + 6 * step), (int32_t)(base + 7 * step));
+}
+static inline vi_t vi_add(vi_t a, vi_t b) { return _mm256_add_epi32(a, b); }
+static inline vi_t vi_and(vi_t a, vi_t b) { return _mm256_and_si256(a, b); }
+#define vi_srl(a, bits) _mm256_srli_epi32((a), (bits))
+static inline vf_t vf_gather(const float *table, vi_t index) { return _mm256_i32gather_ps(table, index, 4); }
+
+#elif defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#define SIMD_NAME "sse2"
+#define SIMD_WIDTH 4
+typedef __m128 vf_t;
+typedef __m128i vi_t;
+
+static inline vf_t vf_load(const float *p) { return _mm_loadu_ps(p); }
+static inline void vf_store(float *p, vf_t v) { _mm_storeu_ps(p, v); }
+static inline vf_t vf_set1(float x) { return _mm_set1_ps(x); }
+static inline vf_t vf_add(vf_t a, vf_t b) { return _mm_add_ps(a, b); }
+static inline vf_t vf_sub(vf_t a, vf_t b) { return _mm_sub_ps(a, b); }
+static inline vf_t vf_mul(vf_t a, vf_t b) { return _mm_mul_ps(a, b); }
+static inline vf_t vf_div(vf_t a, vf_t b) { return _mm_div_ps(a, b); }
+static inline vf_t vf_sqrt(vf_t a) { return _mm_sqrt_ps(a); }
+static inline vf_t vf_min(vf_t a, vf_t b) { return _mm_min_ps(a, b); }
+static inline vf_t vf_max(vf_t a, vf_t b) { return _mm_max_ps(a, b); }
+static inline vi_t vf_to_vi(vf_t a) { return _mm_cvttps_epi32(a); }
+static inline vf_t vi_to_vf(vi_t a) { return _mm_cvtepi32_ps(a); }
+static inline vf_t vf_floor(vf_t a) {
+	// SSE2 has no floor: truncate, then step down where that rounded up
+	const vf_t t = vi_to_vf(vf_to_vi(a));
+	return _mm_sub_ps(t, _mm_and_ps(_mm_cmpgt_ps(t, a), _mm_set1_ps(1.0f)));
+}
+static inline vi_t vi_set1(int32_t x) { return _mm_set1_epi32(x); }
+static inline vi_t vi_ramp(uint32_t base, uint32_t step) {
+	return _mm_setr_epi32((int32_t)base, (int32_t)(base + step), (int32_t)(base + 2 * step), (int32_t)(base + 3 * step));
+}
+static inline vi_t vi_add(vi_t a, vi_t b) { return _mm_add_epi32(a, b); }
+static inline vi_t vi_and(vi_t a, vi_t b) { return _mm_and_si128(a, b); }
+#define vi_srl(a, bits) _mm_srli_epi32((a), (bits))
+static inline vf_t vf_gather(const float *table, vi_t index) {
+	_Alignas(16) int32_t i[4];
+	_mm_store_si128((__m128i*)i, index);
+	return _mm_setr_ps(table[i[0]], table[i[1]], table[i[2]], table[i[3]]);
+}
+
+#elif defined(__wasm_simd128__)
+#include <wasm_simd128.h>
+#define SIMD_NAME "wasm simd128"
+#define SIMD_WIDTH 4
+typedef v128_t vf_t;
+typedef v128_t vi_t;
+
+static inline vf_t vf_load(const float *p) { return wasm_v128_load(p); }
+static inline void vf_store(float *p, vf_t v) { wasm_v128_store(p, v); }
+static inline vf_t vf_set1(float x) { return wasm_f32x4_splat(x); }
+static inline vf_t vf_add(vf_t a, vf_t b) { return wasm_f32x4_add(a, b); }
+static inline vf_t vf_sub(vf_t a, vf_t b) { return wasm_f32x4_sub(a, b); }
+static inline vf_t vf_mul(vf_t a, vf_t b) { return wasm_f32x4_mul(a, b); }
+static inline vf_t vf_div(vf_t a, vf_t b) { return wasm_f32x4_div(a, b); }
+static inline vf_t vf_sqrt(vf_t a) { return wasm_f32x4_sqrt(a); }
+static inline vf_t vf_min(vf_t a, vf_t b) { return wasm_f32x4_pmin(a, b); }
+static inline vf_t vf_max(vf_t a, vf_t b) { return wasm_f32x4_pmax(a, b); }
+static inline vf_t vf_floor(vf_t a) { return wasm_f32x4_floor(a); }
+static inline vi_t vf_to_vi(vf_t a) { return wasm_i32x4_trunc_sat_f32x4(a); }
+static inline vf_t vi_to_vf(vi_t a) { return wasm_f32x4_convert_i32x4(a); }
+static inline vi_t vi_set1(int32_t x) { return wasm_i32x4_splat(x); }
+static inline vi_t vi_ramp(uint32_t base, uint32_t step) {
+	return wasm_i32x4_make((int32_t)base, (int32_t)(base + step), (int32_t)(base + 2 * step), (int32_t)(base + 3 * step));
+}
+static inline vi_t vi_add(vi_t a, vi_t b) { return wasm_i32x4_add(a, b); }
+static inline vi_t vi_and(vi_t a, vi_t b) { return wasm_v128_and(a, b); }
+#define vi_srl(a, bits) wasm_u32x4_shr((a), (bits))
+static inline vf_t vf_gather(const float *table, vi_t index) {
+	return wasm_f32x4_make(table[wasm_i32x4_extract_lane(index, 0)], table[wasm_i32x4_extract_lane(index, 1)],
+		table[wasm_i32x4_extract_lane(index, 2)], table[wasm_i32x4_extract_lane(index, 3)]);
+}
+
+#else
+#include <math.h>
+#define SIMD_NAME "scalar"
+#define SIMD_WIDTH 1
+typedef float vf_t;
+typedef int32_t vi_t;
+
+static inline vf_t vf_load(const float *p) { return *p; }
+static inline void vf_store(float *p, vf_t v) { *p = v; }
+static inline vf_t vf_set1(float x) { return x; }
+static inline vf_t vf_add(vf_t a, vf_t b) { return a + b; }
+static inline vf_t vf_sub(vf_t a, vf_t b) { return a - b; }
+static inline vf_t vf_mul(vf_t a, vf_t b) { return a * b; }
+static inline vf_t vf_div(vf_t a, vf_t b) { return a / b; }
+static inline vf_t vf_sqrt(vf_t a) { return sqrtf(a); }
+static inline vf_t vf_min(vf_t a, vf_t b) { return a < b ? a : b; }
+static inline vf_t vf_max(vf_t a, vf_t b) { return a > b ? a : b; }
+static inline vf_t vf_floor(vf_t a) { return floorf(a); }
+static inline vi_t vf_to_vi(vf_t a) { return (vi_t)a; }
+static inline vf_t vi_to_vf(vi_t a) { return (vf_t)a; }
+static inline vi_t vi_set1(int32_t x) { return x; }
+static inline vi_t vi_ramp(uint32_t base, uint32_t step) { (void)step; return (vi_t)base; }
+static inline vi_t vi_add(vi_t a, vi_t b) { return (vi_t)((uint32_t)a + (uint32_t)b); }
+static inline vi_t vi_and(vi_t a, vi_t b) { return a & b; }
+#define vi_srl(a, bits) ((vi_t)((uint32_t)(a) >> (bits)))
+static inline vf_t vf_gather(const float *table, vi_t index) { return table[index]; }
+#endif
+
+#endif
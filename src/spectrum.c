@@ -0,0 +1,107 @@
+#include "spectrum.h"
+
+#include <math.h>
+#include <string.h>
+
+#ifdef ENABLE_IMGUI
+#define CIMGUI_DEFINE_ENUMS_AND_STRUCTS
+#include "cimgui.h"
+#endif
+
+#include "sokol_time.h"
+#include "profiler.h"
+
+/// Power a full scale sine leaves in its band through the Hann window: the
+/// peak bin holds (size / 4)^2, its two neighbours a quarter of that each
+#define SPECTRUM_FULL_SCALE (1.5f * (SPECTRUM_SIZE / 4.0f) * (SPECTRUM_SIZE / 4.0f))
+
+void spectrum_init(spectrum_t *s) {
+	memset(s, 0, sizeof(*s));
+	atomic_init(&s->job.pending, 0);
+	ring_init(&s->ring, s->ring_memory, SPECTRUM_RING);
+	fft_init(&s->fft, SPECTRUM_SIZE);
+	for (int i = 0; i < SPECTRUM_SIZE; i++) {
+		s->window[i] = (float)(0.5 - 0.5 * cos(2.0 * M_PI * i / SPECTRUM_SIZE));
+	}
+}
+
+void spectrum_shutdown(spectrum_t *s) {
+	job_wait(&s->job);
+}
+
+static void spectrum_analyze(void *arg, int begin, int end) {
+	(void)begin;
+	(void)end;
+	spectrum_t *s = arg;
+	PROF_ZONE_BEGIN(fft);
+	const uint64_t start = stm_now();
+
+	// Whatever arrived since last time, only the newest samples stay
+	uint32_t n;
+	while ((n = ring_read(&s->ring, s->history + s->history_pos, (uint32_t)(SPECTRUM_SIZE - s->history_pos))) > 0) {
+		s->history_pos = (s->history_pos + (int)n) & (SPECTRUM_SIZE - 1);
+	}
+	float *frame = s->frame;
+	const int tail = SPECTRUM_SIZE - s->history_pos;
+	memcpy(frame, s->history + s->history_pos, sizeof(float) * (size_t)tail);
+	memcpy(frame + tail, s->history, sizeof(float) * (size_t)s->history_pos);
+	for (int i = 0; i < SPECTRUM_SIZE; i++) {
+		frame[i] *= s->window[i];
+	}
+	fft_real(&s->fft, frame, s->re, s->im);
+
+	const float bin_hz = (float)s->sample_rate / SPECTRUM_SIZE;
+	for (int b = 0; b < SPECTRUM_BANDS; b++) {
+		const int lo = (int)(s->edges[b] / bin_hz + 0.5f);
+		int hi = (int)(s->edges[b + 1] / bin_hz + 0.5f);
+		hi = hi > lo ? hi : lo + 1;
+		hi = hi < SPECTRUM_SIZE / 2 + 1 ? hi : SPECTRUM_SIZE / 2 + 1;
+		float sum = 0.0f;
+		for (int k = lo; k < hi; k++) {
+			sum += s->re[k] * s->re[k] + s->im[k] * s->im[k];
+		}
+		const float db = sum > 0.0f ? 10.0f * log10f(sum / SPECTRUM_FULL_SCALE) : SPECTRUM_FLOOR_DB;
+		const float level = 1.0f - db / SPECTRUM_FLOOR_DB;
+		s->levels[b] = level < 0.0f ? 0.0f : level > 1.0f ? 1.0f : level;
+	}
+
+	s->ticks = stm_since(start);
+	PROF_ZONE_END(fft);
+}
+
+void spectrum_update(spectrum_t *s, int sample_rate, float dt) {
+	// Finished long ago, it only had a frame's worth of samples
+	job_wait(&s->job);
+	s->fft_ticks = s->ticks;
+	const float release = 1.0f - expf(-dt / SPECTRUM_RELEASE);
+	for (int b = 0; b < SPECTRUM_BANDS; b++) {
+		const float level = s->levels[b];
+		s->bands[b] = level > s->bands[b] ? level : s->bands[b] + (level - s->bands[b]) * release;
+	}
+	if (sample_rate <= 0) {
+		return;
+	}
+
+	if (sample_rate != s->sample_rate) {
+		s->sample_rate = sample_rate;
+		const float nyquist = 0.5f * (float)sample_rate;
+		const float high = SPECTRUM_HIGH_HZ < nyquist ? SPECTRUM_HIGH_HZ : nyquist;
+		for (int b = 0; b <= SPECTRUM_BANDS; b++) {
+			s->edges[b] = SPECTRUM_LOW_HZ * powf(high / SPECTRUM_LOW_HZ, (float)b / SPECTRUM_BANDS);
+		}
+	}
+	job_run(&(job_desc_t){.fn = spectrum_analyze, .arg = s, .begin = 0, .end = 1}, 1, &s->job);
+}
+
+#ifdef ENABLE_IMGUI
+void spectrum_ui(spectrum_t *s, bool *open) {
+	igBegin("Spectrum", open, ImGuiWindowFlags_None);
+	igPlotHistogramFloatPtr("##bands", s->bands, SPECTRUM_BANDS, 0, NULL, 0.0f, 1.0f, (ImVec2){-1, 120}, sizeof(float));
+	for (int b = 0; b < SPECTRUM_BANDS; b++) {
+		igText("%5.0f - %5.0f Hz %5.1f dB", s->edges[b], s->edges[b + 1], (1.0f - s->bands[b]) * SPECTRUM_FLOOR_DB);
+	}
+	igText("FFT %d: %.1f us, dropped blocks: %u", SPECTRUM_SIZE, stm_us(s->fft_ticks),
+		(unsigned)atomic_load_explicit(&s->ring.dropped, memory_order_relaxed));
+	igEnd();
+}
+#endif
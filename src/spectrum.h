@@ -0,0 +1,67 @@
+#ifndef TOWER4_SPECTRUM_H
+#define TOWER4_SPECTRUM_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "fft.h"
+#include "job.h"
+#include "ring.h"
+
+// Spectrum analyzer of the audio output.
+//
+// The audio thread only copies its mono mix into `ring` (see synth.tap).
+// Once per frame spectrum_update() collects the last analysis and queues
+// the next one as a job: it drains the ring into a history of the newest
+// SPECTRUM_SIZE samples, applies a Hann window, runs the FFT (profiler zone
+// "fft") and sums the power into SPECTRUM_BANDS log spaced bands. The main
+// thread smooths the bands with a fast attack and a slow release and hands
+// them to the UI and to the shapes shader.
+
+#define SPECTRUM_SIZE 2048
+#define SPECTRUM_BANDS 8
+/// Samples waiting for the next analysis, power of two. A few frames' worth.
+#define SPECTRUM_RING 8192
+#define SPECTRUM_LOW_HZ 40.0f
+#define SPECTRUM_HIGH_HZ 16000.0f
+/// Band level shown as 0, full scale is 1
+#define SPECTRUM_FLOOR_DB -60.0f
+/// Seconds for a band to fall most of the way back
+#define SPECTRUM_RELEASE 0.25f
+
+typedef struct spectrum_t {
+	// Main thread
+	job_counter_t job;
+	int sample_rate; /// of the analysis in flight
+	float bands[SPECTRUM_BANDS]; /// 0 to 1, smoothed
+	float edges[SPECTRUM_BANDS + 1]; /// Hz
+	uint64_t fft_ticks; /// cost of the last analysis
+
+	// Audio thread -> job
+	ring_t ring;
+	float ring_memory[SPECTRUM_RING];
+
+	// Job, handed over by job_run() and job_wait()
+	fft_t fft;
+	float window[SPECTRUM_SIZE];
+	float history[SPECTRUM_SIZE]; /// circular, oldest sample at history_pos
+	int history_pos;
+	float frame[SPECTRUM_SIZE]; /// windowed
+	float re[SPECTRUM_SIZE / 2 + 1];
+	float im[SPECTRUM_SIZE / 2 + 1];
+	float levels[SPECTRUM_BANDS]; /// of the last analysis
+	uint64_t ticks;
+} spectrum_t;
+
+void spectrum_init(spectrum_t *s);
+/// Waits for the analysis in flight.
+void spectrum_shutdown(spectrum_t *s);
+/// Main thread, once per frame: smooths in the last analysis over dt
+/// seconds and starts the next for audio at sample_rate.
+void spectrum_update(spectrum_t *s, int sample_rate, float dt);
+
+#ifdef ENABLE_IMGUI
+void spectrum_ui(spectrum_t *s, bool *open);
+#endif
+
+#endif
@@ -0,0 +1,263 @@
+#include "synth.h"
+
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+
+#ifdef ENABLE_IMGUI
+#define CIMGUI_DEFINE_ENUMS_AND_STRUCTS
+#include "cimgui.h"
+#endif
+
+#include "sokol_audio.h"
+
+#include "dsp.h"
+#include "profiler.h"
+
+static void synth_param_values(const synth_params_t *params, float *values) {
+	values[SYNTH_PARAM_GATE] = params->playing ? 1.0f : 0.0f;
+	values[SYNTH_PARAM_AMPLITUDE] = params->amplitude;
+	values[SYNTH_PARAM_END_AMPLITUDE] = params->end_amplitude;
+	values[SYNTH_PARAM_MFREQ] = params->mfreq;
+	values[SYNTH_PARAM_FREQFREQ] = params->freqfreq;
+	values[SYNTH_PARAM_LFO_WAVE] = (float)params->lfo_wave;
+	values[SYNTH_PARAM_REVERB_SIZE] = params->reverb.size;
+	values[SYNTH_PARAM_REVERB_DECAY] = params->reverb.decay;
+	values[SYNTH_PARAM_REVERB_DAMPING] = params->reverb.damping;
+	values[SYNTH_PARAM_REVERB_MIX] = params->reverb.mix;
+}
+
+int synth_dsp_rate(const synth_t *s, int device_rate) {
+	const int internal = s->internal_rate;
+	return internal > 0 && internal < device_rate && resample_supported(internal, device_rate) ? internal : device_rate;
+}
+
+// Rate dependent state that the DSP doesn't pick up on its own every block
+static void synth_set_device_rate(synth_t *s, int device_rate) {
+	s->device_rate = device_rate;
+	s->sample_rate = synth_dsp_rate(s, device_rate);
+	s->resampling = s->sample_rate != device_rate && resample_init(&s->resample, s->sample_rate, device_rate, 2);
+}
+
+void synth_init(synth_t *s, int sample_rate, int internal_rate) {
+	memset(s, 0, sizeof(*s));
+	osc_tables_init();
+	osc_init(&s->lfo, OSC_SINE, OSC_LINEAR);
+	s->params = (synth_params_t){
+		.playing = false,
+		.amplitude = 0.5f,
+		.end_amplitude = 0.5f,
+		.mfreq = 40.0f,
+		.freqfreq = 1.5f,
+		.reverb = {
+			.size = 0.5f,
+			.decay = 1.5f,
+			.damping = 0.3f,
+			.mix = 0.3f,
+		},
+	};
+	s->internal_rate = internal_rate;
+	synth_set_device_rate(s, sample_rate > 0 ? sample_rate : 44100);
+	reverb_init(&s->reverb, (float)s->sample_rate);
+	mixer_init(&s->mixer);
+	tracker_init(&s->tracker);
+	ring_init(&s->scope_ring, s->scope_ring_memory, SYNTH_SCOPE_RING);
+	float initial[SYNTH_PARAM_NUM];
+	synth_param_values(&s->params, initial);
+	param_bank_init(&s->bank, initial, SYNTH_PARAM_NUM, s->sample_rate);
+}
+
+void synth_publish(synth_t *s) {
+	float values[SYNTH_PARAM_NUM];
+	synth_param_values(&s->params, values);
+	for (int i = 0; i < SYNTH_PARAM_NUM; i++) {
+		param_set(&s->bank, i, values[i], i == SYNTH_PARAM_LFO_WAVE ? 0.0f : SYNTH_SMOOTHING);
+	}
+}
+
+// Renders at the DSP rate, any length
+static void synth_render_dsp(synth_t *s, float *left, float *right, int num_frames) {
+	_Alignas(DSP_ALIGN) float mono[SYNTH_BLOCK];
+	_Alignas(DSP_ALIGN) float phase[SYNTH_BLOCK];
+	_Alignas(DSP_ALIGN) float gate[SYNTH_BLOCK];
+	_Alignas(DSP_ALIGN) float amplitude[SYNTH_BLOCK];
+	_Alignas(DSP_ALIGN) float end_amplitude[SYNTH_BLOCK];
+	_Alignas(DSP_ALIGN) float mfreq[SYNTH_BLOCK];
+	param_t *p = s->bank.params;
+
+	for (int block = 0; block < num_frames; block += SYNTH_BLOCK) {
+		const int n = num_frames - block < SYNTH_BLOCK ? num_frames - block : SYNTH_BLOCK;
+
+		// Audio rate parameters sample by sample, split where events start
+		for (int done = 0; done < n;) {
+			const int k = param_bank_next(&s->bank, n - done);
+			param_render(&p[SYNTH_PARAM_GATE], gate + done, k);
+			param_render(&p[SYNTH_PARAM_AMPLITUDE], amplitude + done, k);
+			param_render(&p[SYNTH_PARAM_END_AMPLITUDE], end_amplitude + done, k);
+			param_render(&p[SYNTH_PARAM_MFREQ], mfreq + done, k);
+			for (int i = SYNTH_PARAM_FREQFREQ; i < SYNTH_PARAM_NUM; i++) {
+				param_advance(&p[i], k);
+			}
+			done += k;
+		}
+		s->lfo.wave = (osc_wave_t)p[SYNTH_PARAM_LFO_WAVE].value;
+		osc_set_freq(&s->lfo, p[SYNTH_PARAM_FREQFREQ].value / (2.0f * (float)M_PI), (float)s->sample_rate);
+		reverb_set(&s->reverb, &(reverb_params_t){
+			.size = p[SYNTH_PARAM_REVERB_SIZE].value,
+			.decay = p[SYNTH_PARAM_REVERB_DECAY].value,
+			.damping = p[SYNTH_PARAM_REVERB_DAMPING].value,
+			.mix = p[SYNTH_PARAM_REVERB_MIX].value,
+		}, (float)s->sample_rate);
+
+		if (gate[0] > 0.0f || gate[n - 1] > 0.0f) {
+			// The modulator sweeps the phase of a sine by up to mfreq cycles
+			osc_process(&s->lfo, phase, n);
+			dsp_mul(phase, mfreq, n);
+			// A sine lfo moves by at most 2 pi lfo_freq = freqfreq cycles a second
+			const float depth = fmaxf(fabsf(mfreq[0]), fabsf(mfreq[n - 1]));
+			osc_lookup(OSC_SINE, phase, mono, n, depth * p[SYNTH_PARAM_FREQFREQ].value / (float)s->sample_rate);
+
+			dsp_mul(mono, amplitude, n);
+			dsp_clamp(mono, -INFINITY, 0.5f, n);
+			dsp_mul(end_amplitude, gate, n);
+			dsp_mul(mono, end_amplitude, n);
+		} else {
+			memset(mono, 0, sizeof(float) * (size_t)n);
+		}
+		// Also runs while stopped so the tail rings out
+		reverb_process(&s->reverb, mono, n);
+
+		memcpy(left + block, mono, sizeof(float) * (size_t)n);
+		memcpy(right + block, mono, sizeof(float) * (size_t)n);
+		tracker_render(&s->tracker, &s->mixer, n, (float)s->sample_rate);
+		mixer_render(&s->mixer, left + block, right + block, n, (float)s->sample_rate);
+	}
+}
+
+void synth_render(synth_t *s, float *buffer, int num_frames, int num_channels) {
+	PROF_ZONE_BEGIN(synth);
+	_Alignas(DSP_ALIGN) float mono[SYNTH_BLOCK];
+	_Alignas(DSP_ALIGN) float left[SYNTH_BLOCK];
+	_Alignas(DSP_ALIGN) float right[SYNTH_BLOCK];
+	param_bank_begin(&s->bank, s->sample_rate);
+
+	for (int block = 0; block < num_frames; block += SYNTH_BLOCK) {
+		const int n = num_frames - block < SYNTH_BLOCK ? num_frames - block : SYNTH_BLOCK;
+		if (s->resampling) {
+			const int needed = resample_needed(&s->resample, n);
+			synth_render_dsp(s, resample_input(&s->resample, 0), resample_input(&s->resample, 1), needed);
+			resample_process(&s->resample, (float *const[]){left, right}, n);
+		} else {
+			synth_render_dsp(s, left, right, n);
+		}
+		dsp_clamp(left, -1.0f, 1.0f, n);
+		dsp_clamp(right, -1.0f, 1.0f, n);
+
+		// Never waits: a block the UI has no room for is dropped
+		memcpy(mono, left, sizeof(float) * (size_t)n);
+		dsp_mix(mono, right, 1.0f, n);
+		dsp_gain(mono, 0.5f, n);
+		ring_write(&s->scope_ring, mono, (uint32_t)n);
+		if (s->tap) {
+			ring_write(s->tap, mono, (uint32_t)n);
+		}
+
+		dsp_interleave_stereo(buffer + (size_t)block * (size_t)num_channels, left, right, num_channels, n);
+	}
+	PROF_ZONE_END(synth);
+}
+
+void synth_stream_cb(float *buffer, int num_frames, int num_channels, void *user_data) {
+	synth_t *s = user_data;
+	// The device may not have granted the requested rate
+	if (saudio_sample_rate() != s->device_rate) {
+		synth_set_device_rate(s, saudio_sample_rate());
+	}
+	synth_render(s, buffer, num_frames, num_channels);
+}
+
+#ifdef ENABLE_IMGUI
+// Moves everything the audio thread captured since last frame into the
+// scope history and updates the meter
+static void synth_drain_scope(synth_t *s) {
+	float chunk[SYNTH_BLOCK];
+	double sum = 0.0;
+	uint32_t total = 0;
+	float peak = s->peak * 0.9f;
+	uint32_t n;
+	while ((n = ring_read(&s->scope_ring, chunk, SYNTH_BLOCK)) > 0) {
+		for (uint32_t i = 0; i < n; i++) {
+			const float v = chunk[i];
+			s->scope[s->scope_pos] = v;
+			s->scope_pos = (s->scope_pos + 1) % SYNTH_SCOPE_LENGTH;
+			sum += (double)v * v;
+			peak = fabsf(v) > peak ? fabsf(v) : peak;
+		}
+		total += n;
+	}
+	s->peak = peak;
+	if (total > 0) {
+		s->rms = (float)sqrt(sum / total);
+	}
+}
+
+static void synth_meter(const char *label, float value) {
+	const float db = value > 0.0f ? 20.0f * log10f(value) : -INFINITY;
+	char overlay[32];
+	snprintf(overlay, sizeof(overlay), "%s %.1f dB", label, db);
+	igProgressBar(value < 1.0f ? value : 1.0f, (ImVec2){-1, 0}, overlay);
+}
+
+void synth_ui(synth_t *s, bool *open) {
+	synth_drain_scope(s);
+
+	igBegin("Synth", open, ImGuiWindowFlags_None);
+	bool changed = igCheckbox("Enable", &s->params.playing);
+	changed |= igSliderFloat("amplitude", &s->params.amplitude, 0, 1, "%f", ImGuiSliderFlags_None);
+	changed |= igSliderFloat("end_amplitude", &s->params.end_amplitude, 0, 1, "%f", ImGuiSliderFlags_None);
+	changed |= igSliderFloat("mfreq", &s->params.mfreq, 0, 2000, "%f", ImGuiSliderFlags_None);
+	changed |= igSliderFloat("freqfreq", &s->params.freqfreq, 0, 100, "%f", ImGuiSliderFlags_None);
+	static const char *wave_names[OSC_WAVE_NUM];
+	for (int i = 0; i < OSC_WAVE_NUM; i++) {
+		wave_names[i] = osc_wave_name((osc_wave_t)i);
+	}
+	int wave = (int)s->params.lfo_wave;
+	if (igComboStr_arr("lfo wave", &wave, wave_names, OSC_WAVE_NUM, -1)) {
+		s->params.lfo_wave = (osc_wave_t)wave;
+		changed = true;
+	}
+	changed |= igSliderFloat("reverb size", &s->params.reverb.size, 0, 1, "%f", ImGuiSliderFlags_None);
+	changed |= igSliderFloat("reverb decay", &s->params.reverb.decay, 0.1f, 10, "%.2f s", ImGuiSliderFlags_Logarithmic);
+	changed |= igSliderFloat("reverb damping", &s->params.reverb.damping, 0, 1, "%f", ImGuiSliderFlags_None);
+	changed |= igSliderFloat("reverb mix", &s->params.reverb.mix, 0, 1, "%f", ImGuiSliderFlags_None);
+	if (changed) {
+		synth_publish(s);
+	}
+	if (igButton("Sweep", (ImVec2){0, 0})) {
+		// Dives an octave below the slider and comes back, exponentially
+		const float mfreq = s->params.mfreq;
+		const param_point_t sweep[] = {
+			{0.05, mfreq * 0.5f},
+			{1.0, mfreq * 2.0f},
+			{2.0, mfreq},
+		};
+		param_automate(&s->bank, SYNTH_PARAM_MFREQ, param_bank_now(&s->bank), sweep, 3, PARAM_EXPONENTIAL);
+	}
+
+	igSeparator();
+	mixer_ui(&s->mixer);
+	if (s->music) {
+		tracker_ui(&s->tracker, s->music);
+	}
+
+	igPlotLinesFloatPtr("##scope", s->scope, SYNTH_SCOPE_LENGTH, s->scope_pos, NULL, -1.0f, 1.0f, (ImVec2){-1, 150}, sizeof(float));
+	synth_meter("peak", s->peak);
+	synth_meter("rms", s->rms);
+	const int device_rate = saudio_isvalid() ? saudio_sample_rate() : 0;
+	const int dsp_rate = synth_dsp_rate(s, device_rate);
+	igText("DSP: %s, %d Hz%s", dsp_simd_name(), dsp_rate, dsp_rate != device_rate ? " resampled" : "");
+	igText("Dropped scope blocks: %u", (unsigned)atomic_load_explicit(&s->scope_ring.dropped, memory_order_relaxed));
+	igText("Dropped param events: %u", (unsigned)(atomic_load_explicit(&s->bank.queue.dropped, memory_order_relaxed) + atomic_load_explicit(&s->bank.dropped, memory_order_relaxed)));
+	igEnd();
+}
+#endif
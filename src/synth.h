@@ -0,0 +1,118 @@
+#ifndef TOWER4_SYNTH_H
+#define TOWER4_SYNTH_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "dsp.h"
+#include "mixer.h"
+#include "osc.h"
+#include "param.h"
+#include "resample.h"
+#include "reverb.h"
+#include "ring.h"
+#include "tracker.h"
+
+// Test synth, rendered on the sokol_audio thread.
+//
+// The audio device pulls samples through synth_stream_cb() whenever it needs
+// them, independent of the frame rate. The UI owns a copy of the parameters
+// and synth_publish() sends them as short ramps through the parameter bank
+// (see param.h), so neither thread ever waits for the other and slider moves
+// don't zipper. Anything can schedule automation on s->bank ahead of time
+// with the SYNTH_PARAM_* ids. Sound effects from gameplay go through the
+// mixer (see mixer.h) and are mixed on top.
+//
+// Nothing in the DSP assumes a rate. On weak devices everything can run at a
+// lower internal rate and be resampled to the device rate (see resample.h),
+// which trades treble above the internal Nyquist frequency for CPU. The game
+// takes the internal rate from TOWER4_SYNTH_RATE.
+//
+// Usage:
+//   synth_init(&synth, saudio_sample_rate(), 0);
+//   saudio_setup(&(saudio_desc){ .stream_userdata_cb = synth_stream_cb, .user_data = &synth });
+
+/// Frames rendered at a time, also the granularity of scope capture
+#define SYNTH_BLOCK 256
+/// Captured mono output waiting for the UI, power of two
+#define SYNTH_SCOPE_RING 8192
+/// Samples shown by the oscilloscope
+#define SYNTH_SCOPE_LENGTH 1024
+/// Ramp time of synth_publish() changes
+#define SYNTH_SMOOTHING 0.02f
+
+typedef enum synth_param_t {
+	SYNTH_PARAM_GATE, /// 0 or 1, ramped so starting and stopping doesn't click
+	SYNTH_PARAM_AMPLITUDE,
+	SYNTH_PARAM_END_AMPLITUDE,
+	SYNTH_PARAM_MFREQ,
+	SYNTH_PARAM_FREQFREQ, /// control rate from here on, read once per block
+	SYNTH_PARAM_LFO_WAVE,
+	SYNTH_PARAM_REVERB_SIZE,
+	SYNTH_PARAM_REVERB_DECAY,
+	SYNTH_PARAM_REVERB_DAMPING,
+	SYNTH_PARAM_REVERB_MIX,
+	SYNTH_PARAM_NUM,
+} synth_param_t;
+
+typedef struct synth_params_t {
+	bool playing;
+	float amplitude; /// volume
+	float end_amplitude;
+	float mfreq; /// frequency modulation depth
+	float freqfreq; /// frequency modulation rate
+	osc_wave_t lfo_wave; /// frequency modulation shape
+	reverb_params_t reverb;
+} synth_params_t;
+
+typedef struct synth_t {
+	int internal_rate; /// as requested, 0 to render at the device rate
+	ring_t *tap; /// set before the stream starts, gets the scope samples too
+
+	// Main thread
+	synth_params_t params; /// edited by the UI, sent with synth_publish()
+	const tracker_song_t *music; /// started by the UI's music button
+
+	// Oscilloscope and level meter, fed from scope_ring
+	float scope[SYNTH_SCOPE_LENGTH]; /// circular, oldest sample at scope_pos
+	int scope_pos;
+	float peak; /// held peak, decays over time
+	float rms; /// of the samples drained last frame
+
+	// Any thread -> audio thread
+	mixer_t mixer;
+	param_bank_t bank;
+	tracker_t tracker; /// music, played on the mixer
+
+	// Audio thread -> UI
+	ring_t scope_ring;
+	float scope_ring_memory[SYNTH_SCOPE_RING];
+
+	// Audio thread
+	_Alignas(64) int device_rate;
+	int sample_rate; /// the DSP runs at
+	bool resampling; /// sample_rate up to device_rate
+	osc_t lfo; /// drives the frequency modulation
+	reverb_t reverb;
+	resample_t resample;
+} synth_t;
+
+/// Sets default parameters for a device at sample_rate. A lower
+/// internal_rate renders at that rate and resamples, when resample.h supports
+/// the pair.
+void synth_init(synth_t *s, int sample_rate, int internal_rate);
+/// Any thread: the rate the DSP (and so the mixer) runs at on a device_rate device.
+int synth_dsp_rate(const synth_t *s, int device_rate);
+/// Ramps the audio thread to s->params over SYNTH_SMOOTHING.
+void synth_publish(synth_t *s);
+/// Renders interleaved frames with the latest published parameters.
+void synth_render(synth_t *s, float *buffer, int num_frames, int num_channels);
+/// saudio_desc.stream_userdata_cb, user_data is the synth_t
+void synth_stream_cb(float *buffer, int num_frames, int num_channels, void *user_data);
+
+#ifdef ENABLE_IMGUI
+/// Edits and publishes the parameters.
+void synth_ui(synth_t *s, bool *open);
+#endif
+
+#endif
@@ -0,0 +1,194 @@
+#include "thread.h"
+
+#if defined(THREAD_PTHREAD)
+#include <sched.h>
+#include <time.h>
+#include <unistd.h>
+#endif
+#if defined(__APPLE__)
+#include <sys/sysctl.h>
+#endif
+
+#if defined(THREAD_WIN32)
+static DWORD WINAPI thread_entry(LPVOID param) {
+	thread_t *t = param;
+	t->fn(t->arg);
+	return 0;
+}
+#elif defined(THREAD_PTHREAD)
+static void *thread_entry(void *param) {
+	thread_t *t = param;
+	t->fn(t->arg);
+	return NULL;
+}
+#endif
+
+bool thread_start(thread_t *t, void (*fn)(void *arg), void *arg) {
+	t->fn = fn;
+	t->arg = arg;
+#if defined(THREAD_WIN32)
+	t->handle = CreateThread(NULL, 0, thread_entry, t, 0, NULL);
+	return t->handle != NULL;
+#elif defined(THREAD_PTHREAD)
+	return pthread_create(&t->handle, NULL, thread_entry, t) == 0;
+#else
+	return false;
+#endif
+}
+
+void thread_join(thread_t *t) {
+#if defined(THREAD_WIN32)
+	WaitForSingleObject(t->handle, INFINITE);
+	CloseHandle(t->handle);
+#elif defined(THREAD_PTHREAD)
+	pthread_join(t->handle, NULL);
+#else
+	(void)t;
+#endif
+}
+
+int thread_cpu_count(void) {
+#if defined(THREAD_WIN32)
+	SYSTEM_INFO info;
+	GetSystemInfo(&info);
+	return info.dwNumberOfProcessors > 0 ? (int)info.dwNumberOfProcessors : 1;
+#elif defined(__APPLE__)
+	int count = 1;
+	size_t size = sizeof(count);
+	sysctlbyname("hw.logicalcpu", &count, &size, NULL, 0);
+	return count > 0 ? count : 1;
+#elif defined(THREAD_PTHREAD)
+	const long count = sysconf(_SC_NPROCESSORS_ONLN);
+	return count > 0 ? (int)count : 1;
+#else
+	return 1;
+#endif
+}
+
+void thread_yield(void) {
+#if defined(THREAD_WIN32)
+	SwitchToThread();
+#elif defined(THREAD_PTHREAD)
+	sched_yield();
+#endif
+}
+
+void thread_sleep_ms(int ms) {
+#if defined(THREAD_WIN32)
+	Sleep((DWORD)ms);
+#elif defined(THREAD_PTHREAD)
+	struct timespec ts = { .tv_sec = ms / 1000, .tv_nsec = (long)(ms % 1000) * 1000000L };
+	nanosleep(&ts, NULL);
+#else
+	(void)ms;
+#endif
+}
+
+void thread_sema_init(thread_sema_t *s, int count) {
+	s->count = count;
+#if defined(THREAD_WIN32)
+	InitializeCriticalSection(&s->lock);
+	InitializeConditionVariable(&s->cond);
+#elif defined(THREAD_PTHREAD)
+	pthread_mutex_init(&s->lock, NULL);
+	pthread_cond_init(&s->cond, NULL);
+#endif
+}
+
+void thread_sema_destroy(thread_sema_t *s) {
+#if defined(THREAD_WIN32)
+	DeleteCriticalSection(&s->lock);
+#elif defined(THREAD_PTHREAD)
+	pthread_cond_destroy(&s->cond);
+	pthread_mutex_destroy(&s->lock);
+#else
+	(void)s;
+#endif
+}
+
+void thread_sema_post(thread_sema_t *s, int count) {
+#if defined(THREAD_WIN32)
+	EnterCriticalSection(&s->lock);
+	s->count += count;
+	LeaveCriticalSection(&s->lock);
+	if (count == 1) {
+		WakeConditionVariable(&s->cond);
+	} else {
+		WakeAllConditionVariable(&s->cond);
+	}
+#elif defined(THREAD_PTHREAD)
+	pthread_mutex_lock(&s->lock);
+	s->count += count;
+	pthread_mutex_unlock(&s->lock);
+	if (count == 1) {
+		pthread_cond_signal(&s->cond);
+	} else {
+		pthread_cond_broadcast(&s->cond);
+	}
+#else
+	s->count += count;
+#endif
+}
+
+void thread_sema_wait(thread_sema_t *s) {
+#if defined(THREAD_WIN32)
+	EnterCriticalSection(&s->lock);
+	while (s->count <= 0) {
+		SleepConditionVariableCS(&s->cond, &s->lock, INFINITE);
+	}
+	s->count--;
+	LeaveCriticalSection(&s->lock);
+#elif defined(THREAD_PTHREAD)
+	pthread_mutex_lock(&s->lock);
+	while (s->count <= 0) {
+		pthread_cond_wait(&s->cond, &s->lock);
+	}
+	s->count--;
+	pthread_mutex_unlock(&s->lock);
+#else
+	// Single threaded: nobody could post, so never block
+	if (s->count > 0) {
+		s->count--;
+	}
+#endif
+}
+
+void thread_mutex_init(thread_mutex_t *m) {
+#if defined(THREAD_WIN32)
+	InitializeCriticalSection(&m->lock);
+#elif defined(THREAD_PTHREAD)
+	pthread_mutex_init(&m->lock, NULL);
+#else
+	(void)m;
+#endif
+}
+
+void thread_mutex_destroy(thread_mutex_t *m) {
+#if defined(THREAD_WIN32)
+	DeleteCriticalSection(&m->lock);
+#elif defined(THREAD_PTHREAD)
+	pthread_mutex_destroy(&m->lock);
+#else
+	(void)m;
+#endif
+}
+
+void thread_mutex_lock(thread_mutex_t *m) {
+#if defined(THREAD_WIN32)
+	EnterCriticalSection(&m->lock);
+#elif defined(THREAD_PTHREAD)
+	pthread_mutex_lock(&m->lock);
+#else
+	(void)m;
+#endif
+}
+
+void thread_mutex_unlock(thread_mutex_t *m) {
+#if defined(THREAD_WIN32)
+	LeaveCriticalSection(&m->lock);
+#elif defined(THREAD_PTHREAD)
+	pthread_mutex_unlock(&m->lock);
+#else
+	(void)m;
+#endif
+}
@@ -0,0 +1,71 @@
+#ifndef TOWER4_THREAD_H
+#define TOWER4_THREAD_H
+
+#include <stdbool.h>
+
+// Thin wrapper over pthreads / Win32 threads.
+//
+// Web builds without -pthread have no threads: thread_start() fails and
+// callers fall back to running the work on the calling thread.
+
+#if defined(_WIN32)
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#define THREAD_WIN32
+#elif defined(__EMSCRIPTEN__) && !defined(__EMSCRIPTEN_PTHREADS__)
+#define THREAD_NONE
+#else
+#include <pthread.h>
+#define THREAD_PTHREAD
+#endif
+
+typedef struct thread_t {
+#if defined(THREAD_WIN32)
+	HANDLE handle;
+#elif defined(THREAD_PTHREAD)
+	pthread_t handle;
+#endif
+	void (*fn)(void *arg);
+	void *arg;
+} thread_t;
+
+/// Counting semaphore, used to park idle threads
+typedef struct thread_sema_t {
+#if defined(THREAD_WIN32)
+	CRITICAL_SECTION lock;
+	CONDITION_VARIABLE cond;
+#elif defined(THREAD_PTHREAD)
+	pthread_mutex_t lock;
+	pthread_cond_t cond;
+#endif
+	int count;
+} thread_sema_t;
+
+typedef struct thread_mutex_t {
+#if defined(THREAD_WIN32)
+	CRITICAL_SECTION lock;
+#elif defined(THREAD_PTHREAD)
+	pthread_mutex_t lock;
+#endif
+	int unused;
+} thread_mutex_t;
+
+/// t must stay valid until thread_join(). Returns false if threads are unavailable.
+bool thread_start(thread_t *t, void (*fn)(void *arg), void *arg);
+void thread_join(thread_t *t);
+/// Logical cpus, 1 if unknown
+int thread_cpu_count(void);
+void thread_yield(void);
+void thread_sleep_ms(int ms);
+
+void thread_sema_init(thread_sema_t *s, int count);
+void thread_sema_destroy(thread_sema_t *s);
+void thread_sema_post(thread_sema_t *s, int count);
+void thread_sema_wait(thread_sema_t *s);
+
+void thread_mutex_init(thread_mutex_t *m);
+void thread_mutex_destroy(thread_mutex_t *m);
+void thread_mutex_lock(thread_mutex_t *m);
+void thread_mutex_unlock(thread_mutex_t *m);
+
+#endif
@@ -0,0 +1,236 @@
+#include "tracker.h"
+
+#include <math.h>
+#include <string.h>
+
+#ifdef ENABLE_IMGUI
+#define CIMGUI_DEFINE_ENUMS_AND_STRUCTS
+#include "cimgui.h"
+#endif
+
+#include "profiler.h"
+
+#define TRACKER_VERSION 1
+#define TRACKER_VOLUME_MAX 64
+/// A-4, 440 Hz
+#define TRACKER_NOTE_A4 TRACKER_NOTE(4, 9)
+
+typedef struct tracker_cell_t {
+	uint8_t note; /// 0 none
+	uint8_t instrument; /// 0 none
+	uint8_t volume;
+} tracker_cell_t;
+
+// Unpacks the cell at *cursor and moves past it, false if it runs past size
+static bool tracker_cell(const uint8_t *data, size_t size, uint32_t *cursor, tracker_cell_t *cell) {
+	uint32_t c = *cursor;
+	if (c >= size) {
+		return false;
+	}
+	const uint8_t first = data[c++];
+	const uint8_t mask = first < 0x80 ? 7 : first & 7;
+	*cell = (tracker_cell_t){.volume = TRACKER_VOLUME_MAX};
+	if (first < 0x80) {
+		cell->note = first;
+	} else if (mask & 1) {
+		if (c >= size) {
+			return false;
+		}
+		cell->note = data[c++];
+	}
+	if (mask & 2) {
+		if (c >= size) {
+			return false;
+		}
+		cell->instrument = data[c++];
+	}
+	if (mask & 4) {
+		if (c >= size) {
+			return false;
+		}
+		cell->volume = data[c++];
+	}
+	*cursor = c;
+	return true;
+}
+
+static float tracker_seconds(uint8_t centiseconds) {
+	return (float)centiseconds * 0.01f;
+}
+
+bool tracker_song_load(tracker_song_t *song, const uint8_t *data, size_t size) {
+	memset(song, 0, sizeof(*song));
+	if (size < TRACKER_HEADER_SIZE || memcmp(data, "T4TK", 4) != 0 || data[4] != TRACKER_VERSION) {
+		return false;
+	}
+	*song = (tracker_song_t){
+		.data = data,
+		.size = size,
+		.bpm = data[5],
+		.rows_per_beat = data[6],
+		.channels = data[7],
+		.rows = data[8],
+		.num_instruments = data[9],
+		.num_patterns = data[10],
+		.order_length = data[11],
+	};
+	if (song->bpm == 0 || song->rows_per_beat == 0 || song->channels == 0 || song->channels > TRACKER_CHANNELS ||
+		song->rows == 0 || song->rows > TRACKER_ROWS || song->num_instruments > TRACKER_INSTRUMENTS ||
+		song->num_patterns == 0 || song->num_patterns > TRACKER_PATTERNS || song->order_length == 0) {
+		return false;
+	}
+	uint32_t cursor = TRACKER_HEADER_SIZE;
+	if (size < cursor + (size_t)song->num_instruments * TRACKER_INSTRUMENT_SIZE + (size_t)song->order_length) {
+		return false;
+	}
+
+	for (int i = 0; i < song->num_instruments; i++) {
+		const uint8_t *ins = data + cursor;
+		if (ins[0] >= OSC_WAVE_NUM) {
+			return false;
+		}
+		song->instruments[i] = (tracker_instrument_t){
+			.sound = {
+				.wave = (osc_wave_t)ins[0],
+				.noise = (float)ins[1] / 255.0f,
+				.attack = tracker_seconds(ins[2]),
+				.decay = tracker_seconds(ins[3]),
+				.sustain = (float)ins[4] / 255.0f,
+				.hold = -1.0f,
+				.release = tracker_seconds(ins[5]),
+				.gain = (float)ins[6] / 255.0f,
+				.pan = (float)(int8_t)ins[7] / 127.0f,
+				.sweep = tracker_seconds(ins[9]),
+				.priority = TRACKER_PRIORITY,
+			},
+			.sweep = (float)(int8_t)ins[8],
+		};
+		cursor += TRACKER_INSTRUMENT_SIZE;
+	}
+
+	song->order = data + cursor;
+	for (int i = 0; i < song->order_length; i++) {
+		if (song->order[i] >= song->num_patterns) {
+			return false;
+		}
+	}
+	cursor += (uint32_t)song->order_length;
+
+	for (int p = 0; p < song->num_patterns; p++) {
+		song->patterns[p] = cursor;
+		for (int c = 0; c < song->rows * song->channels; c++) {
+			tracker_cell_t cell;
+			if (!tracker_cell(data, size, &cursor, &cell) || (cell.note > 96 && cell.note != TRACKER_NOTE_OFF) ||
+				cell.instrument > song->num_instruments || cell.volume > TRACKER_VOLUME_MAX) {
+				return false;
+			}
+		}
+	}
+	return cursor == size;
+}
+
+void tracker_init(tracker_t *t) {
+	memset(t, 0, sizeof(*t));
+	atomic_init(&t->requested, NULL);
+	atomic_init(&t->position, -1);
+	atomic_init(&t->rows_played, 0);
+}
+
+void tracker_play(tracker_t *t, const tracker_song_t *song) {
+	atomic_store_explicit(&t->requested, song, memory_order_release);
+}
+
+static void tracker_release_all(tracker_t *t, mixer_t *m) {
+	for (int c = 0; c < TRACKER_CHANNELS; c++) {
+		if (t->channels[c].voice) {
+			mixer_release_at(m, t->channels[c].voice, 0);
+		}
+		t->channels[c] = (tracker_channel_t){0};
+	}
+}
+
+static void tracker_note(tracker_t *t, mixer_t *m, tracker_channel_t *channel, const tracker_cell_t *cell, int offset,
+	float sample_rate) {
+	if (channel->voice) {
+		mixer_release_at(m, channel->voice, offset);
+		channel->voice = 0;
+	}
+	if (cell->instrument) {
+		channel->instrument = cell->instrument;
+	}
+	if (cell->note == TRACKER_NOTE_OFF || channel->instrument == 0) {
+		return;
+	}
+	const tracker_instrument_t *instrument = &t->song->instruments[channel->instrument - 1];
+	mixer_sound_t sound = instrument->sound;
+	sound.freq = 440.0f * exp2f((float)(cell->note - TRACKER_NOTE_A4) / 12.0f);
+	sound.freq_end = instrument->sweep != 0.0f ? sound.freq * exp2f(instrument->sweep / 12.0f) : 0.0f;
+	sound.gain *= (float)cell->volume / (float)TRACKER_VOLUME_MAX;
+	channel->voice = mixer_trigger(m, &sound, offset, sample_rate);
+}
+
+// Plays the row under the cursor starting `offset` samples into the block,
+// then moves to the next one
+static void tracker_row(tracker_t *t, mixer_t *m, int offset, float sample_rate) {
+	const tracker_song_t *song = t->song;
+	for (int c = 0; c < song->channels; c++) {
+		tracker_cell_t cell;
+		// tracker_song_load() checked every cell, this only stops a corrupt song
+		if (!tracker_cell(song->data, song->size, &t->cursor, &cell)) {
+			break;
+		}
+		if (cell.note) {
+			tracker_note(t, m, &t->channels[c], &cell, offset, sample_rate);
+		}
+	}
+	atomic_store_explicit(&t->position, t->order * TRACKER_ROWS + t->row, memory_order_relaxed);
+	atomic_fetch_add_explicit(&t->rows_played, 1, memory_order_relaxed);
+
+	if (++t->row == song->rows) {
+		t->row = 0;
+		t->order = (t->order + 1) % song->order_length;
+		t->cursor = song->patterns[song->order[t->order]];
+	}
+}
+
+void tracker_render(tracker_t *t, mixer_t *m, int n, float sample_rate) {
+	const tracker_song_t *requested = atomic_load_explicit(&t->requested, memory_order_acquire);
+	if (requested != t->song) {
+		tracker_release_all(t, m);
+		t->song = requested;
+		t->order = 0;
+		t->row = 0;
+		t->cursor = requested ? requested->patterns[requested->order[0]] : 0;
+		t->until_row = 0.0;
+		atomic_store_explicit(&t->position, -1, memory_order_relaxed);
+	}
+	if (!t->song) {
+		return;
+	}
+
+	PROF_ZONE_BEGIN(tracker);
+	const double row_samples = (double)sample_rate * 60.0 / (double)(t->song->bpm * t->song->rows_per_beat);
+	while (t->until_row < (double)n) {
+		tracker_row(t, m, (int)t->until_row, sample_rate);
+		t->until_row += row_samples;
+	}
+	t->until_row -= (double)n;
+	PROF_ZONE_END(tracker);
+}
+
+#ifdef ENABLE_IMGUI
+void tracker_ui(tracker_t *t, const tracker_song_t *song) {
+	const int position = atomic_load_explicit(&t->position, memory_order_relaxed);
+	const bool playing = atomic_load_explicit(&t->requested, memory_order_relaxed) != NULL;
+	if (igButton(playing ? "Stop music" : "Play music", (ImVec2){0, 0})) {
+		tracker_play(t, playing ? NULL : song);
+	}
+	igSameLine(0, -1);
+	if (position < 0) {
+		igText("stopped");
+	} else {
+		igText("order %d/%d, row %02d", position / TRACKER_ROWS, song->order_length, position % TRACKER_ROWS);
+	}
+	igText("Song: %zu bytes, %d bpm, %d channels, %d patterns", song->size, song->bpm, song->channels, song->num_patterns);
+}
+#endif
@@ -0,0 +1,111 @@
+#ifndef TOWER4_TRACKER_H
+#define TOWER4_TRACKER_H
+
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "mixer.h"
+
+// Tracker style music sequencer, playing songs on mixer voices.
+//
+// A song is a list of patterns played in the order of its order list and
+// looped. A pattern is a grid of rows by channels; every cell can start a note
+// with an instrument and volume, or release the channel's note. Channels are
+// monophonic: a new note releases the previous one. Rows advance at a fixed
+// tempo, and tracker_render() runs on the audio thread right before
+// mixer_render(), starting and releasing voices on the exact sample of the
+// row (see mixer_trigger()).
+//
+// Songs stay in their tiny binary form in memory and are decoded while
+// playing. All bytes, no endianness:
+//
+//   header      "T4TK", version 1, bpm, rows per beat, channels, rows per
+//               pattern, instruments, patterns, order length
+//   instruments 10 bytes each: wave, noise / 255, attack, decay (centi-
+//               seconds), sustain / 255, release (centiseconds), gain / 255,
+//               pan / 127 (signed), sweep (signed semitones), sweep time
+//               (centiseconds)
+//   order       pattern index per position
+//   patterns    rows * channels packed cells each, row by row
+//
+// Cells are packed like XM: a byte below 0x80 is a note followed by
+// instrument and volume. Otherwise its low bits tell which of note (1),
+// instrument (2) and volume (4) follow, so 0x80 alone is an empty cell.
+// Notes run from 1 (C-0) to 96 (B-7), TRACKER_NOTE_OFF releases. Instruments
+// count from 1 and stick to the channel when omitted; volume is 0 to 64,
+// 64 when omitted, and only applies to a note in the same cell.
+
+#define TRACKER_CHANNELS 8
+#define TRACKER_INSTRUMENTS 32
+#define TRACKER_PATTERNS 64
+#define TRACKER_ROWS 64
+#define TRACKER_NOTE_OFF 97
+/// Note number of octave and semitone, C-0 is TRACKER_NOTE(0, 0)
+#define TRACKER_NOTE(octave, semitone) (1 + (octave) * 12 + (semitone))
+#define TRACKER_HEADER_SIZE 12
+#define TRACKER_INSTRUMENT_SIZE 10
+/// Music steals sound effects but not the loops on emitters
+#define TRACKER_PRIORITY 2
+
+typedef struct tracker_instrument_t {
+	mixer_sound_t sound; /// freq and freq_end are set per note
+	float sweep; /// semitones over sound.sweep seconds
+} tracker_instrument_t;
+
+typedef struct tracker_song_t {
+	const uint8_t *data;
+	size_t size;
+	int bpm;
+	int rows_per_beat;
+	int channels;
+	int rows;
+	int num_instruments;
+	int num_patterns;
+	int order_length;
+	const uint8_t *order;
+	tracker_instrument_t instruments[TRACKER_INSTRUMENTS];
+	uint32_t patterns[TRACKER_PATTERNS]; /// offset of the packed cells in data
+} tracker_song_t;
+
+typedef struct tracker_channel_t {
+	mixer_voice_t voice;
+	int instrument; /// 0 until the first note
+} tracker_channel_t;
+
+typedef struct tracker_t {
+	// Any thread -> audio thread
+	_Atomic(const tracker_song_t *) requested;
+
+	// Audio thread
+	_Alignas(64) const tracker_song_t *song;
+	int order; /// position in the order list
+	int row;
+	uint32_t cursor; /// next packed cell of the current pattern
+	double until_row; /// samples before the next row starts
+	tracker_channel_t channels[TRACKER_CHANNELS];
+
+	// Audio thread -> UI
+	_Alignas(64) atomic_int position; /// order * TRACKER_ROWS + row, -1 stopped
+	atomic_uint_least32_t rows_played;
+} tracker_t;
+
+/// Checks the whole song so playing it needs no checks, data must outlive it.
+/// Returns false for anything malformed.
+bool tracker_song_load(tracker_song_t *song, const uint8_t *data, size_t size);
+
+void tracker_init(tracker_t *t);
+/// Any thread: starts the song from the top, NULL stops. The song must stay
+/// alive while it plays.
+void tracker_play(tracker_t *t, const tracker_song_t *song);
+
+/// Audio thread: plays the rows starting in the next n samples.
+void tracker_render(tracker_t *t, mixer_t *m, int n, float sample_rate);
+
+#ifdef ENABLE_IMGUI
+/// Play/stop and position, song is what the play button starts.
+void tracker_ui(tracker_t *t, const tracker_song_t *song);
+#endif
+
+#endif
@@ -0,0 +1,77 @@
+#include "wav.h"
+
+#include <string.h>
+
+#define WAV_FORMAT_FLOAT 3
+
+static void wav_put16(uint8_t *p, uint16_t v) {
+	p[0] = (uint8_t)v;
+	p[1] = (uint8_t)(v >> 8);
+}
+
+static void wav_put32(uint8_t *p, uint32_t v) {
+	wav_put16(p, (uint16_t)v);
+	wav_put16(p + 2, (uint16_t)(v >> 16));
+}
+
+static uint16_t wav_get16(const uint8_t *p) {
+	return (uint16_t)(p[0] | p[1] << 8);
+}
+
+static uint32_t wav_get32(const uint8_t *p) {
+	return (uint32_t)wav_get16(p) | (uint32_t)wav_get16(p + 2) << 16;
+}
+
+bool wav_write_header(FILE *f, const wav_info_t *info) {
+	const uint32_t frame_bytes = (uint32_t)info->channels * sizeof(float);
+	const uint32_t data_bytes = info->frames * frame_bytes;
+	uint8_t h[44];
+	memcpy(h, "RIFF", 4);
+	wav_put32(h + 4, 36 + data_bytes);
+	memcpy(h + 8, "WAVEfmt ", 8);
+	wav_put32(h + 16, 16);
+	wav_put16(h + 20, WAV_FORMAT_FLOAT);
+	wav_put16(h + 22, (uint16_t)info->channels);
+	wav_put32(h + 24, (uint32_t)info->sample_rate);
+	wav_put32(h + 28, (uint32_t)info->sample_rate * frame_bytes);
+	wav_put16(h + 32, (uint16_t)frame_bytes);
+	wav_put16(h + 34, 32);
+	memcpy(h + 36, "data", 4);
+	wav_put32(h + 40, data_bytes);
+	return fwrite(h, sizeof(h), 1, f) == 1;
+}
+
+bool wav_read_header(FILE *f, wav_info_t *info) {
+	uint8_t riff[12];
+	if (fread(riff, sizeof(riff), 1, f) != 1 || memcmp(riff, "RIFF", 4) != 0 || memcmp(riff + 8, "WAVE", 4) != 0) {
+		return false;
+	}
+	bool have_format = false;
+	for (;;) {
+		uint8_t chunk[8];
+		if (fread(chunk, sizeof(chunk), 1, f) != 1) {
+			return false;
+		}
+		const uint32_t size = wav_get32(chunk + 4);
+		if (memcmp(chunk, "fmt ", 4) == 0 && size >= 16) {
+			uint8_t fmt[16];
+			if (fread(fmt, sizeof(fmt), 1, f) != 1 || fseek(f, (long)(size - 16 + (size & 1)), SEEK_CUR) != 0) {
+				return false;
+			}
+			if (wav_get16(fmt) != WAV_FORMAT_FLOAT || wav_get16(fmt + 14) != 32) {
+				return false;
+			}
+			info->channels = wav_get16(fmt + 2);
+			info->sample_rate = (int)wav_get32(fmt + 4);
+			have_format = info->channels > 0;
+		} else if (memcmp(chunk, "data", 4) == 0) {
+			if (!have_format) {
+				return false;
+			}
+			info->frames = size / ((uint32_t)info->channels * sizeof(float));
+			return true;
+		} else if (fseek(f, (long)(size + (size & 1)), SEEK_CUR) != 0) {
+			return false;
+		}
+	}
+}
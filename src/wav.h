@@ -0,0 +1,23 @@
+#ifndef TOWER4_WAV_H
+#define TOWER4_WAV_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+
+// Minimal RIFF WAVE files with interleaved 32 bit float samples, the format
+// the audio thread renders, so files round trip bit exactly. Samples are
+// read and written in host order; every target is little endian.
+
+typedef struct wav_info_t {
+	int sample_rate;
+	int channels;
+	uint32_t frames;
+} wav_info_t;
+
+/// Writes the header for `frames` frames, the samples follow with fwrite().
+bool wav_write_header(FILE *f, const wav_info_t *info);
+/// Reads up to the start of the samples. Fails on anything but 32 bit float.
+bool wav_read_header(FILE *f, wav_info_t *info);
+
+#endif
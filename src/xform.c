@@ -0,0 +1,103 @@
+#include "xform.h"
+
+#include <math.h>
+
+#include "simd.h"
+
+void xform_mul_mat4(hmm_mat4 *out, const hmm_mat4 *m, const hmm_mat4 *in, int n) {
+	const hmm_mat4 left = *m;
+	for (int i = 0; i < n; i++) {
+		const hmm_mat4 right = in[i];
+#ifdef HANDMADE_MATH__USE_SSE
+		// HMM_MultiplyMat4 is out of line and passes both matrices through
+		// the stack, inlined the four columns stay in registers
+		out[i].Columns[0] = HMM_LinearCombineSSE(right.Columns[0], left);
+		out[i].Columns[1] = HMM_LinearCombineSSE(right.Columns[1], left);
+		out[i].Columns[2] = HMM_LinearCombineSSE(right.Columns[2], left);
+		out[i].Columns[3] = HMM_LinearCombineSSE(right.Columns[3], left);
+#else
+		for (int c = 0; c < 4; c++) {
+			for (int r = 0; r < 4; r++) {
+				out[i].Elements[c][r] = left.Elements[0][r] * right.Elements[c][0] + left.Elements[1][r] * right.Elements[c][1]
+					+ left.Elements[2][r] * right.Elements[c][2] + left.Elements[3][r] * right.Elements[c][3];
+			}
+		}
+#endif
+	}
+}
+
+void xform_points(const xform_points_t *out, const hmm_mat4 *m, const xform_points_t *in, int n) {
+	const float (*e)[4] = m->Elements;
+	const vf_t m00 = vf_set1(e[0][0]), m10 = vf_set1(e[1][0]), m20 = vf_set1(e[2][0]), m30 = vf_set1(e[3][0]);
+	const vf_t m01 = vf_set1(e[0][1]), m11 = vf_set1(e[1][1]), m21 = vf_set1(e[2][1]), m31 = vf_set1(e[3][1]);
+	const vf_t m02 = vf_set1(e[0][2]), m12 = vf_set1(e[1][2]), m22 = vf_set1(e[2][2]), m32 = vf_set1(e[3][2]);
+	int i = 0;
+	for (; i + SIMD_WIDTH <= n; i += SIMD_WIDTH) {
+		const vf_t x = vf_load(in->x + i), y = vf_load(in->y + i), z = vf_load(in->z + i);
+		vf_store(out->x + i, vf_add(vf_add(vf_mul(m00, x), vf_mul(m10, y)), vf_add(vf_mul(m20, z), m30)));
+		vf_store(out->y + i, vf_add(vf_add(vf_mul(m01, x), vf_mul(m11, y)), vf_add(vf_mul(m21, z), m31)));
+		vf_store(out->z + i, vf_add(vf_add(vf_mul(m02, x), vf_mul(m12, y)), vf_add(vf_mul(m22, z), m32)));
+	}
+	for (; i < n; i++) {
+		const float x = in->x[i], y = in->y[i], z = in->z[i];
+		out->x[i] = e[0][0] * x + e[1][0] * y + (e[2][0] * z + e[3][0]);
+		out->y[i] = e[0][1] * x + e[1][1] * y + (e[2][1] * z + e[3][1]);
+		out->z[i] = e[0][2] * x + e[1][2] * y + (e[2][2] * z + e[3][2]);
+	}
+}
+
+void xform_boxes(const xform_boxes_t *out, const hmm_mat4 *m, const xform_boxes_t *in, int n) {
+	const float (*e)[4] = m->Elements;
+	// The center moves with the matrix, the half extents grow by its
+	// absolute values (Arvo)
+	float a[3][3];
+	for (int c = 0; c < 3; c++) {
+		for (int r = 0; r < 3; r++) {
+			a[c][r] = fabsf(e[c][r]);
+		}
+	}
+	const vf_t half = vf_set1(0.5f);
+	const vf_t m00 = vf_set1(e[0][0]), m10 = vf_set1(e[1][0]), m20 = vf_set1(e[2][0]), m30 = vf_set1(e[3][0]);
+	const vf_t m01 = vf_set1(e[0][1]), m11 = vf_set1(e[1][1]), m21 = vf_set1(e[2][1]), m31 = vf_set1(e[3][1]);
+	const vf_t m02 = vf_set1(e[0][2]), m12 = vf_set1(e[1][2]), m22 = vf_set1(e[2][2]), m32 = vf_set1(e[3][2]);
+	const vf_t a00 = vf_set1(a[0][0]), a10 = vf_set1(a[1][0]), a20 = vf_set1(a[2][0]);
+	const vf_t a01 = vf_set1(a[0][1]), a11 = vf_set1(a[1][1]), a21 = vf_set1(a[2][1]);
+	const vf_t a02 = vf_set1(a[0][2]), a12 = vf_set1(a[1][2]), a22 = vf_set1(a[2][2]);
+	int i = 0;
+	for (; i + SIMD_WIDTH <= n; i += SIMD_WIDTH) {
+		const vf_t min_x = vf_load(in->min_x + i), min_y = vf_load(in->min_y + i), min_z = vf_load(in->min_z + i);
+		const vf_t max_x = vf_load(in->max_x + i), max_y = vf_load(in->max_y + i), max_z = vf_load(in->max_z + i);
+		const vf_t cx = vf_mul(vf_add(min_x, max_x), half), ex = vf_mul(vf_sub(max_x, min_x), half);
+		const vf_t cy = vf_mul(vf_add(min_y, max_y), half), ey = vf_mul(vf_sub(max_y, min_y), half);
+		const vf_t cz = vf_mul(vf_add(min_z, max_z), half), ez = vf_mul(vf_sub(max_z, min_z), half);
+		const vf_t tx = vf_add(vf_add(vf_mul(m00, cx), vf_mul(m10, cy)), vf_add(vf_mul(m20, cz), m30));
+		const vf_t ty = vf_add(vf_add(vf_mul(m01, cx), vf_mul(m11, cy)), vf_add(vf_mul(m21, cz), m31));
+		const vf_t tz = vf_add(vf_add(vf_mul(m02, cx), vf_mul(m12, cy)), vf_add(vf_mul(m22, cz), m32));
+		const vf_t fx = vf_add(vf_add(vf_mul(a00, ex), vf_mul(a10, ey)), vf_mul(a20, ez));
+		const vf_t fy = vf_add(vf_add(vf_mul(a01, ex), vf_mul(a11, ey)), vf_mul(a21, ez));
+		const vf_t fz = vf_add(vf_add(vf_mul(a02, ex), vf_mul(a12, ey)), vf_mul(a22, ez));
+		vf_store(out->min_x + i, vf_sub(tx, fx));
+		vf_store(out->min_y + i, vf_sub(ty, fy));
+		vf_store(out->min_z + i, vf_sub(tz, fz));
+		vf_store(out->max_x + i, vf_add(tx, fx));
+		vf_store(out->max_y + i, vf_add(ty, fy));
+		vf_store(out->max_z + i, vf_add(tz, fz));
+	}
+	for (; i < n; i++) {
+		const float cx = (in->min_x[i] + in->max_x[i]) * 0.5f, ex = (in->max_x[i] - in->min_x[i]) * 0.5f;
+		const float cy = (in->min_y[i] + in->max_y[i]) * 0.5f, ey = (in->max_y[i] - in->min_y[i]) * 0.5f;
+		const float cz = (in->min_z[i] + in->max_z[i]) * 0.5f, ez = (in->max_z[i] - in->min_z[i]) * 0.5f;
+		const float tx = e[0][0] * cx + e[1][0] * cy + (e[2][0] * cz + e[3][0]);
+		const float ty = e[0][1] * cx + e[1][1] * cy + (e[2][1] * cz + e[3][1]);
+		const float tz = e[0][2] * cx + e[1][2] * cy + (e[2][2] * cz + e[3][2]);
+		const float fx = a[0][0] * ex + a[1][0] * ey + a[2][0] * ez;
+		const float fy = a[0][1] * ex + a[1][1] * ey + a[2][1] * ez;
+		const float fz = a[0][2] * ex + a[1][2] * ey + a[2][2] * ez;
+		out->min_x[i] = tx - fx;
+		out->min_y[i] = ty - fy;
+		out->min_z[i] = tz - fz;
+		out->max_x[i] = tx + fx;
+		out->max_y[i] = ty + fy;
+		out->max_z[i] = tz + fz;
+	}
+}
@@ -0,0 +1,42 @@
+#ifndef TOWER4_XFORM_H
+#define TOWER4_XFORM_H
+
+#include "HandmadeMath.h"
+
+// Batched transforms, one matrix applied to many objects.
+//
+// xform_mul_mat4() keeps hmm_mat4 as it is, to feed uniforms and instance
+// buffers, and runs HandmadeMath's SSE column combine inlined (scalar when
+// HandmadeMath is built without SSE). Points and boxes are structure of
+// arrays instead, so simd.h handles SIMD_WIDTH objects per instruction
+// with the matrix entries broadcast once per batch.
+//
+// Point and box transforms are affine: w is taken as 1 and the bottom row
+// of the matrix is ignored. Outputs may alias their inputs.
+
+/// n points as three arrays
+typedef struct xform_points_t {
+	float *x;
+	float *y;
+	float *z;
+} xform_points_t;
+
+/// n boxes as six arrays, the fields of aabb_t
+typedef struct xform_boxes_t {
+	float *min_x;
+	float *min_y;
+	float *min_z;
+	float *max_x;
+	float *max_y;
+	float *max_z;
+} xform_boxes_t;
+
+/// out[i] = m * in[i], e.g. view_proj times each model matrix
+void xform_mul_mat4(hmm_mat4 *out, const hmm_mat4 *m, const hmm_mat4 *in, int n);
+/// out[i] = m * (in[i], 1)
+void xform_points(const xform_points_t *out, const hmm_mat4 *m, const xform_points_t *in, int n);
+/// Smallest boxes holding the transformed in[i] (center and half extents,
+/// no corners)
+void xform_boxes(const xform_boxes_t *out, const hmm_mat4 *m, const xform_boxes_t *in, int n);
+
+#endif